@@ -71,6 +71,7 @@ def config_extra(cpu_cls, cpu_list, options):
 
         for cpu in cpu_list:
             cpu.needsTSO = options.needsTSO
+            cpu.decodedInstCacheEntries = options.decoded_inst_cache_entries
             cpu.maxInsts = options.maxinsts
             cpu.HWName   = options.HWName
             cpu.threatModel = options.threatModel
@@ -84,13 +85,20 @@ def config_extra(cpu_cls, cpu_list, options):
             cpu.CCSets = options.CCSets
             cpu.CCMissLatency = options.CCMissLatency
             cpu.CCIdeal = options.CCIdeal
+            cpu.counterDecay = options.counterDecay
+            cpu.counterCleanRetires = options.counterCleanRetires
+            cpu.counterDecayPeriod = options.counterDecayPeriod
+            cpu.counterResetOnSwitch = options.counterResetOnSwitch
 
             cpu.maxSBSize  = options.maxSBSize
+            cpu.sbCAMEntries = options.sbCAMEntries
             cpu.liftOnClear = options.liftOnClear
             cpu.projectedElemCnt = options.projectedElemCnt
 
-            cpu.epochInfoPath = options.epoch_path
+            if options.epoch_path:
+                cpu.epochInfoPath = options.epoch_path
             cpu.epochSize     = options.epoch_size
+            cpu.epochSource   = options.epoch_source
             cpu.deleteOnRetire = options.deleteOnRetire
             cpu.activeRecords = options.activeRecords
             cpu.checkAllRecords = options.checkAllRecords
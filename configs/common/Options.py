@@ -108,6 +108,8 @@ def addNoISAOptions(parser):
     parser.add_option("--mem-size", action="store", type="string",
                       default="512MB",
                       help="Specify the physical memory size (single memory)")
+    parser.add_option("--sparse-backstore", action="store_true",
+                      help="Only checkpoint the memory pages in use")
     parser.add_option("--enable-dram-powerdown", action="store_true",
                        help="Enable low-power states in DRAMInterface")
     parser.add_option("--mem-channels-intlv", type="int", default=0,
@@ -158,6 +160,18 @@ def addNoISAOptions(parser):
              "sets max_insts_all_threads for cpus 0, 1, 3, 5 and 7 "
              "Direct parameters of the root object are not accessible, "
              "only parameters of its children.")
+    parser.add_option("--eventq-calendar", action="store_true",
+                      help="Index the main event queues with a calendar to "
+                      "speed up scheduling; the event order is unchanged")
+    parser.add_option("--eventq-per-core", action="store_true",
+                      help="Simulate every CPU and its private Ruby "
+                      "controllers on an event queue and host thread of its "
+                      "own; requires --ruby with the simple network")
+    parser.add_option("--sim-quantum", type="string", default="1ns",
+                      help="Synchronisation quantum of --eventq-per-core. "
+                      "Messages between a core and the shared memory system "
+                      "take at least one quantum, so keep it at or below "
+                      "the smallest such latency [default: %default]")
 
 # Add common options that assume a non-NULL ISA.
 def addCommonOptions(parser):
@@ -296,6 +310,9 @@ def addCommonOptions(parser):
                       help="Enable basic block profiling for SimPoints")
     parser.add_option("--simpoint-interval", type="int", default=10000000,
                       help="SimPoint interval in num of instructions")
+    parser.add_option("--simpoint-compact", action="store_true",
+                      help="""Write BBVs in gem5's compact binary format,
+                              see configs/example/simpoint_cluster.py""")
     parser.add_option("--take-simpoint-checkpoints", action="store", type="string",
         help="<simpoint file,weight file,interval-length,warmup-length>")
     parser.add_option("--restore-simpoint-checkpoint", action="store_true",
@@ -315,6 +332,13 @@ def addCommonOptions(parser):
         help="restore from checkpoint <N>")
     parser.add_option("--checkpoint-at-end", action="store_true",
                       help="take a checkpoint at end of run")
+    parser.add_option("--checkpoint-jobs", action="store", type="int",
+                      default=0,
+                      help="""write up to N checkpoints at a time in forked
+                              processes while simulation continues. Only a
+                              single-threaded simulator can fork, so with
+                              --eventq-per-core checkpoints are written
+                              synchronously""")
     parser.add_option("--work-begin-checkpoint-count", action="store", type="int",
                       help="checkpoint at specified work begin count")
     parser.add_option("--work-end-checkpoint-count", action="store", type="int",
@@ -339,6 +363,31 @@ def addCommonOptions(parser):
     parser.add_option("-p", "--prog-interval", type="str",
         help="CPU Progress Interval")
 
+    # SMARTS-style systematic sampling: functional warming on a simple CPU,
+    # then a short detailed warmup and a detailed measurement unit, repeated
+    # every --smarts-period instructions
+    parser.add_option("--smarts", action="store_true", default=False,
+        help="Enable SMARTS periodic sampling (requires a detailed "
+             "--cpu-type together with --checkpoint-restore or "
+             "--fast-forward)")
+    parser.add_option("--smarts-unit", action="store", type="int",
+        default=1000,
+        help="Detailed measurement unit size in instructions")
+    parser.add_option("--smarts-warmup", action="store", type="int",
+        default=2000,
+        help="Detailed warmup before each unit in instructions")
+    parser.add_option("--smarts-period", action="store", type="int",
+        default=1000000,
+        help="Sampling period in instructions (unit + warmup + "
+             "functional warming)")
+    parser.add_option("--smarts-warm-cpu", action="store", type="choice",
+        default=None, choices=ObjectList.cpu_list.get_names(),
+        help="CPU used for functional warming (default: AtomicSimpleCPU "
+             "with classic caches, TimingSimpleCPU with Ruby)")
+    parser.add_option("--smarts-confidence", action="store", type="choice",
+        default="0.997", choices=["0.95", "0.99", "0.997"],
+        help="Confidence level of the reported CPI interval")
+
     # Fastforwarding and simpoint related materials
     parser.add_option("-W", "--warmup-insts", action="store", type="int",
         default=None,
@@ -372,8 +421,9 @@ def addCommonOptions(parser):
 
     # base configs
     parser.add_option("--needsTSO", action="store_true", help="Select TSO")
+    parser.add_option("--decoded-inst-cache-entries", default=0, type="int", help="Entries in the host-side decoded instruction cache of O3 fetch (0 disables it)")
     parser.add_option("--threatModel", default="Unsafe", type="choice", choices=["Unsafe", "Spectre", "Futuristic"], help="Threat model of the processor")
-    parser.add_option("--HWName", default="Unsafe", type="choice", choices=["Unsafe", "Fence", "Fence-All"], help="Scheme of the processor")
+    parser.add_option("--HWName", default="Unsafe", type="choice", choices=["Unsafe", "Fence", "Fence-All", "DelayOnMiss"], help="Scheme of the processor")
     parser.add_option("--replayDetScheme", default="NoDetect", type="choice", choices=["NoDetect", "Counter", "Buffer", "Epoch"], help="Replay detection scheme")
     parser.add_option("--replayDetThreat", default="Execute", type="choice", choices=["Issue", "Execute"], help="Replay detection threat model")
 
@@ -383,10 +433,15 @@ def addCommonOptions(parser):
     parser.add_option("--CCSets", default=32, type="int", help="Specifiy the number of sets of the counter cache")
     parser.add_option("--CCMissLatency", default=8, type="int", help="Specifiy the miss latency of the counter cache")
     parser.add_option("--CCIdeal", action="store_true", help="Specify if the counter cache is ideal (always hit)")
+    parser.add_option("--counterDecay", default="Retire", type="choice", choices=["Retire", "CleanRetires", "Periodic"], help="When replay counters go down: on retirement, after --counterCleanRetires retirements without a squash, or halved every --counterDecayPeriod instructions")
+    parser.add_option("--counterCleanRetires", default=4, type="int", help="Retirements without a squash before a replay counter goes down")
+    parser.add_option("--counterDecayPeriod", default=1000000, type="int", help="Committed instructions between two halvings of all replay counters")
+    parser.add_option("--counterResetOnSwitch", action="store_true", help="Reset all replay counters when a thread is activated on the CPU")
 
     # SB related settings
     parser.add_option("--maxSBSize", default=128, type="int", help="Specifiy maximum number of squash buffer entries")
-    parser.add_option("--sbHWStruct", default="Ideal", type="choice", choices=["Ideal", "Bloom", "CountingBloom"], help="Squash Buffer structure")
+    parser.add_option("--sbHWStruct", default="Ideal", type="choice", choices=["Ideal", "Bloom", "CountingBloom", "Hybrid"], help="Squash Buffer structure")
+    parser.add_option("--sbCAMEntries", default=32, type="int", help="Exact PC entries of a Hybrid squash buffer record before it spills into a Bloom filter")
 
     # CoR: without compiler support
     parser.add_option("--liftOnClear", action="store_true")
@@ -397,6 +452,7 @@ def addCommonOptions(parser):
     parser.add_option("--activeRecords", action="store", type="int", default=12, help="Maximum number of active epoch records")
     parser.add_option("--epoch-path", type="string", action="store", help="Path to the epoch file")
     parser.add_option("--epoch-size", type="choice", default="Iter", choices=["Iter", "Loop", "Rtn"], help="Epoch size")
+    parser.add_option("--epoch-source", type="choice", default="Static", choices=["Static", "Dynamic", "Hybrid"], help="Source of epoch separators: the epoch file, the loop detector of fetch, or both")
     parser.add_option("--checkAllRecords", action="store_true", help="Check all active records to decide fence or not")
     parser.add_option("--counterSize", type="int", default=4, help="Number of bits for counter")
 
@@ -439,6 +439,109 @@ def repeatSwitch(testsys, repeat_switch_cpu_list, maxtick, switch_freq):
             exit_event = m5.simulate(maxtick - m5.curTick())
             return exit_event
 
+_smarts_z_scores = {"0.95": 1.960, "0.99": 2.576, "0.997": 2.968}
+
+def _smartsPhase(cpu, insts, cause, maxtick):
+    """Simulate until cpu has committed insts more instructions."""
+    cpu.scheduleInstStop(0, insts, cause)
+    exit_event = m5.simulate(maxtick - m5.curTick())
+    return exit_event, exit_event.getCause() == cause
+
+def runSmarts(options, testsys, detailed_cpus, warm_cpus, maxtick):
+    """SMARTS systematic sampling loop.
+
+    Starts with the detailed CPUs active. Each sampling period is a
+    detailed warmup of --smarts-warmup instructions, a measurement unit of
+    --smarts-unit instructions, and functional warming on the simple CPUs
+    for the rest of the period. Caches, the branch predictor (shared with
+    the warming CPUs) and the JamaisVu counter state stay warm across the
+    switches. CPI is taken from the tick delta of every unit on cpu[0].
+    """
+    np = len(detailed_cpus)
+    to_warm = [(detailed_cpus[i], warm_cpus[i]) for i in range(np)]
+    to_detailed = [(warm_cpus[i], detailed_cpus[i]) for i in range(np)]
+
+    unit = options.smarts_unit
+    warmup = options.smarts_warmup
+    functional = options.smarts_period - unit - warmup
+    if functional <= 0:
+        fatal("--smarts-period must exceed --smarts-unit + --smarts-warmup")
+
+    period = testsys.cpu_clk_domain.clock[0].getValue()
+    z = _smarts_z_scores[options.smarts_confidence]
+
+    cpis = []
+    covered = 0
+    print("starting SMARTS sampling: unit %d, warmup %d, period %d" %
+          (unit, warmup, options.smarts_period))
+
+    while True:
+        exit_event, done = _smartsPhase(detailed_cpus[0], warmup,
+                                        "smarts detailed warmup done",
+                                        maxtick)
+        if not done:
+            break
+
+        start = m5.curTick()
+        exit_event, done = _smartsPhase(detailed_cpus[0], unit,
+                                        "smarts unit done", maxtick)
+        if not done:
+            break
+        cpis.append(float(m5.curTick() - start) / period / unit)
+
+        m5.switchCpus(testsys, to_warm, verbose=False)
+        exit_event, done = _smartsPhase(warm_cpus[0], functional,
+                                        "smarts functional warming done",
+                                        maxtick)
+        if not done:
+            break
+        m5.switchCpus(testsys, to_detailed, verbose=False)
+
+        covered += options.smarts_period
+        if options.maxinsts and covered >= options.maxinsts:
+            break
+
+    n = len(cpis)
+    if n > 1:
+        mean = sum(cpis) / n
+        var = sum((c - mean) ** 2 for c in cpis) / (n - 1)
+        half = z * (var ** 0.5) / (n ** 0.5)
+        cov = (var ** 0.5) / mean if mean else 0.0
+        print("SMARTS: %d units, CPI %.4f +/- %.4f (%.2f%%) at %s confidence,"
+              " CoV %.4f" % (n, mean, half, 100.0 * half / mean,
+                             options.smarts_confidence, cov))
+        with open(joinpath(m5.options.outdir, "smarts.txt"), "w") as f:
+            f.write("units %d\nunit_insts %d\nwarmup_insts %d\n"
+                    "period_insts %d\ncpi_mean %f\ncpi_ci_halfwidth %f\n"
+                    "confidence %s\ncpi_cov %f\n" %
+                    (n, unit, warmup, options.smarts_period, mean, half,
+                     options.smarts_confidence, cov))
+    else:
+        warn("SMARTS: only %d measurement unit(s) completed, no CPI "
+             "estimate", n)
+
+    return exit_event
+
+def setEventQueuePerCore(options, root, testsys):
+    """Move every CPU and the Ruby controllers that own its sequencer to
+    event queue cpu_id + 1, each simulated by a host thread of its own.
+    The shared caches, directories, memory and the network stay on queue
+    0 and exchange messages with the cores at quantum boundaries."""
+    if not options.ruby or options.network != "simple":
+        fatal("--eventq-per-core requires --ruby with the simple network")
+    if testsys.ruby.randomization or testsys.ruby.access_backing_store:
+        fatal("--eventq-per-core can't be used with Ruby randomization or "
+              "--access-backing-store")
+
+    for obj in testsys.descendants():
+        if isinstance(obj, BaseCPU):
+            obj.eventq_index = int(obj.cpu_id) + 1
+    for i, seq in enumerate(testsys.ruby._cpu_ports):
+        seq.get_parent().eventq_index = i + 1
+
+    root.sim_quantum = int(m5.ticks.fromSeconds(
+        m5.util.convert.anyToLatency(options.sim_quantum)))
+
 def run(options, root, testsys, cpu_class):
     if options.checkpoint_dir:
         cptdir = options.checkpoint_dir
@@ -459,6 +562,14 @@ def run(options, root, testsys, cpu_class):
     if options.repeat_switch and options.take_checkpoints:
         fatal("Can't specify both --repeat-switch and --take-checkpoints")
 
+    if options.smarts and not cpu_class:
+        fatal("--smarts requires switching into a detailed --cpu-type via "
+              "--checkpoint-restore or --fast-forward")
+
+    if options.smarts and (options.standard_switch or options.repeat_switch):
+        fatal("Can't combine --smarts with --standard-switch or "
+              "--repeat-switch")
+
     # Setup global stat filtering.
     stat_root_simobjs = []
     for stat_root_str in options.stats_root:
@@ -472,7 +583,8 @@ def run(options, root, testsys, cpu_class):
         for i in range(np):
             testsys.cpu[i].progress_interval = options.prog_interval
 
-    if options.maxinsts:
+    # With --smarts, --maxinsts bounds the sampled region instead
+    if options.maxinsts and not options.smarts:
         for i in range(np):
             testsys.cpu[i].max_insts_any_thread = options.maxinsts
 
@@ -493,7 +605,7 @@ def run(options, root, testsys, cpu_class):
                 testsys.cpu[i].progress_interval
             switch_cpus[i].isa = testsys.cpu[i].isa
             # simulation period
-            if options.maxinsts:
+            if options.maxinsts and not options.smarts:
                 switch_cpus[i].max_insts_any_thread = options.maxinsts
             # Add checker cpu if selected
             if options.checker:
@@ -515,6 +627,32 @@ def run(options, root, testsys, cpu_class):
         testsys.switch_cpus = switch_cpus
         switch_cpu_list = [(testsys.cpu[i], switch_cpus[i]) for i in range(np)]
 
+    if options.smarts:
+        if options.smarts_warm_cpu:
+            warm_class = getCPUClass(options.smarts_warm_cpu)[0]
+        elif options.ruby:
+            warm_class = TimingSimpleCPU
+        else:
+            warm_class = AtomicSimpleCPU
+        # Ruby caches are bypassed (and flushed) in atomic mode, so they
+        # can only be kept warm by a timing CPU
+        if options.ruby and warm_class.memory_mode() != 'timing':
+            fatal("--smarts with Ruby needs a timing --smarts-warm-cpu")
+
+        smarts_warm_cpus = [warm_class(switched_out=True, cpu_id=(i))
+                            for i in range(np)]
+        for i in range(np):
+            smarts_warm_cpus[i].system = testsys
+            smarts_warm_cpus[i].workload = testsys.cpu[i].workload
+            smarts_warm_cpus[i].clk_domain = testsys.cpu[i].clk_domain
+            smarts_warm_cpus[i].isa = testsys.cpu[i].isa
+            # Share the detailed CPU's predictor so it is trained during
+            # functional warming
+            if switch_cpus[i].branchPred:
+                smarts_warm_cpus[i].branchPred = switch_cpus[i].branchPred
+
+        testsys.smarts_warm_cpus = smarts_warm_cpus
+
     if options.repeat_switch:
         switch_class = getCPUClass(options.cpu_type)[0]
         if switch_class.require_caches() and \
@@ -629,6 +767,9 @@ def run(options, root, testsys, cpu_class):
     checkpoint_dir = None
     if options.checkpoint_restore:
         cpt_starttick, checkpoint_dir = findCptDir(options, cptdir, testsys)
+    root.eventq_calendar = options.eventq_calendar
+    if options.eventq_per_core:
+        setEventQueuePerCore(options, root, testsys)
     root.apply_config(options.param)
     m5.instantiate(checkpoint_dir)
 
@@ -716,6 +857,9 @@ def run(options, root, testsys, cpu_class):
         else:
             cptdir = getcwd()
 
+    if options.checkpoint_jobs:
+        m5.setBackgroundCheckpoints(options.checkpoint_jobs)
+
     if options.take_checkpoints != None :
         # Checkpoints being taken via the command line at <when> and at
         # subsequent periods of <period>.  Checkpoint instructions
@@ -738,7 +882,10 @@ def run(options, root, testsys, cpu_class):
 
         # If checkpoints are being taken, then the checkpoint instruction
         # will occur in the benchmark code it self.
-        if options.repeat_switch and maxtick > options.repeat_switch:
+        if options.smarts:
+            exit_event = runSmarts(options, testsys, switch_cpus,
+                                   smarts_warm_cpus, maxtick)
+        elif options.repeat_switch and maxtick > options.repeat_switch:
             exit_event = repeatSwitch(testsys, repeat_switch_cpu_list,
                                       maxtick, options.repeat_switch)
         else:
@@ -111,6 +111,8 @@ def build_test_system(np):
 
     # Set the cache line size for the entire system
     test_sys.cache_line_size = options.cacheline_size
+    if options.sparse_backstore:
+        test_sys.sparse_backstore = True
 
     # Create a top-level voltage domain
     test_sys.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
@@ -204,7 +206,8 @@ def build_test_system(np):
 
         for i in range(np):
             if options.simpoint_profile:
-                test_sys.cpu[i].addSimPointProbe(options.simpoint_interval)
+                test_sys.cpu[i].addSimPointProbe(options.simpoint_interval,
+                                                 options.simpoint_compact)
             if options.checker:
                 test_sys.cpu[i].addCheckerCpu()
             if not ObjectList.is_kvm_cpu(TestCPUClass):
@@ -194,6 +194,9 @@ system = System(cpu = [CPUClass(cpu_id=i) for i in range(np)],
 if numThreads > 1:
     system.multi_thread = True
 
+if options.sparse_backstore:
+    system.sparse_backstore = True
+
 # Create a top-level voltage domain
 system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
 
@@ -244,7 +247,8 @@ for i in range(np):
         system.cpu[i].workload = multiprocesses[i]
 
     if options.simpoint_profile:
-        system.cpu[i].addSimPointProbe(options.simpoint_interval)
+        system.cpu[i].addSimPointProbe(options.simpoint_interval,
+                                      options.simpoint_compact)
 
     if options.checker:
         system.cpu[i].addCheckerCpu()
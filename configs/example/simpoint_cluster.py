@@ -0,0 +1,68 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Picks SimPoints from the basic block vectors of a --simpoint-profile
+# run, replacing the external SimPoint 3.2 tool:
+#
+#   gem5.opt configs/example/simpoint_cluster.py m5out/simpoint.bb.gz
+#   gem5.opt configs/example/se.py ... \
+#       --take-simpoint-checkpoints=simpoints,weights,<interval>,<warmup>
+#
+# Text and compact (--simpoint-compact) BBV files are both accepted.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import optparse
+import sys
+
+import m5
+from _m5.simpoint import cluster
+
+parser = optparse.OptionParser(usage="%prog [options] <bbv file>")
+parser.add_option("--simpoints", default="simpoints",
+                  help="output file of the chosen intervals [%default]")
+parser.add_option("--weights", default="weights",
+                  help="output file of the cluster weights [%default]")
+parser.add_option("--max-k", type="int", default=30,
+                  help="maximum number of clusters [%default]")
+parser.add_option("--dims", type="int", default=15,
+                  help="dimensions of the random projection [%default]")
+parser.add_option("--threads", type="int", default=0,
+                  help="clustering threads, 0 for one per core [%default]")
+parser.add_option("--seed", type="int", default=493575226,
+                  help="seed of the projection and k-means [%default]")
+
+(options, args) = parser.parse_args()
+if len(args) != 1:
+    parser.print_help()
+    sys.exit(1)
+
+k = cluster(args[0], options.simpoints, options.weights,
+            max_k=options.max_k, dims=options.dims,
+            threads=options.threads, seed=options.seed)
+print("Chose %d clusters, written to %s and %s" %
+      (k, options.simpoints, options.weights))
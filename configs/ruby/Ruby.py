@@ -64,6 +64,11 @@ def define_options(parser):
 
     parser.add_option("--access-backing-store", action="store_true", default=False,
                       help="Should ruby maintain a second copy of memory")
+    parser.add_option("--ruby-functional-directory", type="choice",
+                      default="off", choices=["off", "on", "check"],
+                      help="Track the controllers holding each line to "
+                           "speed up functional accesses; 'check' also "
+                           "verifies the tracking on every access")
 
     # Options related to cache structure
     parser.add_option("--ports", action="store", type="int", default=4,
@@ -236,6 +241,11 @@ def create_system(options, full_system, system, piobus = None, dma_ports = [],
     ruby._cpu_ports = cpu_sequencers
     ruby.num_of_sequencers = len(cpu_sequencers)
 
+    if options.ruby_functional_directory != "off":
+        ruby.functional_directory = True
+        ruby.check_functional_directory = \
+            options.ruby_functional_directory == "check"
+
     # Create a backing copy of physical memory in case required
     if options.access_backing_store:
         ruby.access_backing_store = True
@@ -45,10 +45,11 @@ usage() {
     echo "                           {Unsafe, Spectre, Futuristic (default)}"
     echo "  --hw HW                  protection mechanism"
     echo "                           {Unsafe, Fence (stall mem inst only), \
-Fence-All (stall all types of inst, default)}"
+Fence-All (stall all types of inst, default), \
+DelayOnMiss (stall mem inst that miss in the L1 only)}"
     echo "  --lift-on-clear          lift fenced instructions when SB is cleared"
     echo "  --SB-struct STRUCTURE    SB hardware implementation"
-    echo "                           {Ideal, Bloom (default)}"
+    echo "                           {Ideal, Bloom (default), Hybrid}"
     echo "  -i, --max-insts INST     maximum number of simulated instructions"
     echo "  -w, --warmup-insts INST  number of warmup instructions"
     echo "  --dry-run                dry run without running gem5"
@@ -50,7 +50,8 @@ usage() {
     echo "                           {Unsafe, Spectre, Futuristic (default)}"
     echo "  --hw HW                  protection mechanism"
     echo "                           {Unsafe, Fence (stall mem inst only), \
-Fence-All (stall all types of inst, default)}"
+Fence-All (stall all types of inst, default), \
+DelayOnMiss (stall mem inst that miss in the L1 only)}"
     echo "  -i, --max-insts INST     maximum number of simulated instructions"
     echo "  -w, --warmup-insts INST  number of warmup instructions"
     echo "  --dry-run                dry run without running gem5"
@@ -53,10 +53,11 @@ usage() {
     echo "                            {Unsafe, Spectre, Futuristic (default)}"
     echo "  --hw HW                   protection mechanism"
     echo "                            {Unsafe, Fence (stall mem inst only), \
-Fence-All (stall all types of inst, default)}"
+Fence-All (stall all types of inst, default), \
+DelayOnMiss (stall mem inst that miss in the L1 only)}"
     echo "  --remove-on-retire        remove/decrement instructions from SB on retirement"
     echo "  --SB-struct STRUCTURE     SB hardware implementation"
-    echo "                            {Ideal, Bloom, CountingBloom (default)}"
+    echo "                            {Ideal, Bloom, CountingBloom (default), Hybrid}"
     echo "  -i, --max-insts INST      maximum number of simulated instructions"
     echo "  -w, --warmup-insts INST   number of warmup instructions"
     echo "  --dry-run                 dry run without running gem5"
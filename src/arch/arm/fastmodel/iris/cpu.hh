@@ -92,6 +92,15 @@ class BaseCPU : public ::BaseCPU
         return ::BaseCPU::getSendFunctional();
     }
 
+    PortProxy::SendBackdoorFunc
+    getSendFunctionalBackdoor() override
+    {
+        // Accesses through the model's own delegate have no back door.
+        if (sendFunctional)
+            return nullptr;
+        return ::BaseCPU::getSendFunctionalBackdoor();
+    }
+
   protected:
     sc_core::sc_module *evs;
 
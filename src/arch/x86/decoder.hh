@@ -30,6 +30,7 @@
 #define __ARCH_X86_DECODER_HH__
 
 #include <cassert>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -68,7 +69,9 @@ class Decoder : public InstDecoder
     static ByteTable ImmediateTypeThreeByte0F3A;
     static ByteTable ImmediateTypeVex[10];
 
-    static X86ISAInst::MicrocodeRom microcodeRom;
+    // Per decoder, as the micro-ops it hands out are reference counted
+    // by the thread simulating this CPU.
+    X86ISAInst::MicrocodeRom microcodeRom;
 
   protected:
     struct InstBytes
@@ -104,6 +107,8 @@ class Decoder : public InstDecoder
     uint8_t altAddr = 0;
     uint8_t defAddr = 0;
     uint8_t stack = 0;
+    // The m5Reg the current predecoding state was derived from.
+    RegVal curM5Reg = 0;
 
     uint8_t
     getNextByte()
@@ -236,10 +241,27 @@ class Decoder : public InstDecoder
     typedef std::unordered_map<CacheKey, DecodePages *> AddrCacheMap;
     AddrCacheMap addrCacheMap;
 
+    // Decoded instructions are shared by the decoders of one core
+    // rather than by all of them, so that the reference counts of the
+    // static instructions are only touched by the thread simulating
+    // that core, see shareInstCache().
     DecodeCache::InstMap<ExtMachInst> *instMap = nullptr;
     typedef std::unordered_map<
             CacheKey, DecodeCache::InstMap<ExtMachInst> *> InstCacheMap;
-    static InstCacheMap instCacheMap;
+    std::shared_ptr<InstCacheMap> instCacheMap =
+        std::make_shared<InstCacheMap>();
+
+    void
+    selectInstMap()
+    {
+        InstCacheMap::iterator imIter = instCacheMap->find(curM5Reg);
+        if (imIter != instCacheMap->end()) {
+            instMap = imIter->second;
+        } else {
+            instMap = new DecodeCache::InstMap<ExtMachInst>;
+            (*instCacheMap)[curM5Reg] = instMap;
+        }
+    }
 
   public:
     Decoder(ISA *isa=nullptr)
@@ -261,6 +283,7 @@ class Decoder : public InstDecoder
         altAddr = m5Reg.altAddr;
         defAddr = m5Reg.defAddr;
         stack = m5Reg.stack;
+        curM5Reg = m5Reg;
 
         AddrCacheMap::iterator amIter = addrCacheMap.find(m5Reg);
         if (amIter != addrCacheMap.end()) {
@@ -270,13 +293,21 @@ class Decoder : public InstDecoder
             addrCacheMap[m5Reg] = decodePages;
         }
 
-        InstCacheMap::iterator imIter = instCacheMap.find(m5Reg);
-        if (imIter != instCacheMap.end()) {
-            instMap = imIter->second;
-        } else {
-            instMap = new DecodeCache::InstMap<ExtMachInst>;
-            instCacheMap[m5Reg] = instMap;
-        }
+        selectInstMap();
+    }
+
+    /**
+     * Decode into the instructions of other, e.g., the decoder of
+     * another hardware thread of the same core, so that the threads
+     * share their StaticInsts and the replay state kept in them. Both
+     * decoders must be used by the same host thread.
+     */
+    void
+    shareInstCache(Decoder *other)
+    {
+        instCacheMap = other->instCacheMap;
+        if (instMap)
+            selectInstMap();
     }
 
     void
@@ -291,8 +322,12 @@ class Decoder : public InstDecoder
         altAddr = old->altAddr;
         defAddr = old->defAddr;
         stack = old->stack;
+        curM5Reg = old->curM5Reg;
     }
 
+    /// The m5Reg that currently determines how bytes are decoded.
+    RegVal m5Reg() const { return curM5Reg; }
+
     void reset() { state = ResetState; }
 
     void process();
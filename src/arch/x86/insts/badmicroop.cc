@@ -54,7 +54,7 @@ namespace X86ISA
 // theoretically be statically allocated. The reference counted pointer would
 // try to delete the static memory when it was destructed.
 
-const StaticInstPtr badMicroop =
+thread_local const StaticInstPtr badMicroop =
     new X86ISAInst::MicroDebug(dummyMachInst, "panic", "BAD",
         StaticInst::IsMicroop | StaticInst::IsLastMicroop,
         new GenericISA::M5PanicFault("Invalid microop!"));
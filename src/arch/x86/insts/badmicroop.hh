@@ -43,7 +43,9 @@
 namespace X86ISA
 {
 
-extern const StaticInstPtr badMicroop;
+// One per host thread so that reference counting stays within the
+// thread when CPUs run on separate event queues.
+extern thread_local const StaticInstPtr badMicroop;
 
 } // namespace X86ISA
 
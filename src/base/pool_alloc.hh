@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_POOL_ALLOC_HH__
+#define __BASE_POOL_ALLOC_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "base/logging.hh"
+
+/**
+ * Size-classed free-list allocator for small, frequently recycled
+ * simulator objects (cache entries, coherence messages, packets, ...).
+ *
+ * Requests are rounded up to a multiple of Granularity and served from
+ * per-size-class free lists that are refilled from large slabs, so
+ * objects of the same class end up packed together and allocation and
+ * release are a couple of pointer operations. Each host thread owns its
+ * own set of free lists, so no locking is needed; a block released on a
+ * different thread than the one that allocated it simply migrates to the
+ * releasing thread's free list. Slabs are never returned to the system.
+ *
+ * Classes opt in by forwarding their class-specific operator new/delete:
+ *
+ *     static void *operator new(size_t size)
+ *     { return PoolAlloc::allocate(size); }
+ *     static void operator delete(void *p, size_t size)
+ *     { PoolAlloc::deallocate(p, size); }
+ *
+ * The sized operator delete receives the size of the dynamic type when the
+ * class has a virtual destructor, so derived classes of different sizes
+ * share the mechanism transparently. Requests larger than MaxSize fall
+ * back to the global operator new/delete. Containers and
+ * std::allocate_shared can use the pool through PoolAllocator.
+ *
+ * Setting the environment variable M5_POOL_POISON enables a debug mode
+ * in which released blocks are filled with PoisonFree and checked for
+ * modifications when they are handed out again, and fresh blocks are
+ * filled with PoisonAlloc to expose reads of uninitialised memory.
+ */
+class PoolAlloc
+{
+  public:
+    static constexpr size_t Granularity = 16;
+    static constexpr size_t MaxSize = 1024;
+    static constexpr size_t NumClasses = MaxSize / Granularity;
+    static constexpr size_t SlabBytes = 64 * 1024;
+
+    static constexpr uint8_t PoisonAlloc = 0xa5;
+    static constexpr uint8_t PoisonFree = 0xdb;
+
+    /** Usage counters, see totals(). */
+    struct Counters
+    {
+        uint64_t allocs;
+        uint64_t releases;
+        uint64_t slabs;
+        uint64_t oversized;
+    };
+
+    static void *
+    allocate(size_t size)
+    {
+        PoolAlloc &pool = local();
+        if (size == 0 || size > MaxSize) {
+            pool.counters.oversized++;
+            void *p = ::operator new(size);
+            if (poison())
+                std::memset(p, PoisonAlloc, size);
+            return p;
+        }
+        return pool.get(sizeClass(size));
+    }
+
+    static void
+    deallocate(void *p, size_t size)
+    {
+        if (!p)
+            return;
+        if (size == 0 || size > MaxSize) {
+            ::operator delete(p);
+            return;
+        }
+        local().put(p, sizeClass(size));
+    }
+
+    /**
+     * Counters summed over all threads that ever used the pool. Other
+     * threads must not allocate concurrently, e.g., call this while the
+     * simulation threads wait at a barrier.
+     */
+    static Counters
+    totals()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        Counters sum = retired();
+        for (const PoolAlloc *pool : registry())
+            add(sum, pool->counters);
+        return sum;
+    }
+
+    static bool
+    poison()
+    {
+        static const bool enabled = std::getenv("M5_POOL_POISON");
+        return enabled;
+    }
+
+    /** Index of the size class serving requests of size bytes. */
+    static constexpr size_t
+    sizeClass(size_t size)
+    {
+        return (size + Granularity - 1) / Granularity - 1;
+    }
+
+    /** Bytes handed out for requests in size class cls. */
+    static constexpr size_t
+    classBytes(size_t cls)
+    {
+        return (cls + 1) * Granularity;
+    }
+
+  private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    /** Free lists of the calling thread, one per size class. */
+    FreeBlock *freeLists[NumClasses];
+    Counters counters;
+    bool enrolled;
+
+    /**
+     * Makes the counters of a thread visible to totals() and folds them
+     * into the retired ones when the thread exits.
+     */
+    struct Enrollment
+    {
+        PoolAlloc *pool;
+
+        Enrollment(PoolAlloc *_pool) : pool(_pool)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().push_back(pool);
+        }
+
+        ~Enrollment()
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            add(retired(), pool->counters);
+            auto &pools = registry();
+            for (auto it = pools.begin(); it != pools.end(); ++it) {
+                if (*it == pool) {
+                    pools.erase(it);
+                    break;
+                }
+            }
+        }
+    };
+
+    static std::mutex &
+    registryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<PoolAlloc *> &
+    registry()
+    {
+        static std::vector<PoolAlloc *> pools;
+        return pools;
+    }
+
+    static Counters &
+    retired()
+    {
+        static Counters counters;
+        return counters;
+    }
+
+    static void
+    add(Counters &sum, const Counters &c)
+    {
+        sum.allocs += c.allocs;
+        sum.releases += c.releases;
+        sum.slabs += c.slabs;
+        sum.oversized += c.oversized;
+    }
+
+    static PoolAlloc &
+    local()
+    {
+        // Zero-initialised and trivially destructible, so blocks may
+        // still be released while the thread is shutting down.
+        static thread_local PoolAlloc pool;
+        if (!pool.enrolled) {
+            pool.enrolled = true;
+            static thread_local Enrollment enrollment(&pool);
+        }
+        return pool;
+    }
+
+    void *
+    get(size_t cls)
+    {
+        FreeBlock *block = freeLists[cls];
+        if (!block)
+            block = refill(cls);
+        freeLists[cls] = block->next;
+        counters.allocs++;
+        if (poison())
+            checkPoison(block, cls);
+        return block;
+    }
+
+    void
+    put(void *p, size_t cls)
+    {
+        FreeBlock *block = static_cast<FreeBlock *>(p);
+        if (poison()) {
+            std::memset(block + 1, PoisonFree,
+                        classBytes(cls) - sizeof(FreeBlock));
+        }
+        block->next = freeLists[cls];
+        freeLists[cls] = block;
+        counters.releases++;
+    }
+
+    /** Verify the free pattern of a block and replace it. */
+    static void
+    checkPoison(FreeBlock *block, size_t cls)
+    {
+        const size_t bytes = classBytes(cls);
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(block + 1);
+        for (size_t i = 0; i < bytes - sizeof(FreeBlock); i++) {
+            panic_if(p[i] != PoisonFree,
+                     "PoolAlloc: %d-byte block %#x written to after its "
+                     "release (offset %d)\n", bytes, (uintptr_t)block,
+                     sizeof(FreeBlock) + i);
+        }
+        std::memset(block, PoisonAlloc, bytes);
+    }
+
+    /** Carve a new slab into blocks of class cls. */
+    FreeBlock *
+    refill(size_t cls)
+    {
+        const size_t bytes = classBytes(cls);
+        const size_t count = SlabBytes / bytes;
+        uint8_t *slab = static_cast<uint8_t *>(::operator new(SlabBytes));
+        if (poison())
+            std::memset(slab, PoisonFree, SlabBytes);
+        counters.slabs++;
+
+        FreeBlock *head = nullptr;
+        for (size_t i = count; i > 0; --i) {
+            FreeBlock *block =
+                reinterpret_cast<FreeBlock *>(slab + (i - 1) * bytes);
+            block->next = head;
+            head = block;
+        }
+        freeLists[cls] = head;
+        return head;
+    }
+};
+
+/**
+ * Standard allocator on top of PoolAlloc, e.g., for
+ * std::allocate_shared. Arrays larger than PoolAlloc::MaxSize bytes use
+ * the global operator new.
+ */
+template <class T>
+class PoolAllocator
+{
+  public:
+    typedef T value_type;
+
+    PoolAllocator() = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *
+    allocate(size_t n)
+    {
+        return static_cast<T *>(PoolAlloc::allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *p, size_t n)
+    {
+        PoolAlloc::deallocate(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U> &) const { return true; }
+    template <class U>
+    bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+
+#endif // __BASE_POOL_ALLOC_HH__
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "base/pool_alloc.hh"
+
+/** Requests are rounded up to the allocation granularity. */
+TEST(PoolAllocTest, SizeClasses)
+{
+    ASSERT_EQ(PoolAlloc::sizeClass(1), 0u);
+    ASSERT_EQ(PoolAlloc::sizeClass(PoolAlloc::Granularity), 0u);
+    ASSERT_EQ(PoolAlloc::sizeClass(PoolAlloc::Granularity + 1), 1u);
+    ASSERT_EQ(PoolAlloc::classBytes(PoolAlloc::sizeClass(100)), 112u);
+    ASSERT_EQ(PoolAlloc::sizeClass(PoolAlloc::MaxSize),
+              PoolAlloc::NumClasses - 1);
+}
+
+/** Live blocks are distinct, aligned and do not overlap. */
+TEST(PoolAllocTest, DistinctBlocks)
+{
+    const size_t size = 40;
+    std::vector<uint8_t *> blocks;
+    for (int i = 0; i < 10000; i++) {
+        uint8_t *p = static_cast<uint8_t *>(PoolAlloc::allocate(size));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t),
+                  0u);
+        std::memset(p, i & 0xff, size);
+        blocks.push_back(p);
+    }
+
+    std::set<uint8_t *> unique(blocks.begin(), blocks.end());
+    ASSERT_EQ(unique.size(), blocks.size());
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t j = 0; j < size; j++)
+            ASSERT_EQ(blocks[i][j], i & 0xff);
+        PoolAlloc::deallocate(blocks[i], size);
+    }
+}
+
+/** A released block is handed out again for the same size class. */
+TEST(PoolAllocTest, Recycle)
+{
+    void *a = PoolAlloc::allocate(64);
+    PoolAlloc::deallocate(a, 64);
+    void *b = PoolAlloc::allocate(60);
+    ASSERT_EQ(a, b);
+    PoolAlloc::deallocate(b, 60);
+}
+
+/** Oversized requests bypass the pool. */
+TEST(PoolAllocTest, Oversized)
+{
+    void *p = PoolAlloc::allocate(PoolAlloc::MaxSize + 1);
+    ASSERT_NE(p, nullptr);
+    std::memset(p, 0, PoolAlloc::MaxSize + 1);
+    PoolAlloc::deallocate(p, PoolAlloc::MaxSize + 1);
+}
+
+struct PooledBase
+{
+    virtual ~PooledBase() {}
+    static void *operator new(size_t size)
+    { return PoolAlloc::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { PoolAlloc::deallocate(p, size); }
+    uint64_t a = 1;
+};
+
+struct PooledDerived : public PooledBase
+{
+    uint64_t b[20] = {};
+};
+
+/** Deleting through a base pointer returns the block to its own class. */
+TEST(PoolAllocTest, Polymorphic)
+{
+    PooledBase *d = new PooledDerived;
+    delete d;
+    void *p = PoolAlloc::allocate(sizeof(PooledDerived));
+    ASSERT_EQ(p, static_cast<void *>(d));
+    PoolAlloc::deallocate(p, sizeof(PooledDerived));
+}
+
+/** Each thread allocates from its own free lists. */
+TEST(PoolAllocTest, PerThread)
+{
+    void *main_block = PoolAlloc::allocate(32);
+    PoolAlloc::deallocate(main_block, 32);
+
+    void *thread_block = nullptr;
+    std::thread t([&] {
+        thread_block = PoolAlloc::allocate(32);
+        PoolAlloc::deallocate(thread_block, 32);
+    });
+    t.join();
+
+    ASSERT_NE(main_block, thread_block);
+    void *again = PoolAlloc::allocate(32);
+    ASSERT_EQ(again, main_block);
+    PoolAlloc::deallocate(again, 32);
+}
+
+/** allocate_shared places the object and its control block in the pool. */
+TEST(PoolAllocTest, SharedPtr)
+{
+    PoolAlloc::Counters before = PoolAlloc::totals();
+    std::weak_ptr<PooledDerived> weak;
+    {
+        auto p = std::allocate_shared<PooledDerived>(
+            PoolAllocator<PooledDerived>());
+        weak = p;
+        ASSERT_EQ(p->a, 1u);
+    }
+    ASSERT_TRUE(weak.expired());
+    weak.reset();
+
+    PoolAlloc::Counters after = PoolAlloc::totals();
+    ASSERT_EQ(after.allocs, before.allocs + 1);
+    ASSERT_EQ(after.releases, before.releases + 1);
+}
+
+/** Counters of exited threads are kept. */
+TEST(PoolAllocTest, Totals)
+{
+    PoolAlloc::Counters before = PoolAlloc::totals();
+    std::thread t([] {
+        for (int i = 0; i < 3; i++)
+            PoolAlloc::deallocate(PoolAlloc::allocate(48), 48);
+        PoolAlloc::deallocate(PoolAlloc::allocate(PoolAlloc::MaxSize + 1),
+                              PoolAlloc::MaxSize + 1);
+    });
+    t.join();
+
+    PoolAlloc::Counters after = PoolAlloc::totals();
+    ASSERT_EQ(after.allocs, before.allocs + 3);
+    ASSERT_EQ(after.releases, before.releases + 3);
+    ASSERT_EQ(after.slabs, before.slabs + 1);
+    ASSERT_EQ(after.oversized, before.oversized + 1);
+}
@@ -202,6 +202,15 @@ class RefCountingPtr
     template <bool B = TisConst>
     RefCountingPtr(const NonConstT &r) { copy(r.data); }
 
+    /// Create a reference counting pointer to a base class from one to a
+    /// derived class.  Adds a reference.
+    template <class U, typename std::enable_if<
+        std::is_base_of<T, U>::value &&
+        !std::is_same<typename std::remove_cv<T>::type,
+                      typename std::remove_cv<U>::type>::value,
+        int>::type = 0>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -69,6 +69,13 @@ class TestRC : public RefCounted
 };
 typedef RefCountingPtr<TestRC> Ptr;
 
+class DerivedTestRC : public TestRC
+{
+  public:
+    int derivedVal;
+};
+typedef RefCountingPtr<DerivedTestRC> DerivedPtr;
+
 } // anonymous namespace
 
 TEST(RefcntTest, NullPointerCheck)
@@ -171,3 +178,20 @@ TEST(RefcntTest, EqualityOperators)
     EXPECT_TRUE(equalTestAPtr != equalTestB);
     EXPECT_TRUE(equalTestAPtr != equalTestBPtr);
 }
+
+TEST(RefcntTest, ConversionToBase)
+{
+    // Test converting a pointer to a derived class to one to its base.
+    {
+        DerivedPtr derived = new DerivedTestRC();
+        Ptr base = derived;
+        RefCountingPtr<const TestRC> const_base = derived;
+        EXPECT_EQ(derived.get(), base.get());
+        EXPECT_EQ(derived.get(), const_base.get());
+        derived = nullptr;
+        EXPECT_EQ(1, liveListSize());
+        base = nullptr;
+        EXPECT_EQ(1, liveListSize());
+    }
+    EXPECT_EQ(0, liveListSize());
+}
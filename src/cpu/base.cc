@@ -161,8 +161,8 @@ BaseCPU::BaseCPU(Params *p, bool is_checker)
         if (p->function_trace_start == 0) {
             functionTracingEnabled = true;
         } else {
-            Event *event = new EventFunctionWrapper(
-                [this]{ enableFunctionTrace(); }, name(), true);
+            Event *event = new OneShotEvent(
+                [this]{ enableFunctionTrace(); }, p->name.c_str());
             schedule(event, p->function_trace_start);
         }
     }
@@ -237,7 +237,7 @@ BaseCPU::mwaitAtomic(ThreadID tid, ThreadContext *tc, BaseTLB *dtb)
     assert(tid < numThreads);
     AddressMonitor &monitor = addressMonitor[tid];
 
-    RequestPtr req = std::make_shared<Request>();
+    RequestPtr req = makeRequest();
 
     Addr addr = monitor.vAddr;
     int block_size = cacheLineSize();
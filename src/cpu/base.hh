@@ -166,6 +166,21 @@ class BaseCPU : public ClockedObject
         return [port](PacketPtr pkt)->void { port->sendFunctional(pkt); };
     }
 
+    /**
+     * Returns a delegate requesting functional back doors through the
+     * data port, for use with port proxies.
+     */
+    virtual PortProxy::SendBackdoorFunc
+    getSendFunctionalBackdoor()
+    {
+        auto port = dynamic_cast<RequestPort *>(&getDataPort());
+        assert(port);
+        return [port](const AddrRange &range, MemBackdoor::Flags access,
+                      MemBackdoor &backdoor)->bool {
+            return port->sendFunctionalBackdoor(range, access, backdoor);
+        };
+    }
+
     /**
      * Purely virtual method that returns a reference to the instruction
      * port. All subclasses must implement this method.
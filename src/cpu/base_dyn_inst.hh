@@ -46,6 +46,7 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <limits>
 #include <list>
 #include <string>
 
@@ -141,6 +142,8 @@ protected:
         PendingSelfSquash,
         SquashHandled,
         EpochSeparator,
+        DelayedOnMiss,           /// Fenced load missed in the L1
+        DeferredTouch,           /// Fenced load hit, L1 LRU update pending
         NumStatus
     };
 
@@ -190,6 +193,8 @@ public:
     InstSeqNum violator_seqNum;
     InstSeqNum epochID = 0;
     utils::EpochScale eScale; // epoch scale
+    /** Squash buffer record the fence waits on, see ROB::liftFences(). */
+    InstSeqNum fenceRecord = std::numeric_limits<InstSeqNum>::max();
 
 protected:
     /** The result of the instruction; assumes an instruction can have many
@@ -1143,6 +1148,14 @@ public:
     SET_STATUS_DP(SquashHandled)
     IS_STATUS_D(SquashHandled)
 
+    SET_STATUS_DP(DelayedOnMiss)
+    RESET_STATUS_DP(DelayedOnMiss)
+    IS_STATUS_D(DelayedOnMiss)
+
+    SET_STATUS_DP(DeferredTouch)
+    RESET_STATUS_DP(DeferredTouch)
+    IS_STATUS_D(DeferredTouch)
+
     void liftFence() {
         resetFenced();
         setProtectionLifted();
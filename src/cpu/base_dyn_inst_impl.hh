@@ -268,17 +268,18 @@ void BaseDynInst<Impl>::setSquashed() {
                     case utils::COUNTER:
                         // Bit and counter checks
                         // Fence only loads
-                        if (GCONFIG.hw == utils::FENCE) {
+                        if (GCONFIG.hw == utils::FENCE ||
+                            GCONFIG.hw == utils::DELAY_ON_MISS) {
                             if (isLoad()) {
                                 MRAPRINT(SquashBFLD, this, staticInst);
-                                incrReplays();
+                                cpu->countReplay(threadNumber, staticInst);
                                 MRAPRINT(SquashAFLD, this, staticInst);
                             }
                         }
                         // Fence everything
                         else if (GCONFIG.hw == utils::FENCE_ALL) {
                             MRAPRINT(SquashBFLDAll, this, staticInst);
-                            incrReplays();
+                            cpu->countReplay(threadNumber, staticInst);
                             MRAPRINT(SquashAFLDAll, this, staticInst);
                         }
                         break;
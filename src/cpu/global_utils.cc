@@ -1,3 +1,4 @@
 #include "cpu/global_utils.hh"
 
 utils::CustomConfigs bridge::GCONFIG;
+thread_local uint64_t bridge::youngestSeqNums[utils::MaxTracedThreads];
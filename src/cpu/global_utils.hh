@@ -28,8 +28,8 @@
 #define DICT_GET(ELEM, DICT, DEFT) (IN_MAP(ELEM, DICT) ? DICT[pc] : DEFT)
 #define DICTPTR_GET(ELEM, DICT, DEFT) (IN_MAPPTR(ELEM, DICT) ? (*DICT)[pc] : DEFT)
 
-#define CHECK_SEQNUM(TID) (((bridge::GCONFIG.hasLowerBound && bridge::GCONFIG.youngestSeqNums[TID] >= bridge::GCONFIG.lowerSeqNum) || !bridge::GCONFIG.hasLowerBound) && \
-                           ((bridge::GCONFIG.hasUpperBound && bridge::GCONFIG.youngestSeqNums[TID] <= bridge::GCONFIG.upperSeqNum) || !bridge::GCONFIG.hasUpperBound))
+#define CHECK_SEQNUM(TID) (((bridge::GCONFIG.hasLowerBound && bridge::youngestSeqNums[TID] >= bridge::GCONFIG.lowerSeqNum) || !bridge::GCONFIG.hasLowerBound) && \
+                           ((bridge::GCONFIG.hasUpperBound && bridge::youngestSeqNums[TID] <= bridge::GCONFIG.upperSeqNum) || !bridge::GCONFIG.hasUpperBound))
 
 #define DSTATE(STATE, INST)                                                                \
     do {                                                                                   \
@@ -81,7 +81,8 @@ namespace utils {
 typedef enum {
     UNSAFE,    // no protection at all
     FENCE,     // fence loads only
-    FENCE_ALL  // fence every instruction
+    FENCE_ALL, // fence every instruction
+    DELAY_ON_MISS  // fence loads only, and only if they miss in the L1
 } HWType;
 
 typedef enum {
@@ -103,10 +104,23 @@ typedef enum {
     ROUTINE = 3,
 } EpochScale;
 
+typedef enum {
+    STATIC_EPOCHS,   // separators from the epoch file of the analyzer
+    DYNAMIC_EPOCHS,  // separators from the loop detector of fetch
+    HYBRID_EPOCHS,   // the file within its address range, else the detector
+} EpochSource;
+
+typedef enum {  // when replay counters go down
+    DECAY_ON_RETIRE,         // on every retirement of a replayed inst
+    DECAY_ON_CLEAN_RETIRES,  // after N retirements without a squash
+    DECAY_PERIODIC,          // halve all counters every period
+} CounterDecay;
+
 typedef enum {  //SB Structure
     IDEAL,
     BLOOM,
     COUNTING_BLOOM,
+    HYBRID,  // exact CAM, overflowing into a Bloom filter
 } sbStruct;
 
 struct CustomConfigs {
@@ -118,6 +132,7 @@ struct CustomConfigs {
     uint64_t maxInsts;
     uint32_t maxReplays;
     size_t maxSBSize;
+    size_t sbCAMEntries;
 
     bool isSpectre;
     bool isFuturistic;
@@ -127,10 +142,15 @@ struct CustomConfigs {
 
     std::string epochInfoPath;
     EpochScale epochSize;
+    EpochSource epochSource;
     bool deleteOnRetire;
     size_t activeRecords;
     bool checkAllRecords;
     size_t counterSize;
+    CounterDecay counterDecay;
+    uint32_t counterCleanRetires;
+    uint64_t counterDecayPeriod;
+    bool counterResetOnSwitch;
 
     HWType hw;
     replayDetection replayDet;
@@ -145,9 +165,11 @@ struct CustomConfigs {
     // debugging related
     uint64_t lowerSeqNum, upperSeqNum;  // range for print DSTATE information
     bool hasLowerBound, hasUpperBound;
-    uint64_t youngestSeqNums[65536];
 };
 
+// upper bound on the hardware thread ids used with CHECK_SEQNUM
+const size_t MaxTracedThreads = 256;
+
 typedef std::unordered_set<uint64_t> Counter_t;
 typedef std::shared_ptr<Counter_t> Counter_p;
 typedef std::unordered_map<uint64_t, Counter_p> CounterMap_t;
@@ -300,7 +322,9 @@ typedef std::shared_ptr<utils::CounterCache> CounterCache_p;
 
 namespace bridge {
 extern utils::CustomConfigs GCONFIG;
-extern std::vector<std::shared_ptr<utils::CounterCache>> CounterCaches;
+// youngest fetched sequence number per hardware thread, kept per host
+// thread as fetch updates it for every instruction
+extern thread_local uint64_t youngestSeqNums[utils::MaxTracedThreads];
 }  // namespace bridge
 
 #endif
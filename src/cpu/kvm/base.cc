@@ -155,9 +155,9 @@ BaseKvmCPU::startup()
         inform("KVM: Coalesced not supported by host OS\n");
     }
 
-    Event *startupEvent(
-        new EventFunctionWrapper([this]{ startupThread(); }, name(), true));
-    schedule(startupEvent, curTick());
+    schedule(new OneShotEvent([this]{ startupThread(); },
+                              params()->name.c_str()),
+             curTick());
 }
 
 BaseKvmCPU::Status
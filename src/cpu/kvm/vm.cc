@@ -50,6 +50,7 @@
 
 #include "cpu/kvm/base.hh"
 #include "debug/Kvm.hh"
+#include "mem/abstract_mem.hh"
 #include "params/KvmVM.hh"
 #include "sim/system.hh"
 
@@ -365,6 +366,10 @@ KvmVM::delayedStartup()
                       "a KVM VM.\n");
             }
 
+            // The guest writes the region behind the simulator's back.
+            if (memories[slot].writtenPages)
+                memories[slot].writtenPages->mark(0, range.size());
+
             const MemSlot slot = allocMemSlot(range.size());
             setupMemSlot(slot, pmem, range.start(), 0/* flags */);
         } else {
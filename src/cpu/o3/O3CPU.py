@@ -88,6 +88,10 @@ class DerivO3CPU(BaseCPU):
     fetchBufferSize = Param.Unsigned(64, "Fetch buffer size in bytes")
     fetchQueueSize = Param.Unsigned(32, "Fetch queue size in micro-ops "
                                     "per-thread")
+    decodedInstCacheEntries = Param.Unsigned(0, "Entries in the host-side "
+                                             "decoded instruction cache used "
+                                             "by fetch (0 disables it, x86 "
+                                             "only)")
 
     renameToDecodeDelay = Param.Cycles(1, "Rename to decode delay")
     iewToDecodeDelay = Param.Cycles(1, "Issue/Execute/Writeback to decode "
@@ -129,6 +133,13 @@ class DerivO3CPU(BaseCPU):
     LSQDepCheckShift = Param.Unsigned(4, "Number of places to shift addr before check")
     LSQCheckLoads = Param.Bool(True,
         "Should dependency violations be checked for loads & stores or just stores")
+    LSQAddrIndex = Param.Bool(False,
+        "Find forwarding stores and violating loads through an index of "
+        "the cache blocks the LSQ entries access instead of walking the "
+        "queues")
+    LSQAddrIndexCheck = Param.Bool(False,
+        "Use LSQAddrIndex and also walk the queues, panicking if the "
+        "results differ")
     store_set_clear_period = Param.Unsigned(250000,
             "Number of load/store insts before the dep predictor should be invalidated")
     LFSTSize = Param.Unsigned(1024, "Last fetched store table size")
@@ -169,6 +180,10 @@ class DerivO3CPU(BaseCPU):
     smtROBPolicy   = Param.SMTQueuePolicy('Partitioned',
                                           "SMT ROB Sharing Policy")
     smtROBThreshold = Param.Int(100, "SMT ROB Threshold Sharing Parameter")
+    smtReplayDetPolicy = Param.SMTQueuePolicy('Partitioned',
+                          "SMT Epoch record and counter cache Sharing Policy")
+    smtReplayDetThreshold = Param.Int(100,
+                          "SMT Epoch record Threshold Sharing Parameter")
     smtCommitPolicy = Param.CommitPolicy('RoundRobin', "SMT Commit Policy")
 
     branchPred = Param.BranchPredictor(LTAGE(), "Branch Predictor")
@@ -176,11 +191,17 @@ class DerivO3CPU(BaseCPU):
                           "Enable TSO Memory model")
     maxInsts        = Param.Int(1000000000, "Max number of instructions")
     threatModel     = Param.String("Unsafe", "Scheme of the processor")
-    HWName          = Param.String("Unsafe", "Scheme of the processor")
+    HWName          = Param.String("Unsafe", "Scheme of the processor "
+                                   "(Unsafe, Fence, Fence-All, DelayOnMiss)")
     isSpectre       = Param.Bool(False, "Is Spectre safe")
     isFuturistic    = Param.Bool(False, "Is Futuristic safe")
     replayDetScheme = Param.String("NoDetect", "Scheme of the replay detection")
-    sbHWStruct = Param.String("Ideal", "Structure of the squash buffer")
+    sbHWStruct = Param.String("Ideal", "Structure of the squash buffer "
+                              "(Ideal, Bloom, CountingBloom, Hybrid)")
+    sbCAMEntries = Param.Int(32, "Exact PC entries of a Hybrid squash "
+                             "buffer record before it spills into its filter; "
+                             "the filter gets the bits of a Bloom or "
+                             "CountingBloom record the CAM leaves")
     maxReplays = Param.Int(0, "Max number of replays before defense")
     maxSBSize = Param.Int(256, "Max number of squash buffer entries")
     replayDetThreat = Param.String("Issue", "Scheme of the replay threat model")
@@ -190,15 +211,32 @@ class DerivO3CPU(BaseCPU):
     CCMissLatency = Param.Int(8, "Counter cache miss latency")
     CCIdeal = Param.Bool(False, "Counter cache ideal (always hit)")
 
-    liftOnClear = Param.Bool(False, 'Lift existing fences on SB clear')
+    liftOnClear = Param.Bool(False, 'Lift the fences that wait on a squash '
+                             'buffer record when the record is cleared')
     projectedElemCnt = Param.Int(128, "Projected element count")
 
     epochInfoPath = Param.String("", "Path to the epoch file")
     epochSize     = Param.String("Iter", "epoch size: Iter, Loop, Rtn")
+    epochSource   = Param.String("Static", "epoch separators: Static (epoch "
+                                 "file), Dynamic (loop detector), Hybrid")
+    epochLoopTableEntries = Param.Unsigned(64, "Entries of the loop table "
+                                           "of the dynamic epoch detector")
+    epochLoopNest = Param.Unsigned(4, "Loop nest depth tracked by the "
+                                   "dynamic epoch detector")
     deleteOnRetire = Param.Bool(False, "Clear instructions from SB on retirement")
     activeRecords = Param.Int(12, "Maximum number of active epoch records")
     checkAllRecords = Param.Bool(False, "Check all active records to decide fence or not")
     counterSize = Param.Int(4, "Number of bits for counter")
+    counterDecay = Param.String("Retire", "When Counter replay counters go "
+                                "down: Retire, CleanRetires, Periodic")
+    counterCleanRetires = Param.Unsigned(4, "Retirements without a squash "
+                                         "before a counter goes down "
+                                         "(CleanRetires)")
+    counterDecayPeriod = Param.UInt64(1000000, "Committed instructions "
+                                      "between two halvings of all counters "
+                                      "(Periodic); older counts are stale")
+    counterResetOnSwitch = Param.Bool(False, "Reset all replay counters when "
+                                      "a thread is activated on the CPU")
 
     lowerSeqNum   = Param.Int(0, "lower bound for DSTATE")
     upperSeqNum   = Param.Int(0, "upper bound for DSTATE")
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring buffer of in-flight instructions kept in program order.
+ */
+
+#ifndef __CPU_O3_AGE_RING_HH__
+#define __CPU_O3_AGE_RING_HH__
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "cpu/inst_seq.hh"
+
+/**
+ * Entries of one thread's in-flight instructions in increasing sequence
+ * number order. Entries are added at the young end and leave from the
+ * young end on a squash or from the old end once they are done, so the
+ * storage is a ring that only grows if more instructions than the
+ * initial capacity are ever in flight at once. Entries are addressed by
+ * their position from the oldest one and located by sequence number
+ * with a binary search; T must have a member seqNum.
+ */
+template <class T>
+class AgeRing
+{
+  public:
+    explicit AgeRing(size_t capacity = 0)
+        : buf(capacity ? capacity : 1), head(0), count(0)
+    {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return buf.size(); }
+
+    /** Entry pos positions younger than the oldest one. */
+    T &operator[](size_t pos) { return buf[slot(pos)]; }
+    const T &operator[](size_t pos) const { return buf[slot(pos)]; }
+
+    T &front() { return (*this)[0]; }
+    T &back() { return (*this)[count - 1]; }
+
+    void
+    push_back(const T &entry)
+    {
+        assert(empty() || back().seqNum < entry.seqNum);
+        if (count == buf.size())
+            grow();
+        buf[slot(count)] = entry;
+        count++;
+    }
+
+    void
+    pop_front()
+    {
+        assert(count);
+        buf[head] = T();
+        head = head + 1 == buf.size() ? 0 : head + 1;
+        count--;
+    }
+
+    void
+    pop_back()
+    {
+        assert(count);
+        buf[slot(count - 1)] = T();
+        count--;
+    }
+
+    void
+    clear()
+    {
+        while (count)
+            pop_back();
+        head = 0;
+    }
+
+    /** Position of the entry of seq_num, or size() if there is none. */
+    size_t
+    find(InstSeqNum seq_num) const
+    {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if ((*this)[mid].seqNum < seq_num)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo < count && (*this)[lo].seqNum == seq_num ? lo : count;
+    }
+
+  private:
+    size_t
+    slot(size_t pos) const
+    {
+        size_t s = head + pos;
+        return s < buf.size() ? s : s - buf.size();
+    }
+
+    void
+    grow()
+    {
+        std::vector<T> bigger(buf.size() * 2);
+        for (size_t pos = 0; pos < count; pos++)
+            bigger[pos] = std::move((*this)[pos]);
+        buf.swap(bigger);
+        head = 0;
+    }
+
+    std::vector<T> buf;
+    size_t head;
+    size_t count;
+};
+
+#endif // __CPU_O3_AGE_RING_HH__
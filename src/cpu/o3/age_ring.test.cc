@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <random>
+
+#include "cpu/o3/age_ring.hh"
+
+namespace {
+
+struct Entry
+{
+    InstSeqNum seqNum = 0;
+    int value = 0;
+};
+
+} // anonymous namespace
+
+/** Entries stay in insertion order and are found by sequence number. */
+TEST(AgeRingTest, Order)
+{
+    AgeRing<Entry> ring(4);
+    for (InstSeqNum sn = 2; sn <= 8; sn += 2)
+        ring.push_back({sn, int(sn) * 10});
+
+    ASSERT_EQ(ring.size(), 4u);
+    EXPECT_EQ(ring.front().seqNum, 2u);
+    EXPECT_EQ(ring.back().seqNum, 8u);
+    for (size_t pos = 0; pos < ring.size(); pos++) {
+        EXPECT_EQ(ring[pos].seqNum, 2 * (pos + 1));
+        EXPECT_EQ(ring.find(ring[pos].seqNum), pos);
+    }
+
+    // Sequence numbers between, before and after entries are absent.
+    EXPECT_EQ(ring.find(1), ring.size());
+    EXPECT_EQ(ring.find(5), ring.size());
+    EXPECT_EQ(ring.find(9), ring.size());
+}
+
+/** Popping from both ends keeps the order when the ring wraps around. */
+TEST(AgeRingTest, WrapAround)
+{
+    AgeRing<Entry> ring(4);
+    InstSeqNum next = 1;
+    for (int round = 0; round < 10; round++) {
+        while (ring.size() < 3)
+            ring.push_back({next++, 0});
+        ring.pop_front();
+        ring.pop_front();
+        ASSERT_EQ(ring.capacity(), 4u);
+    }
+    ring.push_back({next++, 0});
+    ring.push_back({next++, 0});
+    ring.pop_back();
+
+    ASSERT_EQ(ring.size(), 2u);
+    EXPECT_EQ(ring.front().seqNum + 1, ring.back().seqNum);
+    EXPECT_EQ(ring.find(ring.back().seqNum), 1u);
+}
+
+/** Growing a wrapped ring moves the entries without reordering them. */
+TEST(AgeRingTest, Grow)
+{
+    AgeRing<Entry> ring(4);
+    ring.push_back({1, 0});
+    ring.push_back({2, 0});
+    ring.pop_front();
+    ring.pop_front();
+    for (InstSeqNum sn = 10; sn < 20; sn++)
+        ring.push_back({sn, int(sn)});
+
+    EXPECT_GE(ring.capacity(), 10u);
+    ASSERT_EQ(ring.size(), 10u);
+    for (size_t pos = 0; pos < ring.size(); pos++) {
+        EXPECT_EQ(ring[pos].seqNum, 10 + pos);
+        EXPECT_EQ(ring[pos].value, int(10 + pos));
+    }
+
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+    ring.push_back({30, 0});
+    EXPECT_EQ(ring.find(30), 0u);
+}
+
+/** A random mix of operations matches a deque. */
+TEST(AgeRingTest, MatchesDeque)
+{
+    std::mt19937 rng(1);
+    AgeRing<Entry> ring(2);
+    std::deque<InstSeqNum> ref;
+    InstSeqNum next = 1;
+    for (int i = 0; i < 10000; i++) {
+        switch (rng() % 4) {
+          case 0:
+          case 1:
+            next += 1 + rng() % 3;
+            ring.push_back({next, 0});
+            ref.push_back(next);
+            break;
+          case 2:
+            if (!ref.empty()) {
+                ring.pop_front();
+                ref.pop_front();
+            }
+            break;
+          case 3:
+            if (!ref.empty()) {
+                ring.pop_back();
+                ref.pop_back();
+            }
+            break;
+        }
+
+        ASSERT_EQ(ring.size(), ref.size());
+        if (!ref.empty()) {
+            size_t pos = rng() % ref.size();
+            ASSERT_EQ(ring[pos].seqNum, ref[pos]);
+            ASSERT_EQ(ring.find(ref[pos]), pos);
+        }
+    }
+}
@@ -488,9 +488,9 @@ template <class Impl>
 void DefaultCommit<Impl>::generateTrapEvent(ThreadID tid, Fault inst_fault) {
     DPRINTF(Commit, "Generating trap event for [tid:%i]\n", tid);
 
-    EventFunctionWrapper *trap = new EventFunctionWrapper(
+    Event *trap = new OneShotEvent(
         [this, tid] { processTrapEvent(tid); },
-        "Trap", true, Event::CPU_Tick_Pri);
+        "Trap", Event::CPU_Tick_Pri);
 
     Cycles latency = dynamic_pointer_cast<SyscallRetryFault>(inst_fault) ? cpu->syscallRetryLatency : trapLatency;
 
@@ -52,6 +52,7 @@
 #include "cpu/colors.hh"
 #include "cpu/global_utils.hh"
 #include "cpu/o3/isa_specific.hh"
+#include "cpu/o3/smt_replay_det.hh"
 #include "cpu/o3/thread_context.hh"
 #include "cpu/simple_thread.hh"
 #include "cpu/thread_context.hh"
@@ -66,19 +67,68 @@
 #include "sim/stat_control.hh"
 #include "sim/system.hh"
 
-std::vector<std::shared_ptr<utils::CounterCache>> bridge::CounterCaches;
-
 struct BaseCPUParams;
 
 using namespace TheISA;
 using namespace std;
 using bridge::GCONFIG;
 
+/** True if two O3 CPUs agree on everything that goes into GCONFIG. */
+static bool
+sameGlobalConfig(const DerivO3CPUParams *a, const DerivO3CPUParams *b)
+{
+    return a->isSpectre == b->isSpectre &&
+        a->isFuturistic == b->isFuturistic &&
+        a->maxInsts == b->maxInsts &&
+        a->threatModel == b->threatModel &&
+        a->HWName == b->HWName &&
+        a->replayDetScheme == b->replayDetScheme &&
+        a->sbHWStruct == b->sbHWStruct &&
+        a->maxReplays == b->maxReplays &&
+        a->maxSBSize == b->maxSBSize &&
+        a->sbCAMEntries == b->sbCAMEntries &&
+        a->replayDetThreat == b->replayDetThreat &&
+        a->CCEnable == b->CCEnable &&
+        a->CCAssoc == b->CCAssoc &&
+        a->CCSets == b->CCSets &&
+        a->CCMissLatency == b->CCMissLatency &&
+        a->CCIdeal == b->CCIdeal &&
+        a->liftOnClear == b->liftOnClear &&
+        a->projectedElemCnt == b->projectedElemCnt &&
+        a->epochInfoPath == b->epochInfoPath &&
+        a->deleteOnRetire == b->deleteOnRetire &&
+        a->activeRecords == b->activeRecords &&
+        a->checkAllRecords == b->checkAllRecords &&
+        a->counterSize == b->counterSize &&
+        a->counterDecay == b->counterDecay &&
+        a->counterCleanRetires == b->counterCleanRetires &&
+        a->counterDecayPeriod == b->counterDecayPeriod &&
+        a->counterResetOnSwitch == b->counterResetOnSwitch &&
+        a->epochSize == b->epochSize &&
+        a->epochSource == b->epochSource &&
+        a->lowerSeqNum == b->lowerSeqNum &&
+        a->upperSeqNum == b->upperSeqNum &&
+        a->hasLowerBound == b->hasLowerBound &&
+        a->hasUpperBound == b->hasUpperBound;
+}
+
 BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
     : BaseCPU(oparams) {
     // set all the extra options to a global config object for easy access
     auto *params = dynamic_cast<DerivO3CPUParams *>(oparams);
     if (params) {
+        // GCONFIG is shared by all O3 CPUs and must stay read-only once
+        // the simulation starts, as the CPUs may then run on different
+        // host threads. The first CPU sets it up, the others must agree.
+        static const DerivO3CPUParams *configured = nullptr;
+        if (configured) {
+            fatal_if(!sameGlobalConfig(configured, params),
+                     "%s: JamaisVu parameters differ from those of %s\n",
+                     name(), configured->name);
+            return;
+        }
+        configured = params;
+
         GCONFIG.isSpectre = params->isSpectre;
         GCONFIG.isFuturistic = params->isFuturistic;
         GCONFIG.maxInsts = params->maxInsts;
@@ -88,6 +138,7 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
         GCONFIG.sbHWStruct = params->sbHWStruct;
         GCONFIG.maxReplays = params->maxReplays;
         GCONFIG.maxSBSize = params->maxSBSize;
+        GCONFIG.sbCAMEntries = params->sbCAMEntries;
         GCONFIG.replayDetThreat = params->replayDetThreat;
         GCONFIG.CCEnable = params->CCEnable;
         GCONFIG.CCAssoc = params->CCAssoc;
@@ -101,11 +152,20 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
         GCONFIG.activeRecords = params->activeRecords;
         GCONFIG.checkAllRecords = params->checkAllRecords;
         GCONFIG.counterSize = params->counterSize;
+        GCONFIG.counterCleanRetires = params->counterCleanRetires;
+        GCONFIG.counterDecayPeriod = params->counterDecayPeriod;
+        GCONFIG.counterResetOnSwitch = params->counterResetOnSwitch;
+        fatal_if(GCONFIG.counterSize < 1 || GCONFIG.counterSize > 30,
+                 "counterSize (%d) must be between 1 and 30 bits",
+                 GCONFIG.counterSize);
+        fatal_if(!GCONFIG.counterCleanRetires || !GCONFIG.counterDecayPeriod,
+                 "counterCleanRetires and counterDecayPeriod must not be 0");
 
         map<std::string, utils::HWType> availableHW = {
             {"Unsafe", utils::UNSAFE},
             {"Fence", utils::FENCE},
-            {"Fence-All", utils::FENCE_ALL}};
+            {"Fence-All", utils::FENCE_ALL},
+            {"DelayOnMiss", utils::DELAY_ON_MISS}};
         GCONFIG.hw = availableHW.at(GCONFIG.HWName);
 
         map<std::string, utils::replayDetection> availableReplayGran = {
@@ -115,10 +175,17 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
             {"Epoch", utils::EPOCH}};
         GCONFIG.replayDet = availableReplayGran.at(GCONFIG.replayDetScheme);
 
+        map<std::string, utils::CounterDecay> availableCounterDecay = {
+            {"Retire", utils::DECAY_ON_RETIRE},
+            {"CleanRetires", utils::DECAY_ON_CLEAN_RETIRES},
+            {"Periodic", utils::DECAY_PERIODIC}};
+        GCONFIG.counterDecay = availableCounterDecay.at(params->counterDecay);
+
         map<std::string, utils::sbStruct> availableSbHwStructs = {
             {"Ideal", utils::IDEAL},
             {"Bloom", utils::BLOOM},
-            {"CountingBloom", utils::COUNTING_BLOOM}};
+            {"CountingBloom", utils::COUNTING_BLOOM},
+            {"Hybrid", utils::HYBRID}};
         GCONFIG.sbHW = availableSbHwStructs.at(GCONFIG.sbHWStruct);
 
         map<std::string, utils::replayDetectionThreat> availableDetThreat = {
@@ -132,13 +199,16 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
             {"Rtn", utils::ROUTINE}};
         GCONFIG.epochSize = availableEpochScale.at(params->epochSize);
 
+        map<std::string, utils::EpochSource> availableEpochSource = {
+            {"Static", utils::STATIC_EPOCHS},
+            {"Dynamic", utils::DYNAMIC_EPOCHS},
+            {"Hybrid", utils::HYBRID_EPOCHS}};
+        GCONFIG.epochSource = availableEpochSource.at(params->epochSource);
+
         GCONFIG.lowerSeqNum = params->lowerSeqNum;
         GCONFIG.upperSeqNum = params->upperSeqNum;
         GCONFIG.hasLowerBound = params->hasLowerBound;
         GCONFIG.hasUpperBound = params->hasUpperBound;
-        for (size_t i = 0; i < 65536; i++) {
-            GCONFIG.youngestSeqNums[i] = 0;
-        }
 
         cerr << ZINFO
              << "Hardware: " << GCONFIG.HWName
@@ -154,6 +224,12 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
              << "; CCIdeal: " << GCONFIG.CCIdeal
              << endl
              << ZINFO
+             << "counterDecay: " << params->counterDecay
+             << "; counterCleanRetires: " << GCONFIG.counterCleanRetires
+             << "; counterDecayPeriod: " << GCONFIG.counterDecayPeriod
+             << "; counterResetOnSwitch: " << GCONFIG.counterResetOnSwitch
+             << endl
+             << ZINFO
              << "liftOnClear: " << GCONFIG.liftOnClear
              << endl
              << ZINFO
@@ -161,10 +237,12 @@ BaseO3CPU::BaseO3CPU(BaseCPUParams *oparams)
              << endl
              << ZINFO
              << "epochSize: " << params->epochSize
+             << "; epochSource: " << params->epochSource
              << "; deleteOnRetire: " << GCONFIG.deleteOnRetire
              << "; activeRecords: " << GCONFIG.activeRecords
              << "; checkAllRecords: " << GCONFIG.checkAllRecords
              << "; sbHWStruct: " << GCONFIG.sbHWStruct
+             << "; sbCAMEntries: " << GCONFIG.sbCAMEntries
              << "; counterSize: " << GCONFIG.counterSize
              << endl;
 
@@ -229,7 +307,8 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
 
       globalSeqNum(1),
       system(params->system),
-      lastRunningCycle(curCycle()) {
+      lastRunningCycle(curCycle()),
+      replayCounters(GCONFIG) {
     if (!params->switched_out) {
         _status = Running;
     } else {
@@ -308,6 +387,21 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
     rename.setScoreboard(&scoreboard);
     iew.setScoreboard(&scoreboard);
 
+    // SMT threads share the active records of the Epoch squash buffers
+    // as the ROB shares its entries. Their filters cannot be resized at
+    // run time, so each thread's are sized for its share of the records.
+    // The Clear-on-Retire buffer is not shared and keeps its filter.
+    std::shared_ptr<typename BaseSquashBuffer<Impl>::Budget> sb_budget;
+    size_t sb_elems = GCONFIG.projectedElemCnt;
+    if (numThreads > 1 && GCONFIG.replayDet == utils::EPOCH) {
+        size_t total = GCONFIG.activeRecords;
+        size_t per_thread = SMTReplayDet::recordCap(total, numThreads,
+            params->smtReplayDetPolicy, params->smtReplayDetThreshold);
+        sb_elems = SMTReplayDet::filterElems(sb_elems, total, per_thread);
+        sb_budget.reset(new typename BaseSquashBuffer<Impl>::Budget(
+            total, per_thread));
+    }
+
     // Setup the rename map for whichever stages need it.
     for (ThreadID tid = 0; tid < numThreads; tid++) {
         isa[tid] = dynamic_cast<TheISA::ISA *>(params->isa[tid]);
@@ -328,17 +422,19 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
         switch (GCONFIG.replayDet) {
             case utils::BUFFER:
                 squashBuffers[tid].reset(
-                    new SimpleSquashBuffer<Impl>(this, GCONFIG.maxSBSize, GCONFIG.projectedElemCnt));
+                    new SimpleSquashBuffer<Impl>(this, GCONFIG.maxSBSize, sb_elems));
                 break;
             case utils::EPOCH:
                 squashBuffers[tid].reset(
                     new EpochSquashBuffer<Impl>(this, GCONFIG.maxSBSize, GCONFIG.activeRecords,
-                                                GCONFIG.projectedElemCnt));
+                                                sb_elems));
                 break;
             default:
                 // do nothing
                 break;
         }
+        if (sb_budget)
+            squashBuffers[tid]->setBudget(sb_budget);
     }
 
     // Initialize rename map to assign physical registers to the
@@ -652,6 +748,18 @@ void FullO3CPU<Impl>::regStats() {
     cpuSBClears
         .name(name() + ".cpuSBClears")
         .desc("Number of SB clears");
+
+    cpuCounterSaturations
+        .name(name() + ".cpuCounterSaturations")
+        .desc("Number of replays not counted as the counter saturated");
+
+    cpuCounterDecays
+        .name(name() + ".cpuCounterDecays")
+        .desc("Number of counters halved by periodic decay");
+
+    cpuCounterResets
+        .name(name() + ".cpuCounterResets")
+        .desc("Number of times all replay counters were reset");
 }
 
 template <class Impl>
@@ -728,6 +836,9 @@ void FullO3CPU<Impl>::init() {
         thread[tid]->noSquashFromTC = false;
 
     commit.setThreads(thread);
+
+    if (!switchedOut())
+        verifyProbeSupport();
 }
 
 template <class Impl>
@@ -813,6 +924,11 @@ void FullO3CPU<Impl>::activateContext(ThreadID tid) {
     // Needs to set each stage to running as well.
     activateThread(tid);
 
+    // A different workload may run from now on; what its predecessor
+    // replayed says nothing about it.
+    if (GCONFIG.counterResetOnSwitch && GCONFIG.replayDet == utils::COUNTER)
+        resetReplays();
+
     // We don't want to wake the CPU if it is drained. In that case,
     // we just want to flag the thread as active and schedule the tick
     // event from drainResume() instead.
@@ -1242,6 +1358,11 @@ void FullO3CPU<Impl>::takeOverFrom(BaseCPU *oldCPU) {
     if (oldO3CPU)
         globalSeqNum = oldO3CPU->globalSeqNum;
 
+    if (GCONFIG.counterResetOnSwitch && GCONFIG.replayDet == utils::COUNTER)
+        resetReplays();
+
+    verifyProbeSupport();
+
     lastRunningCycle = curCycle();
     _status = Idle;
 }
@@ -1255,6 +1376,16 @@ void FullO3CPU<Impl>::verifyMemoryMode() const {
     }
 }
 
+template <class Impl>
+void FullO3CPU<Impl>::verifyProbeSupport() {
+    // Without a cache that answers the probes, every fenced load would
+    // miss and DelayOnMiss would silently behave like Fence.
+    fatal_if(GCONFIG.hw == utils::DELAY_ON_MISS &&
+             !iew.ldstQueue.getDataPort().isFunctionalProbeSupported(),
+             "%s: DelayOnMiss needs a Ruby sequencer behind the data port, "
+             "run with --ruby", name());
+}
+
 template <class Impl>
 RegVal
 FullO3CPU<Impl>::readMiscRegNoEffect(int misc_reg, ThreadID tid) const {
@@ -1852,7 +1983,8 @@ void FullO3CPU<Impl>::mraDefenceUpdate(ThreadID tid, DynInstPtr inst) {
                     if (squashBuffer(tid)->clear(inst)) {
                         cpuSBClears++;
                         if (GCONFIG.liftOnClear) {
-                            rob.liftFences(tid);
+                            rob.liftFences(
+                                tid, squashBuffer(tid)->clearedRecord());
                         }
                     }
                 }
@@ -1863,6 +1995,10 @@ void FullO3CPU<Impl>::mraDefenceUpdate(ThreadID tid, DynInstPtr inst) {
                     DSTATE(EpochClear, inst);
                     squashBuffer(tid)->clear(inst);
                     cpuSBClears++;
+                    if (GCONFIG.liftOnClear) {
+                        rob.liftFences(
+                            tid, squashBuffer(tid)->clearedRecord());
+                    }
                 }
                 if (GCONFIG.deleteOnRetire) {
                     squashBuffer(tid)->retire(inst);
@@ -1870,31 +2006,47 @@ void FullO3CPU<Impl>::mraDefenceUpdate(ThreadID tid, DynInstPtr inst) {
                 break;
             case utils::COUNTER:
                 if (inst->isReplayed()) {
-                    if (GCONFIG.hw == utils::FENCE) {
+                    if (GCONFIG.hw == utils::FENCE ||
+                        GCONFIG.hw == utils::DELAY_ON_MISS) {
                         if (inst->isLoad()) {
                             MRAPRINT(RetireBFLD, inst, inst->staticInst);
-                            inst->decrReplays();
-                            ++cpuMemDecrements;
-                            ++cpuAllDecrements;
+                            if (replayCounters.retire(inst->staticInst)) {
+                                ++cpuMemDecrements;
+                                ++cpuAllDecrements;
+                            }
                             MRAPRINT(RetireAFLD, inst, inst->staticInst);
                         }
                     }
                     // Fence everything
                     else if (GCONFIG.hw == utils::FENCE_ALL) {
                         MRAPRINT(RetireBFLDAll, inst, inst->staticInst);
-                        inst->decrReplays();
-                        ++cpuAllDecrements;
-                        if (inst->isLoad()) {
-                            ++cpuMemDecrements;
+                        if (replayCounters.retire(inst->staticInst)) {
+                            ++cpuAllDecrements;
+                            if (inst->isLoad()) {
+                                ++cpuMemDecrements;
+                            }
                         }
                         MRAPRINT(RetireAFLDAll, inst, inst->staticInst);
                     }
                 }
+                cpuCounterDecays += replayCounters.commit();
                 break;
         }
     }
 }
 
+template <class Impl>
+void FullO3CPU<Impl>::countReplay(ThreadID tid, const StaticInstPtr &si) {
+    if (!replayCounters.count(tid, si))
+        ++cpuCounterSaturations;
+}
+
+template <class Impl>
+void FullO3CPU<Impl>::resetReplays() {
+    replayCounters.reset();
+    ++cpuCounterResets;
+}
+
 template <class Impl>
 void
 FullO3CPU<Impl>::htmSendAbortSignal(ThreadID tid, uint64_t htm_uid,
@@ -1911,7 +2063,7 @@ FullO3CPU<Impl>::htmSendAbortSignal(ThreadID tid, uint64_t htm_uid,
 
     // notify l1 d-cache (ruby) that core has aborted transaction
     RequestPtr req =
-        std::make_shared<Request>(addr, size, flags, _dataRequestorId);
+        makeRequest(addr, size, flags, _dataRequestorId);
 
     req->taskId(taskId());
     req->setContext(this->thread[tid]->contextId());
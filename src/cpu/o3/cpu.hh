@@ -48,6 +48,7 @@
 #include <memory>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "arch/generic/types.hh"
@@ -58,6 +59,7 @@
 #include "cpu/base.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/cpu_policy.hh"
+#include "cpu/o3/replay_counters.hh"
 #include "cpu/o3/scoreboard.hh"
 #include "cpu/o3/squash_buffer.hh"
 #include "cpu/o3/thread_state.hh"
@@ -304,6 +306,9 @@ class FullO3CPU : public BaseO3CPU {
 
     void verifyMemoryMode() const override;
 
+    /** Check that the data port can answer the L1 probes of DelayOnMiss. */
+    void verifyProbeSupport();
+
     /** Get the current instruction sequence number, and increment it. */
     InstSeqNum getAndIncrementInstSeq() {
         return globalSeqNum++;
@@ -746,6 +751,11 @@ class FullO3CPU : public BaseO3CPU {
         return this->iew.ldstQueue.write(req, data, store_idx);
     }
 
+    /** Forwards the deferred L1 replacement update of a load to the LSQ. */
+    void touchDeferred(const DynInstPtr &inst) {
+        this->iew.ldstQueue.touchDeferred(inst);
+    }
+
     /** Used by the fetch unit to get a hold of the instruction port. */
     Port&
     getInstPort() override {
@@ -761,6 +771,28 @@ class FullO3CPU : public BaseO3CPU {
     // update the MRA defense instrmetadata
     void mraDefenceUpdate(ThreadID tid, DynInstPtr instr);
 
+    /**
+     * Count a squash of thread tid in the saturating replay counter of
+     * si (Counter). Threads share the counters of the code they share.
+     */
+    void countReplay(ThreadID tid, const StaticInstPtr &si);
+
+    /** True if the replay count of si is older than a decay period. */
+    bool
+    isStaleReplay(const StaticInstPtr &si) const
+    {
+        return replayCounters.isStale(si);
+    }
+
+  private:
+    /** Clear the replay counters of the instructions tracked. */
+    void resetReplays();
+
+    /** Replay counters of the Counter scheme and their decay. */
+    ReplayCounters<StaticInstPtr> replayCounters;
+
+  public:
+
     /** Stat for total number of times the CPU is descheduled. */
     Stats::Scalar timesIdled;
     /** Stat for total number of cycles the CPU spends descheduled. */
@@ -809,6 +841,9 @@ class FullO3CPU : public BaseO3CPU {
     Stats::Scalar cpuCCMisses;
     Stats::Scalar cpuCCHits;
     Stats::Scalar cpuSBClears;
+    Stats::Scalar cpuCounterSaturations;
+    Stats::Scalar cpuCounterDecays;
+    Stats::Scalar cpuCounterResets;
 
   public:
     // hardware transactional memory
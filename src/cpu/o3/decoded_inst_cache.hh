@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_DECODED_INST_CACHE_HH__
+#define __CPU_O3_DECODED_INST_CACHE_HH__
+
+#include <cstring>
+#include <vector>
+
+#include "arch/decoder.hh"
+#include "arch/types.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/types.hh"
+#include "config/the_isa.hh"
+#include "cpu/static_inst.hh"
+
+/**
+ * Host-side cache of decoded instructions for the O3 fetch stage.
+ *
+ * Fetch normally feeds every instruction to the ISA decoder chunk by chunk
+ * (moreBytes()/decode()). For the hot loops that dominate SimPoint
+ * intervals the result is always the same StaticInst and the same next-PC
+ * update, so this direct-mapped table remembers, per (PC, decoder
+ * context), the decoded StaticInst, the PC state before and after
+ * decoding and the raw fetch chunks the instruction was decoded from.
+ *
+ * A hit is only taken if the chunks currently in the fetch buffer are
+ * bit-identical to the recorded ones, so self-modifying code simply misses
+ * and goes back through the decoder; no explicit invalidation is needed.
+ * The cache never changes simulated behaviour.
+ */
+class DecodedInstCache
+{
+  public:
+    /** Longest instruction (in fetch chunks) that is cached. */
+    static const unsigned MaxChunks = 3;
+
+    struct Entry
+    {
+        Addr pc = MaxAddr;
+        RegVal context = 0;
+        /** PC state handed to the decoder. */
+        TheISA::PCState fetchPC;
+        /** PC state after the decoder updated the next PC. */
+        TheISA::PCState decodedPC;
+        StaticInstPtr inst;
+        unsigned numChunks = 0;
+        TheISA::MachInst chunks[MaxChunks];
+    };
+
+    DecodedInstCache() = default;
+
+    void
+    init(unsigned num_entries)
+    {
+        fatal_if(num_entries && !isPowerOf2(num_entries),
+                 "decodedInstCacheEntries (%d) must be a power of 2",
+                 num_entries);
+#if THE_ISA != X86_ISA
+        fatal_if(num_entries,
+                 "The decoded instruction cache is only supported on x86");
+#endif
+        entries.clear();
+        entries.resize(num_entries);
+        indexMask = num_entries ? num_entries - 1 : 0;
+    }
+
+    bool enabled() const { return !entries.empty(); }
+
+    /** Decoder state that affects how bytes are decoded. */
+    static RegVal
+    decoderContext(TheISA::Decoder *decoder)
+    {
+#if THE_ISA == X86_ISA
+        return decoder->m5Reg();
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * Look up the instruction starting at fetch_pc whose bytes start at
+     * chunks[0]. avail is the number of valid chunks in the buffer.
+     */
+    const Entry *
+    lookup(const TheISA::PCState &fetch_pc, RegVal context,
+           const TheISA::MachInst *chunks, unsigned avail) const
+    {
+        const Entry &e = entries[index(fetch_pc.instAddr())];
+        if (e.pc != fetch_pc.instAddr() || e.context != context ||
+            !(e.fetchPC == fetch_pc) || e.numChunks > avail ||
+            std::memcmp(e.chunks, chunks,
+                        e.numChunks * sizeof(TheISA::MachInst)) != 0) {
+            return nullptr;
+        }
+        return &e;
+    }
+
+    void
+    insert(const TheISA::PCState &fetch_pc,
+           const TheISA::PCState &decoded_pc, RegVal context,
+           const StaticInstPtr &inst, const TheISA::MachInst *chunks,
+           unsigned num_chunks)
+    {
+        if (num_chunks == 0 || num_chunks > MaxChunks)
+            return;
+
+        Entry &e = entries[index(fetch_pc.instAddr())];
+        e.pc = fetch_pc.instAddr();
+        e.context = context;
+        e.fetchPC = fetch_pc;
+        e.decodedPC = decoded_pc;
+        e.inst = inst;
+        e.numChunks = num_chunks;
+        std::memcpy(e.chunks, chunks,
+                    num_chunks * sizeof(TheISA::MachInst));
+    }
+
+  private:
+    size_t
+    index(Addr pc) const
+    {
+        return (pc ^ (pc >> 12)) & indexMask;
+    }
+
+    std::vector<Entry> entries;
+    size_t indexMask = 0;
+};
+
+#endif // __CPU_O3_DECODED_INST_CACHE_HH__
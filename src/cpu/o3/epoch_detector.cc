@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/o3/epoch_detector.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+const uint8_t EpochDetector::Confident;
+const uint8_t EpochDetector::MaxConfidence;
+
+EpochDetector::EpochDetector(unsigned table_entries, unsigned max_nest)
+    : table(table_entries), headers(table_entries, MaxAddr),
+      indexBits(floorLog2(table_entries)), mask(table_entries - 1),
+      maxNest(max_nest)
+{
+    fatal_if(!table_entries || !isPowerOf2(table_entries),
+             "The epoch loop table size (%d) must be a power of 2",
+             table_entries);
+    fatal_if(!max_nest, "The epoch loop nest must hold at least one loop");
+    nest.reserve(max_nest);
+    history.push_back({0, 0, {}});
+}
+
+const EpochDetector::Entry *
+EpochDetector::byBranch(Addr pc) const
+{
+    const Entry &e = table[index(pc)];
+    return e.branch == pc && e.confidence >= Confident ? &e : nullptr;
+}
+
+const EpochDetector::Entry *
+EpochDetector::byHeader(Addr pc) const
+{
+    Addr branch = headers[index(pc)];
+    if (branch == MaxAddr)
+        return nullptr;
+    const Entry *e = byBranch(branch);
+    return e && e->header == pc ? e : nullptr;
+}
+
+EpochDetector::Scale
+EpochDetector::observe(Addr pc)
+{
+    Scale scale = None;
+
+    // Loops of routines that have returned are left.
+    while (!nest.empty() && nest.back().callDepth > callDepth) {
+        nest.pop_back();
+        scale = Loop;
+    }
+
+    // So is the innermost loop when fetch leaves its body. Code of
+    // routines it calls runs at a greater depth and stays inside.
+    while (!nest.empty() && nest.back().callDepth == callDepth &&
+           !nest.back().contains(pc)) {
+        nest.pop_back();
+        scale = Loop;
+    }
+
+    // Fetching a header from outside its loop enters the loop.
+    if (const Entry *e = byHeader(pc)) {
+        if (nest.empty() || nest.back().header != pc ||
+            nest.back().callDepth != callDepth) {
+            if (nest.size() == maxNest)
+                nest.erase(nest.begin());
+            nest.push_back({e->header, e->branch, callDepth});
+            scale = Loop;
+        }
+    }
+
+    if (scale == Loop)
+        dirty = true;
+    else if (byBranch(pc))
+        scale = Iteration;
+
+    return scale;
+}
+
+void
+EpochDetector::train(Addr pc, Addr target)
+{
+    assert(target < pc);
+
+    Entry &e = table[index(pc)];
+    if (e.branch == pc && e.header == target) {
+        e.confidence = std::min<uint8_t>(e.confidence + 1, MaxConfidence);
+        return;
+    }
+
+    // Another loop maps to the entry; it has to lose its confidence
+    // before it is replaced.
+    if (e.confidence > 0 && e.branch != MaxAddr) {
+        e.confidence--;
+        return;
+    }
+
+    e.branch = pc;
+    e.header = target;
+    e.confidence = 1;
+    headers[index(target)] = pc;
+}
+
+void
+EpochDetector::checkpoint(InstSeqNum seq_num)
+{
+    if (!dirty)
+        return;
+    assert(seq_num > history.back().seqNum);
+    history.push_back({seq_num, callDepth, nest});
+    dirty = false;
+}
+
+void
+EpochDetector::squash(InstSeqNum seq_num)
+{
+    while (history.size() > 1 && history.back().seqNum > seq_num)
+        history.pop_back();
+    callDepth = history.back().callDepth;
+    nest = history.back().nest;
+    dirty = false;
+}
+
+void
+EpochDetector::commit(InstSeqNum seq_num)
+{
+    while (history.size() > 1 && history[1].seqNum <= seq_num)
+        history.pop_front();
+}
+
+void
+EpochDetector::reset()
+{
+    nest.clear();
+    callDepth = 0;
+    history.assign(1, {0, 0, {}});
+    dirty = false;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_EPOCH_DETECTOR_HH__
+#define __CPU_O3_EPOCH_DETECTOR_HH__
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+
+/**
+ * Run-time replacement for the epoch file of the offline analyzer, see
+ * util/epoch. Like the analyzer, it places iteration separators on the
+ * backward branches of loops and loop separators where a loop is
+ * entered or left, but it finds the loops from the branches fetch
+ * predicts taken, so it also covers JIT-generated and dynamically
+ * loaded code.
+ *
+ * A direct-mapped loop table remembers backward branches together with
+ * their target, the loop header, and a saturating confidence counter.
+ * Once a loop is confident, its branch is an iteration separator, and
+ * fetching its header from outside the loop pushes it on a small stack
+ * of active loops, the loop nest. A loop is left when fetch leaves its
+ * body, [header, branch], at the call depth it was entered at, or
+ * returns from the routine it is in.
+ *
+ * As fetch runs ahead on predicted paths, the call depth and the nest
+ * are checkpointed with the instructions that change them, and a
+ * squash returns them to the state after the youngest instruction that
+ * survives it.
+ */
+class EpochDetector
+{
+  public:
+    /** Separator scales, ordered as utils::EpochScale. */
+    enum Scale
+    {
+        None = 0,
+        Iteration = 1,
+        Loop = 2,
+    };
+
+    /** Taken backward branches before a loop is trusted. */
+    static const uint8_t Confident = 2;
+    static const uint8_t MaxConfidence = 3;
+
+    /**
+     * @param table_entries Loop table size, a power of 2.
+     * @param max_nest Depth of the loop nest that is tracked.
+     */
+    EpochDetector(unsigned table_entries, unsigned max_nest);
+
+    /**
+     * Account for the next instruction fetched, and return the scale
+     * of the separator it is.
+     *
+     * @param pc Address of the instruction (its first micro-op).
+     */
+    Scale observe(Addr pc);
+
+    /** Record a branch at pc predicted taken backwards to target. */
+    void train(Addr pc, Addr target);
+
+    /** Record a call or return fetched after the last observe(). */
+    void
+    call()
+    {
+        callDepth++;
+        dirty = true;
+    }
+
+    void
+    ret()
+    {
+        if (callDepth > 0) {
+            callDepth--;
+            dirty = true;
+        }
+    }
+
+    /**
+     * Tag the changes made since the last checkpoint with the
+     * instruction that made them.
+     */
+    void checkpoint(InstSeqNum seq_num);
+
+    /** Undo the changes of the instructions younger than seq_num. */
+    void squash(InstSeqNum seq_num);
+
+    /** Drop the checkpoints no squash can return past seq_num. */
+    void commit(InstSeqNum seq_num);
+
+    /** Forget the loop nest, e.g., when the thread is switched out. */
+    void reset();
+
+    /** Loops in the nest, innermost last. */
+    unsigned nestDepth() const { return nest.size(); }
+
+  private:
+    struct Entry
+    {
+        Addr branch = MaxAddr;
+        Addr header = MaxAddr;
+        uint8_t confidence = 0;
+    };
+
+    struct ActiveLoop
+    {
+        Addr header;
+        Addr branch;
+        unsigned callDepth;
+
+        bool contains(Addr pc) const { return pc >= header && pc <= branch; }
+    };
+
+    /** Call depth and nest after the instruction seqNum. */
+    struct Checkpoint
+    {
+        InstSeqNum seqNum;
+        unsigned callDepth;
+        std::vector<ActiveLoop> nest;
+    };
+
+    unsigned index(Addr pc) const { return (pc ^ (pc >> indexBits)) & mask; }
+
+    /** The confident loop whose branch is at pc, if any. */
+    const Entry *byBranch(Addr pc) const;
+
+    /** The confident loop whose header is at pc, if any. */
+    const Entry *byHeader(Addr pc) const;
+
+    /** Loop table, indexed by branch address. */
+    std::vector<Entry> table;
+    /** Branch address of the loop of each header, indexed by header. */
+    std::vector<Addr> headers;
+    unsigned indexBits;
+    Addr mask;
+
+    unsigned maxNest;
+    std::vector<ActiveLoop> nest;
+    unsigned callDepth = 0;
+
+    /**
+     * Checkpoints, oldest first. The oldest one is the state no squash
+     * goes back past.
+     */
+    std::deque<Checkpoint> history;
+    /** If the state changed since the last checkpoint. */
+    bool dirty = false;
+};
+
+#endif // __CPU_O3_EPOCH_DETECTOR_HH__
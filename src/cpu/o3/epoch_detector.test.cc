@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "cpu/o3/epoch_detector.hh"
+
+namespace {
+
+/**
+ * Fetch the straight-line code [start, end] four bytes at a time and
+ * return the separators found.
+ */
+std::vector<EpochDetector::Scale>
+run(EpochDetector &d, Addr start, Addr end)
+{
+    std::vector<EpochDetector::Scale> scales;
+    for (Addr pc = start; pc <= end; pc += 4)
+        scales.push_back(d.observe(pc));
+    return scales;
+}
+
+/** Iterate the loop [header, branch] n times and fall out of it. */
+std::vector<EpochDetector::Scale>
+loop(EpochDetector &d, Addr header, Addr branch, int n)
+{
+    std::vector<EpochDetector::Scale> scales;
+    for (int i = 0; i < n; i++) {
+        auto body = run(d, header, branch);
+        scales.insert(scales.end(), body.begin(), body.end());
+        if (i < n - 1)
+            d.train(branch, header);
+    }
+    return scales;
+}
+
+} // anonymous namespace
+
+/** A loop is trusted after Confident taken backward branches. */
+TEST(EpochDetectorTest, LearnsLoop)
+{
+    EpochDetector d(64, 4);
+    loop(d, 0x1000, 0x1010, EpochDetector::Confident + 1);
+    d.observe(0x1014);
+
+    // Entering the loop again is a loop separator, every branch of it an
+    // iteration separator, and leaving it another loop separator.
+    ASSERT_EQ(d.observe(0xffc), EpochDetector::None);
+    auto scales = loop(d, 0x1000, 0x1010, 3);
+    ASSERT_EQ(scales.size(), 15u);
+    ASSERT_EQ(scales[0], EpochDetector::Loop);
+    for (int i = 1; i < 15; i++) {
+        ASSERT_EQ(scales[i], i % 5 == 4 ? EpochDetector::Iteration
+                                        : EpochDetector::None) << i;
+    }
+    ASSERT_EQ(d.nestDepth(), 1u);
+    ASSERT_EQ(d.observe(0x1014), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 0u);
+}
+
+/** Inner loops nest within outer ones. */
+TEST(EpochDetectorTest, Nest)
+{
+    EpochDetector d(64, 4);
+    for (int i = 0; i < 3; i++) {
+        run(d, 0x2000, 0x2004);
+        loop(d, 0x2008, 0x2010, 3);
+        run(d, 0x2014, 0x2018);
+        d.train(0x2018, 0x2000);
+    }
+    ASSERT_EQ(d.observe(0x201c), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 0u);
+
+    ASSERT_EQ(d.observe(0x2000), EpochDetector::Loop);
+    ASSERT_EQ(d.observe(0x2004), EpochDetector::None);
+    ASSERT_EQ(d.observe(0x2008), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 2u);
+    run(d, 0x200c, 0x2010);
+    ASSERT_EQ(d.observe(0x2014), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 1u);
+    ASSERT_EQ(d.observe(0x2018), EpochDetector::Iteration);
+}
+
+/** Routines called from a loop body stay inside the loop. */
+TEST(EpochDetectorTest, Calls)
+{
+    EpochDetector d(64, 4);
+    loop(d, 0x3000, 0x3010, 4);
+    d.observe(0x3014);
+
+    ASSERT_EQ(d.observe(0x3000), EpochDetector::Loop);
+    ASSERT_EQ(d.observe(0x3004), EpochDetector::None);
+    d.call();
+    ASSERT_EQ(d.observe(0x8000), EpochDetector::None);
+    ASSERT_EQ(d.observe(0x8004), EpochDetector::None);
+    d.ret();
+    ASSERT_EQ(d.nestDepth(), 1u);
+    ASSERT_EQ(d.observe(0x3008), EpochDetector::None);
+
+    // Returning from the routine the loop is in leaves it.
+    ASSERT_EQ(d.observe(0x300c), EpochDetector::None);
+    d.ret();
+    ASSERT_EQ(d.observe(0x9000), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 0u);
+}
+
+/** A conflicting loop replaces a table entry only once it is cold. */
+TEST(EpochDetectorTest, Replacement)
+{
+    EpochDetector d(1, 4);
+    for (int i = 0; i < 3; i++)
+        d.train(0x4010, 0x4000);
+    ASSERT_EQ(d.observe(0x4010), EpochDetector::Iteration);
+
+    d.train(0x5010, 0x5000);
+    ASSERT_EQ(d.observe(0x4010), EpochDetector::Iteration);
+    for (int i = 0; i < 3; i++)
+        d.train(0x5010, 0x5000);
+    ASSERT_EQ(d.observe(0x4010), EpochDetector::None);
+    d.train(0x5010, 0x5000);
+    ASSERT_EQ(d.observe(0x5010), EpochDetector::Iteration);
+}
+
+/** A call fetched on a squashed path leaves no trace in the call depth. */
+TEST(EpochDetectorTest, SquashedCall)
+{
+    EpochDetector d(64, 4);
+    loop(d, 0x6000, 0x6010, 4);
+    d.observe(0x6014);
+
+    ASSERT_EQ(d.observe(0x6000), EpochDetector::Loop);
+    d.checkpoint(10);
+    ASSERT_EQ(d.observe(0x6004), EpochDetector::None);
+    d.checkpoint(11);
+
+    // The branch at 0x6004 is mispredicted not taken, into a call.
+    ASSERT_EQ(d.observe(0x6008), EpochDetector::None);
+    d.call();
+    d.checkpoint(12);
+    ASSERT_EQ(d.observe(0x8000), EpochDetector::None);
+    d.checkpoint(13);
+    ASSERT_EQ(d.nestDepth(), 1u);
+
+    d.squash(11);
+    run(d, 0x600c, 0x6010);
+    ASSERT_EQ(d.observe(0x6014), EpochDetector::Loop);
+    ASSERT_EQ(d.nestDepth(), 0u);
+}
+
+/** Loops left on a squashed path are entered again. */
+TEST(EpochDetectorTest, SquashedExit)
+{
+    EpochDetector d(64, 4);
+    loop(d, 0x6000, 0x6010, 4);
+    d.observe(0x6014);
+
+    ASSERT_EQ(d.observe(0x6000), EpochDetector::Loop);
+    d.checkpoint(10);
+    ASSERT_EQ(d.observe(0x6004), EpochDetector::None);
+    d.checkpoint(11);
+
+    // A wrong-path return leaves the loop.
+    d.ret();
+    d.checkpoint(12);
+    ASSERT_EQ(d.observe(0x9000), EpochDetector::Loop);
+    d.checkpoint(13);
+    ASSERT_EQ(d.nestDepth(), 0u);
+
+    d.commit(10);
+    d.squash(11);
+    ASSERT_EQ(d.nestDepth(), 1u);
+    ASSERT_EQ(d.observe(0x6008), EpochDetector::None);
+    ASSERT_EQ(d.observe(0x6010), EpochDetector::Iteration);
+
+    // Without the checkpoints of committed instructions, a squash
+    // returns to the state after the youngest of them.
+    d.squash(10);
+    ASSERT_EQ(d.nestDepth(), 1u);
+    ASSERT_EQ(d.observe(0x6014), EpochDetector::Loop);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Fenced instructions of a thread, by the squash buffer record they
+ * wait on, see ROB::liftFences().
+ */
+
+#ifndef __CPU_O3_FENCE_WAITERS_HH__
+#define __CPU_O3_FENCE_WAITERS_HH__
+
+#include <deque>
+#include <iterator>
+#include <map>
+
+#include "cpu/inst_seq.hh"
+
+/**
+ * Each record keeps its instructions in program order, so squashes
+ * remove them from the back and retirement from the front. Clearing
+ * record r releases every record up to r, the oldest first.
+ *
+ * @tparam DynInstPtr Pointer to an instruction with seqNum,
+ * isFenced(), isSquashed() and liftFence().
+ */
+template <class DynInstPtr>
+class FenceWaiters
+{
+  public:
+    /** Let inst wait for record to clear. */
+    void
+    add(const DynInstPtr &inst, InstSeqNum record)
+    {
+        waiters[record].push_back(inst);
+    }
+
+    /** Forget inst, the oldest instruction of its thread, if it waits. */
+    void
+    retire(const DynInstPtr &inst, InstSeqNum record)
+    {
+        if (waiters.empty())
+            return;
+        auto it = waiters.find(record);
+        if (it != waiters.end() && it->second.front() == inst) {
+            it->second.pop_front();
+            if (it->second.empty())
+                waiters.erase(it);
+        }
+    }
+
+    /** Forget the instructions younger than seq_num. */
+    void
+    squash(InstSeqNum seq_num)
+    {
+        for (auto it = waiters.begin(); it != waiters.end(); ) {
+            auto &insts = it->second;
+            while (!insts.empty() && insts.back()->seqNum > seq_num)
+                insts.pop_back();
+            it = insts.empty() ? waiters.erase(it) : std::next(it);
+        }
+    }
+
+    /**
+     * Lift the fences of the instructions waiting on records up to and
+     * including record.
+     *
+     * @return Number of fences lifted.
+     */
+    unsigned
+    lift(InstSeqNum record)
+    {
+        unsigned lifted = 0;
+        auto end = waiters.upper_bound(record);
+        for (auto it = waiters.begin(); it != end; ++it) {
+            for (auto &inst : it->second) {
+                if (inst->isFenced() && !inst->isSquashed()) {
+                    inst->liftFence();
+                    lifted++;
+                }
+            }
+        }
+        waiters.erase(waiters.begin(), end);
+        return lifted;
+    }
+
+    void clear() { waiters.clear(); }
+
+    /** Number of instructions waiting. */
+    size_t
+    size() const
+    {
+        size_t n = 0;
+        for (const auto &p : waiters)
+            n += p.second.size();
+        return n;
+    }
+
+  private:
+    std::map<InstSeqNum, std::deque<DynInstPtr>> waiters;
+};
+
+#endif // __CPU_O3_FENCE_WAITERS_HH__
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "cpu/o3/fence_waiters.hh"
+
+namespace {
+
+struct Inst
+{
+    explicit Inst(InstSeqNum sn) : seqNum(sn) {}
+
+    bool isFenced() const { return fenced; }
+    bool isSquashed() const { return squashed; }
+    void liftFence() { fenced = false; }
+
+    InstSeqNum seqNum;
+    bool fenced = true;
+    bool squashed = false;
+};
+
+typedef std::shared_ptr<Inst> InstPtr;
+
+} // anonymous namespace
+
+/**
+ * A clear lifts the fences waiting on the records it releases, even
+ * while older instructions still wait on newer records.
+ */
+TEST(FenceWaitersTest, LiftEarly)
+{
+    FenceWaiters<InstPtr> waiters;
+    auto older = std::make_shared<Inst>(10);
+    auto younger = std::make_shared<Inst>(11);
+    auto youngest = std::make_shared<Inst>(12);
+    waiters.add(older, 3);
+    waiters.add(younger, 1);
+    waiters.add(youngest, 2);
+
+    ASSERT_EQ(waiters.lift(1), 1u);
+    EXPECT_TRUE(older->isFenced());
+    EXPECT_FALSE(younger->isFenced());
+    EXPECT_TRUE(youngest->isFenced());
+    ASSERT_EQ(waiters.size(), 2u);
+
+    ASSERT_EQ(waiters.lift(2), 1u);
+    EXPECT_TRUE(older->isFenced());
+    EXPECT_FALSE(youngest->isFenced());
+
+    ASSERT_EQ(waiters.lift(3), 1u);
+    EXPECT_FALSE(older->isFenced());
+    ASSERT_EQ(waiters.size(), 0u);
+}
+
+/** Squashed instructions do not hold up the retirement of a record. */
+TEST(FenceWaitersTest, Squash)
+{
+    FenceWaiters<InstPtr> waiters;
+    auto kept = std::make_shared<Inst>(5);
+    auto squashed = std::make_shared<Inst>(8);
+    waiters.add(kept, 2);
+    waiters.add(squashed, 2);
+    waiters.add(std::make_shared<Inst>(9), 4);
+
+    squashed->squashed = true;
+    waiters.squash(6);
+    ASSERT_EQ(waiters.size(), 1u);
+
+    // The instruction fetched again after the squash waits behind the
+    // older one and leaves once that one retired.
+    auto refetched = std::make_shared<Inst>(10);
+    waiters.add(refetched, 2);
+    waiters.retire(kept, 2);
+    waiters.retire(refetched, 2);
+    ASSERT_EQ(waiters.size(), 0u);
+
+    ASSERT_EQ(waiters.lift(4), 0u);
+    EXPECT_TRUE(squashed->isFenced());
+}
+
+/** Instructions that do not wait on a record retire unnoticed. */
+TEST(FenceWaitersTest, RetireOthers)
+{
+    FenceWaiters<InstPtr> waiters;
+    auto waiting = std::make_shared<Inst>(3);
+    waiters.add(waiting, 1);
+
+    waiters.retire(std::make_shared<Inst>(2), 1);
+    waiters.retire(std::make_shared<Inst>(2), 7);
+    ASSERT_EQ(waiters.size(), 1u);
+    waiters.retire(waiting, 1);
+    ASSERT_EQ(waiters.size(), 0u);
+}
@@ -48,6 +48,8 @@
 #include "arch/utility.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
+#include "cpu/o3/decoded_inst_cache.hh"
+#include "cpu/o3/epoch_detector.hh"
 #include "cpu/pc_event.hh"
 #include "cpu/pred/bpred_unit.hh"
 #include "cpu/timebuf.hh"
@@ -221,12 +223,29 @@ class DefaultFetch
     ProbePointArg<RequestPtr> *ppFetchRequestSent;
 
     utils::CounterMap_p CCMap;
+    /** Per-thread counter caches of this CPU. */
+    std::vector<utils::CounterCache_p> CounterCaches;
 
     InstSeqNum epochStatus[Impl::MaxThreads];
     std::unordered_map<Addr, utils::EpochScale> epochInfo;
+    /** Address range covered by the epoch file, for Hybrid. */
+    Addr epochInfoLow, epochInfoHigh;
+
+    /** Per-thread loop detectors, unless epochs are Static. */
+    std::vector<EpochDetector> epochDetectors;
 
     bool readEpochInfo();
 
+    /**
+     * Scale of the epoch separator inst is, from the epoch file, the
+     * loop detector, or both, depending on GCONFIG.epochSource.
+     */
+    utils::EpochScale epochScale(ThreadID tid, const DynInstPtr &inst);
+
+    /** Pass the control flow fetch predicted for inst to the detector. */
+    void trainEpochDetector(const DynInstPtr &inst,
+                            const TheISA::PCState &target);
+
   public:
     /** DefaultFetch constructor. */
     DefaultFetch(O3CPU *_cpu, DerivO3CPUParams *params);
@@ -397,6 +416,9 @@ class DefaultFetch
     /** The decoder. */
     TheISA::Decoder *decoder[Impl::MaxThreads];
 
+    /** Host-side cache of decoded instructions, bypasses the decoder. */
+    DecodedInstCache decodedInstCache;
+
     RequestPort &getInstPort() { return icachePort; }
 
   private:
@@ -628,10 +650,25 @@ class DefaultFetch
         // MRA Fetch stats
         Stats::Scalar fetchMemFences;
         Stats::Scalar fetchAllFences;
+        /** Fences of the Counter scheme due to stale replay counts. */
+        Stats::Scalar fetchStaleFences;
+        /** Fences of the Counter scheme due to another thread's squashes. */
+        Stats::Scalar fetchCrossThreadFences;
         Stats::Scalar fetchCCHits;
         Stats::Scalar fetchCCMisses;
+
+        /** Instructions taken from / missing in the decoded inst cache. */
+        Stats::Scalar decodedInstCacheHits;
+        Stats::Scalar decodedInstCacheMisses;
         
         Stats::Distribution epochInterval;
+
+        /** Separators of the loop detector, and how they compare to
+         *  the epoch file when there is one. */
+        Stats::Scalar epochDynSeparators;
+        Stats::Scalar epochDynMatches;
+        Stats::Scalar epochDynExtra;
+        Stats::Scalar epochDynMissed;
     } fetchStats;
     
     uint64_t _epochIntervalCnt[Impl::MaxThreads];
@@ -62,6 +62,8 @@
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/fetch.hh"
 #include "cpu/o3/isa_specific.hh"
+#include "cpu/o3/replay_counters.hh"
+#include "cpu/o3/smt_replay_det.hh"
 #include "debug/Activity.hh"
 #include "debug/Drain.hh"
 #include "debug/Fetch.hh"
@@ -130,15 +132,25 @@ DefaultFetch<Impl>::DefaultFetch(O3CPU *_cpu, DerivO3CPUParams *params)
     instSize = sizeof(TheISA::MachInst);
 
     if (GCONFIG.replayDet == utils::COUNTER) {
-        for (int i = 0; i < Impl::MaxThreads; i++) {
+        // SMT threads split the sets of the counter cache, or share a
+        // single one unless smtReplayDetPolicy partitions it.
+        bool shared_cc = SMTReplayDet::sharedCounterCache(numThreads,
+            params->smtReplayDetPolicy);
+        size_t cc_sets = SMTReplayDet::counterCacheSets(
+            bridge::GCONFIG.CCSets, numThreads, params->smtReplayDetPolicy);
+        for (ThreadID i = 0; i < numThreads; i++) {
             utils::CounterCache_p cache_p;
             CounterCaches.push_back(cache_p);
+            if (shared_cc && i > 0) {
+                CounterCaches[i] = CounterCaches[0];
+                continue;
+            }
             cerr << "tid: " << i
                  << "  useCounterCache: " << GCONFIG.CCEnable
                  << endl;
             CCMap.reset(new utils::CounterMap_t);
             counterCacheSetup("CounterCache", CounterCaches[i], CCMap, bridge::GCONFIG.CCAssoc,
-                              bridge::GCONFIG.CCSets, bridge::GCONFIG.CCMissLatency,
+                              cc_sets, bridge::GCONFIG.CCMissLatency,
                               bridge::GCONFIG.CCEnable, bridge::GCONFIG.CCIdeal);
         }
     }
@@ -166,14 +178,35 @@ DefaultFetch<Impl>::DefaultFetch(O3CPU *_cpu, DerivO3CPUParams *params)
     for (ThreadID tid = 0; tid < numThreads; tid++) {
         decoder[tid] = new TheISA::Decoder(
             dynamic_cast<TheISA::ISA *>(params->isa[tid]));
+#if THE_ISA == X86_ISA
+        // The other ISAs decode into one cache for all decoders. The
+        // threads of a core share the decoded instructions, and so the
+        // replay counts in them.
+        if (tid > 0)
+            decoder[tid]->shareInstCache(decoder[0]);
+#endif
         // Create space to buffer the cache line data,
         // which may not hold the entire cache line.
         fetchBuffer[tid] = new uint8_t[fetchBufferSize];
     }
 
+    decodedInstCache.init(params->decodedInstCacheEntries);
+
+    epochInfoLow = MaxAddr;
+    epochInfoHigh = 0;
     if (GCONFIG.replayDet == utils::EPOCH) {
-        bool r = readEpochInfo();
-        if (!r) panic("Failed to open epoch file");
+        // The loop detector needs no file, but compares itself with one
+        // if it is given.
+        if (GCONFIG.epochSource != utils::DYNAMIC_EPOCHS ||
+            !GCONFIG.epochInfoPath.empty()) {
+            bool r = readEpochInfo();
+            if (!r) panic("Failed to open epoch file");
+        }
+        if (GCONFIG.epochSource != utils::STATIC_EPOCHS) {
+            epochDetectors.assign(numThreads,
+                                  EpochDetector(params->epochLoopTableEntries,
+                                                params->epochLoopNest));
+        }
     }
 }
 
@@ -209,6 +242,8 @@ bool DefaultFetch<Impl>::readEpochInfo() {
                     break;
             }
 
+            epochInfoLow = std::min(epochInfoLow, pc);
+            epochInfoHigh = std::max(epochInfoHigh, pc);
             if (!IN_MAP(pc, epochInfo)) {
                 epochInfo[pc] = eScale;
             }
@@ -228,6 +263,75 @@ bool DefaultFetch<Impl>::readEpochInfo() {
     }
 }
 
+template <class Impl>
+utils::EpochScale
+DefaultFetch<Impl>::epochScale(ThreadID tid, const DynInstPtr &inst)
+{
+    const Addr pc = inst->instAddr();
+    auto it = epochInfo.find(pc);
+    utils::EpochScale eScale = it != epochInfo.end() ? it->second
+                                                     : utils::INVALID;
+
+    if (!epochDetectors.empty()) {
+        utils::EpochScale dynScale;
+        switch (epochDetectors[tid].observe(pc)) {
+          case EpochDetector::Iteration:
+            dynScale = utils::ITERATION;
+            break;
+          case EpochDetector::Loop:
+            dynScale = utils::LOOP;
+            break;
+          default:
+            dynScale = utils::INVALID;
+            break;
+        }
+
+        bool dynSep = dynScale >= GCONFIG.epochSize;
+        if (dynSep)
+            ++fetchStats.epochDynSeparators;
+        if (!epochInfo.empty()) {
+            bool staticSep = eScale >= GCONFIG.epochSize;
+            if (dynSep && staticSep)
+                ++fetchStats.epochDynMatches;
+            else if (dynSep)
+                ++fetchStats.epochDynExtra;
+            else if (staticSep)
+                ++fetchStats.epochDynMissed;
+        }
+
+        if (GCONFIG.epochSource == utils::DYNAMIC_EPOCHS ||
+            pc < epochInfoLow || pc > epochInfoHigh) {
+            eScale = dynScale;
+        }
+    }
+
+    // Routine separators are always detected at runtime.
+    if (eScale == utils::INVALID && inst->isCallInst())
+        eScale = utils::ROUTINE;
+    return eScale;
+}
+
+template <class Impl>
+void
+DefaultFetch<Impl>::trainEpochDetector(const DynInstPtr &inst,
+                                       const TheISA::PCState &target)
+{
+    EpochDetector &detector = epochDetectors[inst->threadNumber];
+
+    // On x86, the last micro-op of a macro-op carries its control flags.
+    if (inst->isCall()) {
+        detector.call();
+    } else if (inst->isReturn()) {
+        detector.ret();
+    } else if (inst->isDirectCtrl() && inst->readPredTaken() &&
+               target.instAddr() < inst->instAddr()) {
+        // Taken backward jumps close loops; micro-op branches back into
+        // the same instruction do not.
+        detector.train(inst->instAddr(), target.instAddr());
+    }
+    detector.checkpoint(inst->seqNum);
+}
+
 template <class Impl>
 std::string
 DefaultFetch<Impl>::name() const {
@@ -286,9 +390,25 @@ FetchStatGroup::FetchStatGroup(O3CPU *cpu, DefaultFetch *fetch)
      insts / cpu->numCycles),
     ADD_STAT(fetchMemFences, "Number of fences added on memRefs at Fetch"),
     ADD_STAT(fetchAllFences, "Number of fences added on all instructions at Fetch"),
+    ADD_STAT(fetchStaleFences, "Number of fences due to replay counts older "
+             "than a decay period"),
+    ADD_STAT(fetchCrossThreadFences, "Number of fences due to replay counts "
+             "last raised by a squash of another SMT thread"),
     ADD_STAT(fetchCCHits, "Number of Counter Cache Hits at Fetch"),
     ADD_STAT(fetchCCMisses, "Number of Counter Cache misses at Fetch"),
-    ADD_STAT(epochInterval, "Epoch interval")
+    ADD_STAT(decodedInstCacheHits,
+             "Number of instructions taken from the decoded inst cache"),
+    ADD_STAT(decodedInstCacheMisses,
+             "Number of instructions that missed in the decoded inst cache"),
+    ADD_STAT(epochInterval, "Epoch interval"),
+    ADD_STAT(epochDynSeparators,
+             "Number of epoch separators found by the loop detector"),
+    ADD_STAT(epochDynMatches, "Number of loop detector separators that "
+             "the epoch file also has"),
+    ADD_STAT(epochDynExtra, "Number of loop detector separators that "
+             "the epoch file does not have"),
+    ADD_STAT(epochDynMissed, "Number of epoch file separators that the "
+             "loop detector does not find")
 {
         icacheStallCycles
             .prereq(icacheStallCycles);
@@ -388,6 +508,8 @@ void DefaultFetch<Impl>::clearStates(ThreadID tid) {
     fetchBufferPC[tid] = 0;
     fetchBufferValid[tid] = false;
     fetchQueue[tid].clear();
+    if (!epochDetectors.empty())
+        epochDetectors[tid].reset();
 
     // TODO not sure what to do with priorityList for now
     // priorityList.push_back(tid);
@@ -654,7 +776,7 @@ bool DefaultFetch<Impl>::fetchCacheLine(Addr vaddr, ThreadID tid, Addr pc) {
     // Setup the memReq to do a read of the first instruction's address.
     // Set the appropriate read size and flags as well.
     // Build request here.
-    RequestPtr mem_req = std::make_shared<Request>(
+    RequestPtr mem_req = makeRequest(
         fetchBufferBlockPC, fetchBufferSize,
         Request::INST_FETCH, cpu->instRequestorId(), pc,
         cpu->thread[tid]->contextId());
@@ -835,6 +957,8 @@ void DefaultFetch<Impl>::squashFromDecode(const TheISA::PCState &newPC,
     DPRINTF(Fetch, "[tid:%i] Squashing from decode.\n", tid);
 
     doSquash(newPC, squashInst, tid);
+    if (!epochDetectors.empty())
+        epochDetectors[tid].squash(seq_num);
 
     // Tell the CPU to remove any instructions that are in flight between
     // fetch and decode.
@@ -901,6 +1025,8 @@ void DefaultFetch<Impl>::squash(const TheISA::PCState &newPC,
     DPRINTF(Fetch, "[tid:%i] Squash from commit.\n", tid);
 
     doSquash(newPC, squashInst, tid);
+    if (!epochDetectors.empty())
+        epochDetectors[tid].squash(seq_num);
 
     // Tell the CPU to remove any instructions that are not in the ROB.
     cpu->removeInstsNotInROB(tid);
@@ -1050,6 +1176,10 @@ bool DefaultFetch<Impl>::checkSignalsAndUpdate(ThreadID tid) {
         // Update the branch predictor if it wasn't a squashed instruction
         // that was broadcasted.
         branchPred->update(fromCommit->commitInfo[tid].doneSeqNum, tid);
+        if (!epochDetectors.empty()) {
+            epochDetectors[tid].commit(
+                fromCommit->commitInfo[tid].doneSeqNum);
+        }
     }
 
     // Check squash signals from decode.
@@ -1119,7 +1249,7 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
                               TheISA::PCState nextPC, bool trace) {
     // Get a sequence number.
     InstSeqNum seq = cpu->getAndIncrementInstSeq();
-    GCONFIG.youngestSeqNums[tid] = seq;
+    youngestSeqNums[tid] = seq;
 
     // Create a new DynInst from the instruction fetched.
     DynInstPtr instruction =
@@ -1132,16 +1262,7 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
 
     if (GCONFIG.replayDet == utils::EPOCH) {
         if (instruction->isFirstMicroop()) {
-            utils::EpochScale eScale;
-            if (IN_MAP(instruction->instAddr(), epochInfo)) {
-                eScale = epochInfo.at(instruction->instAddr());
-            }
-            else if (instruction->isCallInst()) {
-                eScale = utils::ROUTINE;
-            }
-            else {
-                eScale = utils::INVALID;
-            }
+            utils::EpochScale eScale = epochScale(tid, instruction);
 
             if (eScale >= GCONFIG.epochSize) {
                 // a new epoch
@@ -1162,6 +1283,8 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
     // check MRA defenses are enabled
     if ((GCONFIG.isSpectre || GCONFIG.isFuturistic) && GCONFIG.replayDet != utils::NO_DETECT) {
         bool requireFence = false;
+        bool staleCount = false;
+        bool crossThreadCount = false;
         switch (GCONFIG.replayDet) {
             case utils::NO_DETECT:
                 break;
@@ -1169,6 +1292,8 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
             case utils::EPOCH:
                 if (cpu->squashBuffer(tid)->check(instruction)) {
                     requireFence = true;
+                    instruction->fenceRecord =
+                        cpu->squashBuffer(tid)->hitRecord();
                 }
                 break;
             case utils::COUNTER:
@@ -1192,12 +1317,18 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
                 // Bit and counter checks
                 if (staticInst->isReplayed() || instruction->needFetchCC) {
                     requireFence = true;
+                    staleCount = staticInst->isReplayed() &&
+                                 cpu->isStaleReplay(staticInst);
+                    crossThreadCount = ReplayCounters<StaticInstPtr>::
+                        isCrossThread(staticInst, tid);
                 }
                 break;
         }
 
         if (requireFence) {
-            if (GCONFIG.hw == utils::FENCE && instruction->isLoad()) {
+            if ((GCONFIG.hw == utils::FENCE ||
+                 GCONFIG.hw == utils::DELAY_ON_MISS) &&
+                instruction->isLoad()) {
                 instruction->setFenced();
                 ++fetchStats.fetchMemFences;
                 ++fetchStats.fetchAllFences;
@@ -1206,6 +1337,10 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
                 ++fetchStats.fetchAllFences;
                 if (instruction->isLoad()) ++fetchStats.fetchMemFences;
             }
+            if (staleCount && instruction->isFenced())
+                ++fetchStats.fetchStaleFences;
+            if (crossThreadCount && instruction->isFenced())
+                ++fetchStats.fetchCrossThreadFences;
         }
     }
 
@@ -1355,6 +1490,14 @@ void DefaultFetch<Impl>::fetch(bool &status_change) {
     const unsigned numInsts = fetchBufferSize / instSize;
     unsigned blkOffset = (fetchAddr - fetchBufferPC[tid]) / instSize;
 
+    // Decoded inst cache state: a hit that is waiting to be consumed, and
+    // the chunks fed to the decoder for the instruction being decoded
+    // (only if it started in this fetch buffer during this cycle).
+    const DecodedInstCache::Entry *cachedInst = nullptr;
+    TheISA::PCState decodeStartPC = thisPC;
+    unsigned decodeStartBlk = numInsts;
+    unsigned decodeChunks = 0;
+
     // Loop through instruction memory from the cache.
     // Keep issuing while fetchWidth is available and branch is not
     // predicted taken
@@ -1380,12 +1523,31 @@ void DefaultFetch<Impl>::fetch(bool &status_change) {
                 break;
             }
 
-            decoder[tid]->moreBytes(thisPC, fetchAddr, cacheInsts[blkOffset]);
+            if (decodedInstCache.enabled() && pcOffset == 0) {
+                // Start of a new instruction: try to skip the decoder.
+                cachedInst = decodedInstCache.lookup(
+                    thisPC, DecodedInstCache::decoderContext(decoder[tid]),
+                    &cacheInsts[blkOffset], numInsts - blkOffset);
+                if (cachedInst) {
+                    ++fetchStats.decodedInstCacheHits;
+                } else {
+                    ++fetchStats.decodedInstCacheMisses;
+                    decodeStartPC = thisPC;
+                    decodeStartBlk = blkOffset;
+                    decodeChunks = 0;
+                }
+            }
+
+            if (!cachedInst) {
+                decoder[tid]->moreBytes(thisPC, fetchAddr,
+                                        cacheInsts[blkOffset]);
+                ++decodeChunks;
 
-            if (decoder[tid]->needMoreBytes()) {
-                blkOffset++;
-                fetchAddr += instSize;
-                pcOffset += instSize;
+                if (decoder[tid]->needMoreBytes()) {
+                    blkOffset++;
+                    fetchAddr += instSize;
+                    pcOffset += instSize;
+                }
             }
         }
 
@@ -1393,9 +1555,31 @@ void DefaultFetch<Impl>::fetch(bool &status_change) {
         // the memory we've processed so far.
         do {
             if (!(curMacroop || inRom)) {
-                if (decoder[tid]->instReady()) {
+                if (cachedInst) {
+                    staticInst = cachedInst->inst;
+                    thisPC = cachedInst->decodedPC;
+                    cachedInst = nullptr;
+
+                    ++fetchStats.insts;
+
+                    if (staticInst->isMacroop()) {
+                        curMacroop = staticInst;
+                    } else {
+                        pcOffset = 0;
+                    }
+                } else if (decoder[tid]->instReady()) {
                     staticInst = decoder[tid]->decode(thisPC);
 
+                    if (decodedInstCache.enabled() &&
+                        decodeStartBlk < numInsts) {
+                        decodedInstCache.insert(
+                            decodeStartPC, thisPC,
+                            DecodedInstCache::decoderContext(decoder[tid]),
+                            staticInst, &cacheInsts[decodeStartBlk],
+                            decodeChunks);
+                        decodeStartBlk = numInsts;
+                    }
+
                     // Increment stat of fetched instructions.
                     ++fetchStats.insts;
 
@@ -1444,6 +1628,8 @@ void DefaultFetch<Impl>::fetch(bool &status_change) {
             predictedBranch |= thisPC.branching();
             predictedBranch |=
                 lookupAndUpdateNextPC(instruction, nextPC);
+            if (!epochDetectors.empty())
+                trainEpochDetector(instruction, nextPC);
             if (predictedBranch) {
                 DPRINTF(Fetch, "Branch detected with PC = %s\n", thisPC);
             }
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/o3/hybrid_squash_record.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "base/logging.hh"
+
+HybridSquashRecord::HybridSquashRecord(size_t cam_entries, size_t hashes,
+                                       size_t cells, size_t counter_bits,
+                                       bool counting)
+    : camEntries(cam_entries), maxCount((size_t(1) << counter_bits) - 1),
+      counting(counting),
+      filter(bf::make_hasher(hashes, 0x5bd1e995, false), cells,
+             counting ? counter_bits : 1, false)
+{
+    fatal_if(!counter_bits, "Squash buffer counters need at least one bit");
+    cam.reserve(cam_entries);
+}
+
+size_t
+HybridSquashRecord::filterCells(size_t budget_bits, size_t cam_entries,
+                                size_t counter_bits, bool counting,
+                                size_t cell_bits)
+{
+    const size_t cam_bits =
+        cam_entries * (sizeof(Addr) * 8 + (counting ? counter_bits : 0));
+    warn_if(cam_bits >= budget_bits, "The %d-entry CAM of a Hybrid squash "
+            "buffer needs %d bits, more than the %d bits of the filter it "
+            "replaces", cam_entries, cam_bits, budget_bits);
+    if (cam_bits >= budget_bits)
+        return 1;
+    return std::max<size_t>(1, (budget_bits - cam_bits) / cell_bits);
+}
+
+size_t
+HybridSquashRecord::filterHashes(size_t cells, size_t elems)
+{
+    const double k = std::log(2.0) * cells / std::max<size_t>(1, elems);
+    return std::max<size_t>(1, std::lround(k));
+}
+
+std::vector<HybridSquashRecord::Entry>::iterator
+HybridSquashRecord::find(Addr pc)
+{
+    return std::find_if(cam.begin(), cam.end(),
+                        [pc](const Entry &e) { return e.pc == pc; });
+}
+
+std::vector<HybridSquashRecord::Entry>::const_iterator
+HybridSquashRecord::find(Addr pc) const
+{
+    return std::find_if(cam.begin(), cam.end(),
+                        [pc](const Entry &e) { return e.pc == pc; });
+}
+
+bool
+HybridSquashRecord::contains(Addr pc) const
+{
+    if (find(pc) != cam.end())
+        return true;
+    return filterElems > 0 && filter.lookup(pc) > 0;
+}
+
+bool
+HybridSquashRecord::insert(Addr pc)
+{
+    auto it = find(pc);
+    if (it != cam.end()) {
+        if (counting && it->count < maxCount)
+            it->count++;
+        return true;
+    }
+
+    if (cam.size() < camEntries) {
+        cam.push_back({pc, 1});
+        return true;
+    }
+
+    filter.add(pc);
+    filterElems++;
+    return false;
+}
+
+void
+HybridSquashRecord::remove(Addr pc)
+{
+    assert(counting);
+
+    auto it = find(pc);
+    if (it != cam.end()) {
+        // A saturated counter has lost track of the instances.
+        if (it->count == maxCount)
+            return;
+        if (--it->count == 0) {
+            *it = cam.back();
+            cam.pop_back();
+        }
+        return;
+    }
+
+    if (filterElems > 0 && filter.lookup(pc) > 0) {
+        filter.remove(pc);
+        filterElems--;
+    }
+}
+
+void
+HybridSquashRecord::clear()
+{
+    cam.clear();
+    filter.clear();
+    filterElems = 0;
+}
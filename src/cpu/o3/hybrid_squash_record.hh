@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_HYBRID_SQUASH_RECORD_HH__
+#define __CPU_O3_HYBRID_SQUASH_RECORD_HH__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/o3/counting.hh"
+
+/**
+ * Squash buffer record of the Hybrid structure: a small, exact, fully
+ * associative buffer of PCs, the CAM, whose overflow spills into a
+ * Bloom filter. PCs go to the CAM while it has free entries and to the
+ * filter after that, so lookups can only return false positives once
+ * the CAM has overflowed.
+ *
+ * A counting record keeps a counter per CAM entry and a counting filter,
+ * so that retirement can remove the instances of a PC again. A CAM
+ * entry whose counter saturates is pinned until the record is cleared.
+ */
+class HybridSquashRecord
+{
+  public:
+    /**
+     * @param cam_entries Entries of the CAM.
+     * @param hashes Hash functions of the filter.
+     * @param cells Cells of the filter.
+     * @param counter_bits Width of the counters of a counting record.
+     * @param counting Whether PCs can be removed.
+     */
+    HybridSquashRecord(size_t cam_entries, size_t hashes, size_t cells,
+                       size_t counter_bits, bool counting);
+
+    /**
+     * Cells of a filter that keeps the record within the storage of
+     * the pure filter it replaces. The CAM takes a 64-bit PC per entry,
+     * plus a counter in a counting record, and the filter gets the
+     * remaining bits.
+     *
+     * @param budget_bits Bits of the pure filter.
+     * @param cell_bits Bits of a cell of the filter.
+     * @return Number of cells, at least one.
+     */
+    static size_t filterCells(size_t budget_bits, size_t cam_entries,
+                              size_t counter_bits, bool counting,
+                              size_t cell_bits);
+
+    /** Optimal number of hashes for elems elements in cells cells. */
+    static size_t filterHashes(size_t cells, size_t elems);
+
+    bool contains(Addr pc) const;
+
+    /**
+     * Record an instance of pc.
+     * @return False if it spilled into the filter.
+     */
+    bool insert(Addr pc);
+
+    /** Remove an instance of pc from a counting record. */
+    void remove(Addr pc);
+
+    void clear();
+
+    /** PCs held exactly. */
+    size_t camSize() const { return cam.size(); }
+
+    /** Instances of PCs held by the filter. */
+    size_t spilled() const { return filterElems; }
+
+  private:
+    struct Entry
+    {
+        Addr pc;
+        size_t count;
+    };
+
+    std::vector<Entry>::iterator find(Addr pc);
+    std::vector<Entry>::const_iterator find(Addr pc) const;
+
+    std::vector<Entry> cam;
+    size_t camEntries;
+    size_t maxCount;
+    bool counting;
+
+    bf::counting_bloom_filter filter;
+    size_t filterElems = 0;
+};
+
+#endif // __CPU_O3_HYBRID_SQUASH_RECORD_HH__
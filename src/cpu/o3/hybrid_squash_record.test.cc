@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "cpu/o3/hybrid_squash_record.hh"
+
+/** PCs that fit in the CAM are held exactly. */
+TEST(HybridSquashRecordTest, Exact)
+{
+    HybridSquashRecord r(4, 3, 64, 1, false);
+    for (Addr pc = 0x1000; pc < 0x1010; pc += 4)
+        ASSERT_TRUE(r.insert(pc));
+    ASSERT_TRUE(r.insert(0x1000));
+    ASSERT_EQ(r.camSize(), 4u);
+    ASSERT_EQ(r.spilled(), 0u);
+
+    for (Addr pc = 0x1000; pc < 0x1010; pc += 4)
+        ASSERT_TRUE(r.contains(pc));
+    // Without spills, nothing else is found, whatever the filter says.
+    for (Addr pc = 0x2000; pc < 0x3000; pc += 4)
+        ASSERT_FALSE(r.contains(pc));
+}
+
+/** The overflow of the CAM goes to the filter, and clear() empties both. */
+TEST(HybridSquashRecordTest, Spill)
+{
+    HybridSquashRecord r(2, 3, 1024, 1, false);
+    ASSERT_TRUE(r.insert(0x1000));
+    ASSERT_TRUE(r.insert(0x1004));
+    ASSERT_FALSE(r.insert(0x1008));
+    ASSERT_FALSE(r.insert(0x100c));
+    ASSERT_EQ(r.spilled(), 2u);
+
+    for (Addr pc = 0x1000; pc < 0x1010; pc += 4)
+        ASSERT_TRUE(r.contains(pc));
+
+    r.clear();
+    ASSERT_EQ(r.camSize(), 0u);
+    ASSERT_EQ(r.spilled(), 0u);
+    for (Addr pc = 0x1000; pc < 0x1010; pc += 4)
+        ASSERT_FALSE(r.contains(pc));
+}
+
+/** Counting records remove the instances of a PC one by one. */
+TEST(HybridSquashRecordTest, Counting)
+{
+    HybridSquashRecord r(1, 3, 1024, 4, true);
+    r.insert(0x1000);
+    r.insert(0x1000);
+    ASSERT_FALSE(r.insert(0x2000));
+
+    r.remove(0x1000);
+    ASSERT_TRUE(r.contains(0x1000));
+    r.remove(0x1000);
+    ASSERT_FALSE(r.contains(0x1000));
+    ASSERT_EQ(r.camSize(), 0u);
+
+    // The freed entry takes the next PC; the spilled one is still found.
+    ASSERT_TRUE(r.insert(0x3000));
+    ASSERT_TRUE(r.contains(0x2000));
+    r.remove(0x2000);
+    ASSERT_EQ(r.spilled(), 0u);
+    ASSERT_FALSE(r.contains(0x2000));
+}
+
+/** A saturated CAM counter pins its entry. */
+TEST(HybridSquashRecordTest, Saturation)
+{
+    HybridSquashRecord r(4, 3, 64, 2, true);
+    for (int i = 0; i < 5; i++)
+        r.insert(0x1000);
+    for (int i = 0; i < 5; i++)
+        r.remove(0x1000);
+    ASSERT_TRUE(r.contains(0x1000));
+    r.clear();
+    ASSERT_FALSE(r.contains(0x1000));
+}
+
+/** The filter gets the bits of the pure filter the CAM leaves. */
+TEST(HybridSquashRecordTest, Budget)
+{
+    // 32 PCs of 64 bits and 4-bit counters out of 10000 bits leave
+    // 7824 bits, 1956 4-bit counters.
+    ASSERT_EQ(HybridSquashRecord::filterCells(10000, 32, 4, true, 4), 1956u);
+    // Without counters the CAM takes 2048 bits.
+    ASSERT_EQ(HybridSquashRecord::filterCells(10000, 32, 4, false, 1), 7952u);
+    // A CAM larger than the budget leaves a single cell.
+    ASSERT_EQ(HybridSquashRecord::filterCells(1000, 32, 4, false, 1), 1u);
+
+    ASSERT_EQ(HybridSquashRecord::filterHashes(7952, 1000), 6u);
+    ASSERT_EQ(HybridSquashRecord::filterHashes(1, 1000), 1u);
+    ASSERT_EQ(HybridSquashRecord::filterHashes(64, 0), 44u);
+}
@@ -186,6 +186,9 @@ class DefaultIEW
     /** Re-executes all rescheduled memory instructions. */
     void replayMemInst(const DynInstPtr &inst);
 
+    /** Fences a load again that the L1 refused, it re-executes at VP. */
+    void refenceMemInst(const DynInstPtr &inst);
+
     /** Moves memory instruction onto the list of cache blocked instructions */
     void blockMemInst(const DynInstPtr &inst);
 
@@ -607,6 +607,13 @@ DefaultIEW<Impl>::replayMemInst(const DynInstPtr& inst)
     instQueue.replayMemInst(inst);
 }
 
+template<class Impl>
+void
+DefaultIEW<Impl>::refenceMemInst(const DynInstPtr& inst)
+{
+    instQueue.refenceMemInst(inst);
+}
+
 template<class Impl>
 void
 DefaultIEW<Impl>::blockMemInst(const DynInstPtr& inst)
@@ -1252,11 +1259,14 @@ DefaultIEW<Impl>::executeInsts()
             break;
         }
 
-        // Here we check if an instruction needs to be fenced
+        // Here we check if an instruction needs to be fenced. Under
+        // DelayOnMiss, fenced loads go ahead and the LSQ fences only the
+        // ones that miss in the L1.
         if (inst->isFenced() && !inst->isReachedVP() &&
             inst->isSpeculative() && inst->isMemRef() &&
             (GCONFIG.isSpectre || GCONFIG.isFuturistic) &&
-            !inst->isSquashed() && !inst->isProtectionLifted()) {
+            !inst->isSquashed() && !inst->isProtectionLifted() &&
+            GCONFIG.hw != utils::DELAY_ON_MISS) {
             instQueue.fenceMemInst(inst);
             continue;
         }
@@ -1333,6 +1343,17 @@ DefaultIEW<Impl>::executeInsts()
                     continue;
                 }
 
+                if (inst->isDelayedOnMiss()) {
+                    // The fenced load missed in the L1; it waits for VP
+                    // like under Fence.
+                    DPRINTF(IEW, "Execute: Fenced load missed in the L1, "
+                            "fencing it.\n");
+                    inst->resetDelayedOnMiss();
+                    instQueue.fenceMemInst(inst);
+                    inst->resetExecutionStarted();
+                    continue;
+                }
+
                 if (inst->isDataPrefetch() || inst->isInstPrefetch()) {
                     inst->fault = NoFault;
                 }
@@ -94,7 +94,7 @@ class InstructionQueue
     typedef typename std::list<DynInstPtr>::iterator ListIt;
 
     /** FU completion event class. */
-    class FUCompletion : public Event {
+    class FUCompletion : public PooledEvent {
       private:
         /** Executing instruction. */
         DynInstPtr inst;
@@ -253,6 +253,9 @@ class InstructionQueue
     /** Fences a speculative instruction*/
     void fenceMemInst(const DynInstPtr &fenced_inst);
 
+    /** Fences a memory instruction again whose access the L1 refused. */
+    void refenceMemInst(const DynInstPtr &fenced_inst);
+
     /**  Defers a memory instruction when it is cache blocked. */
     void blockMemInst(const DynInstPtr &blocked_inst);
 
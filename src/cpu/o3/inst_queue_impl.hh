@@ -62,7 +62,7 @@ using bridge::GCONFIG;
 template <class Impl>
 InstructionQueue<Impl>::FUCompletion::FUCompletion(const DynInstPtr &_inst,
     int fu_idx, InstructionQueue<Impl> *iq_ptr)
-    : Event(Stat_Event_Pri, AutoDelete),
+    : PooledEvent(Stat_Event_Pri),
       inst(_inst), fuIdx(fu_idx), iqPtr(iq_ptr), freeFU(false)
 {
 }
@@ -795,7 +795,8 @@ InstructionQueue<Impl>::scheduleReadyInsts()
         addReadyMemInst(mem_inst);
     }
 
-    if (GCONFIG.hw == utils::FENCE || GCONFIG.hw == utils::FENCE_ALL) {
+    if (GCONFIG.hw == utils::FENCE || GCONFIG.hw == utils::FENCE_ALL ||
+        GCONFIG.hw == utils::DELAY_ON_MISS) {
         getFencedMemInstToExecute();
     }
 
@@ -1160,6 +1161,22 @@ InstructionQueue<Impl>::fenceMemInst(const DynInstPtr &fenced_inst) {
     fencedMemInsts.push_back(fenced_inst);
 }
 
+template <class Impl>
+void
+InstructionQueue<Impl>::refenceMemInst(const DynInstPtr &fenced_inst)
+{
+    DPRINTF(IQ, "Refencing mem inst [sn:%llu]\n", fenced_inst->seqNum);
+
+    // Reset DTB translation state
+    fenced_inst->translationStarted(false);
+    fenced_inst->translationCompleted(false);
+
+    // The instruction may have reached VP while its access was in
+    // flight, getFencedMemInstToExecute() then issues it right away.
+    DSTATE(MemInstFenced, fenced_inst);
+    fencedMemInsts.push_back(fenced_inst);
+}
+
 template <class Impl>
 void
 InstructionQueue<Impl>::blockMemInst(const DynInstPtr &blocked_inst)
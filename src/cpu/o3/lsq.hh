@@ -46,6 +46,7 @@
 #include <queue>
 
 #include "arch/generic/tlb.hh"
+#include "base/pool_alloc.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/lsq_unit.hh"
 #include "cpu/utils.hh"
@@ -408,7 +409,7 @@ class LSQ
         {
             if (byte_enable.empty() ||
                 isAnyActiveElement(byte_enable.begin(), byte_enable.end())) {
-                auto request = std::make_shared<Request>(
+                auto request = makeRequest(
                         addr, size, _flags, _inst->requestorId(),
                         _inst->instAddr(), _inst->contextId(),
                         std::move(_amo_op));
@@ -434,6 +435,19 @@ class LSQ
                 delete r;
         };
 
+        /** One or more LSQRequests are created per memory instruction,
+         * so they are recycled through the PoolAlloc pools. */
+        static void *
+        operator new(size_t size)
+        {
+            return PoolAlloc::allocate(size);
+        }
+
+        static void
+        operator delete(void *p, size_t size)
+        {
+            PoolAlloc::deallocate(p, size);
+        }
 
       public:
         /** Convenience getters/setters. */
@@ -1084,6 +1098,13 @@ class LSQ
      */
     Fault write(LSQRequest* req, uint8_t *data, int store_idx);
 
+    /**
+     * Apply the L1 replacement update that a load which hit under
+     * DelayOnMiss skipped, once the load has reached its visibility
+     * point.
+     */
+    void touchDeferred(const DynInstPtr &inst);
+
     /**
      * Retry the previous send that failed.
      */
@@ -1203,4 +1224,11 @@ LSQ<Impl>::write(LSQRequest* req, uint8_t *data, int store_idx)
     return thread.at(tid).write(req, data, store_idx);
 }
 
+template <class Impl>
+void
+LSQ<Impl>::touchDeferred(const DynInstPtr &inst)
+{
+    thread.at(inst->threadNumber).touchDeferred(inst);
+}
+
 #endif // __CPU_O3_LSQ_HH__
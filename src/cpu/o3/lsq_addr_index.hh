@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Address-indexed view of a load or store queue, used to prune the
+ * store-to-load forwarding and memory order violation searches.
+ */
+
+#ifndef __CPU_O3_LSQ_ADDR_INDEX_HH__
+#define __CPU_O3_LSQ_ADDR_INDEX_HH__
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Maps address blocks to the queue entries whose accesses touch them.
+ * An access covers the bytes from addr to addr + size - 1 inclusive; a
+ * zero-sized access covers addr - 1 and addr, matching the inclusive
+ * block ranges the LSQ compares. find() returns a superset of the
+ * entries that overlap an access, which the caller filters with the
+ * exact checks of the linear search. Accesses spanning more than
+ * MaxBlocks blocks are kept apart and returned by every find().
+ */
+class LSQAddrIndex
+{
+  public:
+    static constexpr Addr MaxBlocks = 8;
+
+    /**
+     * @param entries Capacity of the queue.
+     * @param block_shift Log2 of the block size.
+     */
+    void
+    init(size_t entries, unsigned block_shift)
+    {
+        blockShift = block_shift;
+        entryBlocks.assign(entries, Blocks());
+        table.clear();
+        wide.clear();
+    }
+
+    void
+    clear()
+    {
+        std::fill(entryBlocks.begin(), entryBlocks.end(), Blocks());
+        table.clear();
+        wide.clear();
+    }
+
+    /** Indexes entry idx under the access, replacing its old one. */
+    void
+    insert(int idx, Addr addr, unsigned size)
+    {
+        remove(idx);
+
+        Blocks &b = entryBlocks[idx];
+        blocks(addr, size, b.first, b.last);
+        b.indexed = true;
+        if (b.last - b.first >= MaxBlocks) {
+            wide.push_back(idx);
+            return;
+        }
+        for (Addr blk = b.first; blk <= b.last; blk++)
+            table[blk].push_back(idx);
+    }
+
+    void
+    remove(int idx)
+    {
+        Blocks &b = entryBlocks[idx];
+        if (!b.indexed)
+            return;
+        b.indexed = false;
+
+        if (b.last - b.first >= MaxBlocks) {
+            erase(wide, idx);
+            return;
+        }
+        for (Addr blk = b.first; blk <= b.last; blk++) {
+            auto it = table.find(blk);
+            erase(it->second, idx);
+            if (it->second.empty())
+                table.erase(it);
+        }
+    }
+
+    /**
+     * Appends the entries that may overlap the access to idxs, possibly
+     * more than once. Returns false, leaving idxs alone, if the access
+     * is too wide to look up.
+     */
+    bool
+    find(Addr addr, unsigned size, std::vector<int> &idxs) const
+    {
+        Addr first, last;
+        blocks(addr, size, first, last);
+        if (last - first >= MaxBlocks)
+            return false;
+
+        idxs.insert(idxs.end(), wide.begin(), wide.end());
+        for (Addr blk = first; blk <= last; blk++) {
+            auto it = table.find(blk);
+            if (it != table.end())
+                idxs.insert(idxs.end(), it->second.begin(), it->second.end());
+        }
+        return true;
+    }
+
+  private:
+    /** Inclusive range of blocks an entry is indexed under. */
+    struct Blocks
+    {
+        bool indexed = false;
+        Addr first = 0;
+        Addr last = 0;
+    };
+
+    void
+    blocks(Addr addr, unsigned size, Addr &first, Addr &last) const
+    {
+        Addr end = addr + size - 1;
+        first = std::min(addr, end) >> blockShift;
+        last = std::max(addr, end) >> blockShift;
+    }
+
+    static void
+    erase(std::vector<int> &v, int idx)
+    {
+        auto it = std::find(v.begin(), v.end(), idx);
+        *it = v.back();
+        v.pop_back();
+    }
+
+    unsigned blockShift = 0;
+    std::vector<Blocks> entryBlocks;
+    std::unordered_map<Addr, std::vector<int>> table;
+    std::vector<int> wide;
+};
+
+#endif // __CPU_O3_LSQ_ADDR_INDEX_HH__
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "cpu/o3/lsq_addr_index.hh"
+
+namespace {
+
+/** The overlap test of LSQUnit::checkViolations(). */
+bool
+overlaps(Addr a, unsigned a_size, Addr b, unsigned b_size, unsigned shift)
+{
+    Addr a1 = a >> shift;
+    Addr a2 = (a + a_size - 1) >> shift;
+    Addr b1 = b >> shift;
+    Addr b2 = (b + b_size - 1) >> shift;
+    return a2 >= b1 && a1 <= b2;
+}
+
+bool
+found(const std::vector<int> &idxs, int idx)
+{
+    return std::find(idxs.begin(), idxs.end(), idx) != idxs.end();
+}
+
+} // anonymous namespace
+
+/** Entries are found under every block they touch, until removed. */
+TEST(LSQAddrIndexTest, InsertRemove)
+{
+    LSQAddrIndex index;
+    index.init(4, 6);
+    index.insert(0, 0x1000, 8);
+    index.insert(1, 0x103c, 8);
+    index.insert(2, 0x2000, 4);
+
+    std::vector<int> idxs;
+    ASSERT_TRUE(index.find(0x1040, 4, idxs));
+    ASSERT_EQ(idxs, std::vector<int>({1}));
+
+    idxs.clear();
+    ASSERT_TRUE(index.find(0x1000, 1, idxs));
+    ASSERT_TRUE(found(idxs, 0));
+    ASSERT_TRUE(found(idxs, 1));
+    ASSERT_FALSE(found(idxs, 2));
+
+    // Reinserting moves the entry
+    index.insert(1, 0x2010, 8);
+    index.remove(0);
+    idxs.clear();
+    ASSERT_TRUE(index.find(0x1000, 0x80, idxs));
+    ASSERT_TRUE(idxs.empty());
+
+    index.clear();
+    idxs.clear();
+    ASSERT_TRUE(index.find(0x2000, 0x40, idxs));
+    ASSERT_TRUE(idxs.empty());
+}
+
+/** Accesses too wide to index are returned by every lookup. */
+TEST(LSQAddrIndexTest, Wide)
+{
+    LSQAddrIndex index;
+    index.init(2, 6);
+    // An empty access at 0 wraps around the address space
+    index.insert(0, 0, 0);
+    index.insert(1, 0x5000, 4);
+
+    std::vector<int> idxs;
+    ASSERT_TRUE(index.find(0x9000, 4, idxs));
+    ASSERT_EQ(idxs, std::vector<int>({0}));
+    ASSERT_FALSE(index.find(0x1000, 0x1000, idxs));
+
+    index.remove(0);
+    idxs.clear();
+    ASSERT_TRUE(index.find(0x9000, 4, idxs));
+    ASSERT_TRUE(idxs.empty());
+}
+
+/**
+ * Indexed in blocks coarser than the dependence check, every entry the
+ * LQ walk would check, empty accesses included, is found.
+ */
+TEST(LSQAddrIndexTest, Superset)
+{
+    const unsigned dep_shift = 4;
+    const int entries = 32;
+    LSQAddrIndex index;
+    index.init(entries, 6);
+
+    std::mt19937 rng(1);
+    std::vector<Addr> addr(entries);
+    std::vector<unsigned> size(entries);
+    for (int i = 0; i < entries; i++) {
+        addr[i] = 0x10000 + rng() % 0x400;
+        size[i] = rng() % 17;
+        index.insert(i, addr[i], size[i]);
+    }
+
+    for (int q = 0; q < 2000; q++) {
+        Addr q_addr = 0x10000 + rng() % 0x400;
+        unsigned q_size = rng() % 17;
+        std::vector<int> idxs;
+        ASSERT_TRUE(index.find(q_addr, q_size, idxs));
+        for (int i = 0; i < entries; i++) {
+            if (overlaps(q_addr, q_size, addr[i], size[i], dep_shift)) {
+                ASSERT_TRUE(found(idxs, i))
+                    << "query " << q << " entry " << i;
+            }
+        }
+    }
+}
@@ -47,12 +47,14 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "arch/generic/debugfaults.hh"
 #include "arch/generic/vec_reg.hh"
 #include "arch/locked_mem.hh"
 #include "config/the_isa.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/o3/lsq_addr_index.hh"
 #include "cpu/timebuf.hh"
 #include "debug/HtmCpu.hh"
 #include "debug/LSQUnit.hh"
@@ -263,6 +265,43 @@ class LSQUnit
     Fault checkViolations(typename LoadQueue::iterator& loadIt,
             const DynInstPtr& inst);
 
+  private:
+    /** True if checkViolations() compares the load ld_inst with inst. */
+    bool violationCandidate(const DynInstPtr& inst,
+            const DynInstPtr& ld_inst) const;
+
+    /** Fills idxs with the LQ entries checkViolations() compares with
+     * inst, oldest first, either walking from loadIt or looking the
+     * address of inst up in lqAddrIndex.
+     */
+    void findViolationCandidates(typename LoadQueue::iterator loadIt,
+            const DynInstPtr& inst, bool indexed, std::vector<int> &idxs);
+
+    /** Checks a candidate load for an ordering violation with inst.
+     * @param done set if checkViolations() must return the result
+     */
+    Fault checkViolation(const DynInstPtr& inst, const DynInstPtr& ld_inst,
+            bool &done);
+
+    /** How much of the data of req an older store can forward. */
+    AddrRangeCoverage forwardCoverage(typename StoreQueue::iterator store_it,
+            LSQRequest *req) const;
+
+    /** Finds the youngest store older than load_inst that overlaps req,
+     * either walking back from its sqIt or looking req up in
+     * sqAddrIndex. Returns storeQueue.end() if there is none.
+     * @param coverage set to the coverage of req by that store
+     */
+    typename StoreQueue::iterator searchStores(const DynInstPtr &load_inst,
+            LSQRequest *req, bool indexed, AddrRangeCoverage &coverage);
+
+    /** searchStores() as configured, checking the index if asked to. */
+    typename StoreQueue::iterator findForwardingStore(
+            const DynInstPtr &load_inst, LSQRequest *req,
+            AddrRangeCoverage &coverage);
+
+  public:
+
     /** Check if an incoming invalidate hits in the lsq on a load
      * that might have issued out of order wrt another load beacuse
      * of the intermediate invalidate.
@@ -454,7 +493,7 @@ class LSQUnit
     };
 
     /** Writeback event, specifically for when stores forward data to loads. */
-    class WritebackEvent : public Event
+    class WritebackEvent : public PooledEvent
     {
       public:
         /** Constructs a writeback event. */
@@ -528,6 +567,24 @@ class LSQUnit
     /** Address Mask for a cache block (e.g. ~(cache_block_size-1)) */
     Addr cacheBlockMask;
 
+    /** Prune the forwarding and violation searches with the address
+     * indices below.
+     */
+    bool useAddrIndex;
+
+    /** Also run the linear searches and panic if the results differ. */
+    bool checkAddrIndex;
+
+    /** Cache blocks accessed by the loads in the LQ. */
+    LSQAddrIndex lqAddrIndex;
+
+    /** Cache blocks accessed by the stores in the SQ. */
+    LSQAddrIndex sqAddrIndex;
+
+    /** Scratch lists of the entries found by the searches. */
+    std::vector<int> addrIndexHits;
+    std::vector<int> linearHits;
+
     /** Wire to read information from the issue stage time queue. */
     typename TimeBuffer<IssueStruct>::wire fromIssue;
 
@@ -594,6 +651,18 @@ class LSQUnit
         // stats for MRA
         Stats::Scalar lqSquashSet;
         Stats::Scalar sqSquashSet;
+
+        /** Fenced loads that hit in the L1 under DelayOnMiss. */
+        Stats::Scalar delayOnMissHits;
+
+        /** Fenced loads delayed to VP by an L1 miss under DelayOnMiss. */
+        Stats::Scalar delayOnMissDelays;
+
+        /** Fenced loads that hit in the probe but missed at the L1. */
+        Stats::Scalar delayOnMissNacks;
+
+        /** Replacement updates of fenced loads applied at VP. */
+        Stats::Scalar delayOnMissTouches;
     } stats;
 
 
@@ -604,6 +673,19 @@ class LSQUnit
     /** Executes the store at the given index. */
     Fault write(LSQRequest *req, uint8_t *data, int store_idx);
 
+    /**
+     * Under DelayOnMiss, probe the L1 for a fenced speculative load
+     * without changing its state. On a hit the load proceeds, marked so
+     * that the cache defers its replacement update; on a miss it is
+     * marked DelayedOnMiss and has to wait for its visibility point.
+     *
+     * @return If the load must not access memory yet.
+     */
+    bool delayOnMiss(const DynInstPtr &inst, LSQRequest *req);
+
+    /** Apply the replacement update deferred by delayOnMiss(). */
+    void touchDeferred(const DynInstPtr &inst);
+
     /** Returns the index of the head load instruction. */
     int getLoadHead() { return loadQueue.head(); }
 
@@ -646,6 +728,10 @@ LSQUnit<Impl>::read(LSQRequest *req, int load_idx)
     load_req.setRequest(req);
     assert(load_inst);
 
+    // The LSQ sets effAddr just before calling read()
+    if (useAddrIndex)
+        lqAddrIndex.insert(load_idx, load_inst->effAddr, load_inst->effSize);
+
     assert(!load_inst->isExecuted());
 
     // Make sure this isn't a strictly ordered load
@@ -737,185 +823,127 @@ LSQUnit<Impl>::read(LSQRequest *req, int load_idx)
     }
 
     // Check the SQ for any previous stores that might lead to forwarding
-    auto store_it = load_inst->sqIt;
-    assert (store_it >= storeWBIt);
-    // End once we've reached the top of the LSQ
-    while (store_it != storeWBIt) {
-        // Move the index to one younger
-        store_it--;
-        assert(store_it->valid());
-        assert(store_it->instruction()->seqNum < load_inst->seqNum);
-        int store_size = store_it->size();
-
-        // Cache maintenance instructions go down via the store
-        // path but they carry no data and they shouldn't be
-        // considered for forwarding
-        if (store_size != 0 && !store_it->instruction()->strictlyOrdered() &&
-            !(store_it->request()->mainRequest() &&
-              store_it->request()->mainRequest()->isCacheMaintenance())) {
-            assert(store_it->instruction()->effAddrValid());
-
-            // Check if the store data is within the lower and upper bounds of
-            // addresses that the request needs.
-            auto req_s = req->mainRequest()->getVaddr();
-            auto req_e = req_s + req->mainRequest()->getSize();
-            auto st_s = store_it->instruction()->effAddr;
-            auto st_e = st_s + store_size;
-
-            bool store_has_lower_limit = req_s >= st_s;
-            bool store_has_upper_limit = req_e <= st_e;
-            bool lower_load_has_store_part = req_s < st_e;
-            bool upper_load_has_store_part = req_e > st_s;
-
-            auto coverage = AddrRangeCoverage::NoAddrRangeCoverage;
-
-            // If the store entry is not atomic (atomic does not have valid
-            // data), the store has all of the data needed, and
-            // the load is not LLSC, then
-            // we can forward data from the store to the load
-            if (!store_it->instruction()->isAtomic() &&
-                store_has_lower_limit && store_has_upper_limit &&
-                !req->mainRequest()->isLLSC()) {
-
-                const auto& store_req = store_it->request()->mainRequest();
-                coverage = store_req->isMasked() ?
-                    AddrRangeCoverage::PartialAddrRangeCoverage :
-                    AddrRangeCoverage::FullAddrRangeCoverage;
-            } else if (
-                // This is the partial store-load forwarding case where a store
-                // has only part of the load's data and the load isn't LLSC
-                (!req->mainRequest()->isLLSC() &&
-                 ((store_has_lower_limit && lower_load_has_store_part) ||
-                  (store_has_upper_limit && upper_load_has_store_part) ||
-                  (lower_load_has_store_part && upper_load_has_store_part))) ||
-                // The load is LLSC, and the store has all or part of the
-                // load's data
-                (req->mainRequest()->isLLSC() &&
-                 ((store_has_lower_limit || upper_load_has_store_part) &&
-                  (store_has_upper_limit || lower_load_has_store_part))) ||
-                // The store entry is atomic and has all or part of the load's
-                // data
-                (store_it->instruction()->isAtomic() &&
-                 ((store_has_lower_limit || upper_load_has_store_part) &&
-                  (store_has_upper_limit || lower_load_has_store_part)))) {
-
-                coverage = AddrRangeCoverage::PartialAddrRangeCoverage;
-            }
+    auto coverage = AddrRangeCoverage::NoAddrRangeCoverage;
+    auto store_it = findForwardingStore(load_inst, req, coverage);
+
+    if (coverage == AddrRangeCoverage::FullAddrRangeCoverage) {
+        // Get shift amount for offset into the store's data.
+        int shift_amt = req->mainRequest()->getVaddr() -
+            store_it->instruction()->effAddr;
+
+        // Allocate memory if this is the first time a load is issued.
+        if (!load_inst->memData) {
+            load_inst->memData =
+                new uint8_t[req->mainRequest()->getSize()];
+        }
+        if (store_it->isAllZeros())
+            memset(load_inst->memData, 0,
+                    req->mainRequest()->getSize());
+        else
+            memcpy(load_inst->memData,
+                store_it->data() + shift_amt,
+                req->mainRequest()->getSize());
+
+        DPRINTF(LSQUnit, "Forwarding from store idx %i to load to "
+                "addr %#x\n", store_it._idx,
+                req->mainRequest()->getVaddr());
+
+        PacketPtr data_pkt = new Packet(req->mainRequest(),
+                MemCmd::ReadReq);
+        data_pkt->dataStatic(load_inst->memData);
+
+        // hardware transactional memory
+        // Store to load forwarding within a transaction
+        // This should be okay because the store will be sent to
+        // the memory subsystem and subsequently get added to the
+        // write set of the transaction. The write set has a stronger
+        // property than the read set, so the load doesn't necessarily
+        // have to be there.
+        assert(!req->mainRequest()->isHTMCmd());
+        if (load_inst->inHtmTransactionalState()) {
+            assert (!storeQueue[store_it._idx].completed());
+            assert (
+                storeQueue[store_it._idx].instruction()->
+                  inHtmTransactionalState());
+            assert (
+                load_inst->getHtmTransactionUid() ==
+                storeQueue[store_it._idx].instruction()->
+                  getHtmTransactionUid());
+            data_pkt->setHtmTransactional(
+                load_inst->getHtmTransactionUid());
+            DPRINTF(HtmCpu, "HTM LD (ST2LDF) "
+              "pc=0x%lx - vaddr=0x%lx - "
+              "paddr=0x%lx - htmUid=%u\n",
+              load_inst->instAddr(),
+              data_pkt->req->hasVaddr() ?
+                data_pkt->req->getVaddr() : 0lu,
+              data_pkt->getAddr(),
+              load_inst->getHtmTransactionUid());
+        }
 
-            if (coverage == AddrRangeCoverage::FullAddrRangeCoverage) {
-                // Get shift amount for offset into the store's data.
-                int shift_amt = req->mainRequest()->getVaddr() -
-                    store_it->instruction()->effAddr;
-
-                // Allocate memory if this is the first time a load is issued.
-                if (!load_inst->memData) {
-                    load_inst->memData =
-                        new uint8_t[req->mainRequest()->getSize()];
-                }
-                if (store_it->isAllZeros())
-                    memset(load_inst->memData, 0,
-                            req->mainRequest()->getSize());
-                else
-                    memcpy(load_inst->memData,
-                        store_it->data() + shift_amt,
-                        req->mainRequest()->getSize());
-
-                DPRINTF(LSQUnit, "Forwarding from store idx %i to load to "
-                        "addr %#x\n", store_it._idx,
-                        req->mainRequest()->getVaddr());
-
-                PacketPtr data_pkt = new Packet(req->mainRequest(),
-                        MemCmd::ReadReq);
-                data_pkt->dataStatic(load_inst->memData);
-
-                // hardware transactional memory
-                // Store to load forwarding within a transaction
-                // This should be okay because the store will be sent to
-                // the memory subsystem and subsequently get added to the
-                // write set of the transaction. The write set has a stronger
-                // property than the read set, so the load doesn't necessarily
-                // have to be there.
-                assert(!req->mainRequest()->isHTMCmd());
-                if (load_inst->inHtmTransactionalState()) {
-                    assert (!storeQueue[store_it._idx].completed());
-                    assert (
-                        storeQueue[store_it._idx].instruction()->
-                          inHtmTransactionalState());
-                    assert (
-                        load_inst->getHtmTransactionUid() ==
-                        storeQueue[store_it._idx].instruction()->
-                          getHtmTransactionUid());
-                    data_pkt->setHtmTransactional(
-                        load_inst->getHtmTransactionUid());
-                    DPRINTF(HtmCpu, "HTM LD (ST2LDF) "
-                      "pc=0x%lx - vaddr=0x%lx - "
-                      "paddr=0x%lx - htmUid=%u\n",
-                      load_inst->instAddr(),
-                      data_pkt->req->hasVaddr() ?
-                        data_pkt->req->getVaddr() : 0lu,
-                      data_pkt->getAddr(),
-                      load_inst->getHtmTransactionUid());
-                }
-
-                if (req->isAnyOutstandingRequest()) {
-                    assert(req->_numOutstandingPackets > 0);
-                    // There are memory requests packets in flight already.
-                    // This may happen if the store was not complete the
-                    // first time this load got executed. Signal the senderSate
-                    // that response packets should be discarded.
-                    req->discardSenderState();
-                }
-
-                WritebackEvent *wb = new WritebackEvent(load_inst, data_pkt,
-                        this);
-
-                // We'll say this has a 1 cycle load-store forwarding latency
-                // for now.
-                // @todo: Need to make this a parameter.
-                cpu->schedule(wb, curTick());
-
-                // Don't need to do anything special for split loads.
-                ++stats.forwLoads;
-
-                return NoFault;
-            } else if (coverage == AddrRangeCoverage::PartialAddrRangeCoverage) {
-                // If it's already been written back, then don't worry about
-                // stalling on it.
-                if (store_it->completed()) {
-                    panic("Should not check one of these");
-                    continue;
-                }
-
-                // Must stall load and force it to retry, so long as it's the
-                // oldest load that needs to do so.
-                if (!stalled ||
-                    (stalled &&
-                     load_inst->seqNum <
-                     loadQueue[stallingLoadIdx].instruction()->seqNum)) {
-                    stalled = true;
-                    stallingStoreIsn = store_it->instruction()->seqNum;
-                    stallingLoadIdx = load_idx;
-                }
-
-                // Tell IQ/mem dep unit that this instruction will need to be
-                // rescheduled eventually
-                iewStage->rescheduleMemInst(load_inst);
-                load_inst->clearIssued();
-                load_inst->effAddrValid(false);
-                ++stats.rescheduledLoads;
-
-                // Do not generate a writeback event as this instruction is not
-                // complete.
-                DPRINTF(LSQUnit, "Load-store forwarding mis-match. "
-                        "Store idx %i to load addr %#x\n",
-                        store_it._idx, req->mainRequest()->getVaddr());
-
-                // Must discard the request.
-                req->discard();
-                load_req.setRequest(nullptr);
-                return NoFault;
-            }
+        if (req->isAnyOutstandingRequest()) {
+            assert(req->_numOutstandingPackets > 0);
+            // There are memory requests packets in flight already.
+            // This may happen if the store was not complete the
+            // first time this load got executed. Signal the senderSate
+            // that response packets should be discarded.
+            req->discardSenderState();
+        }
+
+        WritebackEvent *wb = new WritebackEvent(load_inst, data_pkt,
+                this);
+
+        // We'll say this has a 1 cycle load-store forwarding latency
+        // for now.
+        // @todo: Need to make this a parameter.
+        cpu->schedule(wb, curTick());
+
+        // Don't need to do anything special for split loads.
+        ++stats.forwLoads;
+
+        return NoFault;
+    } else if (coverage == AddrRangeCoverage::PartialAddrRangeCoverage) {
+        // If it's already been written back, then don't worry about
+        // stalling on it.
+        if (store_it->completed()) {
+            panic("Should not check one of these");
         }
+
+        // Must stall load and force it to retry, so long as it's the
+        // oldest load that needs to do so.
+        if (!stalled ||
+            (stalled &&
+             load_inst->seqNum <
+             loadQueue[stallingLoadIdx].instruction()->seqNum)) {
+            stalled = true;
+            stallingStoreIsn = store_it->instruction()->seqNum;
+            stallingLoadIdx = load_idx;
+        }
+
+        // Tell IQ/mem dep unit that this instruction will need to be
+        // rescheduled eventually
+        iewStage->rescheduleMemInst(load_inst);
+        load_inst->clearIssued();
+        load_inst->effAddrValid(false);
+        ++stats.rescheduledLoads;
+
+        // Do not generate a writeback event as this instruction is not
+        // complete.
+        DPRINTF(LSQUnit, "Load-store forwarding mis-match. "
+                "Store idx %i to load addr %#x\n",
+                store_it._idx, req->mainRequest()->getVaddr());
+
+        // Must discard the request.
+        req->discard();
+        load_req.setRequest(nullptr);
+        return NoFault;
+    }
+
+    // A fenced load that misses in the L1 keeps its translated request
+    // and waits for VP, see delayOnMiss().
+    if (delayOnMiss(load_inst, req)) {
+        load_inst->effAddrValid(false);
+        return NoFault;
     }
 
     // If there's no forwarding case, then go access memory
@@ -973,6 +1001,9 @@ LSQUnit<Impl>::write(LSQRequest *req, uint8_t *data, int store_idx)
     storeQueue[store_idx].setRequest(req);
     unsigned size = req->_size;
     storeQueue[store_idx].size() = size;
+    if (useAddrIndex)
+        sqAddrIndex.insert(store_idx,
+                           storeQueue[store_idx].instruction()->effAddr, size);
     bool store_no_data =
         req->mainRequest()->getFlags() & Request::STORE_NO_DATA;
     storeQueue[store_idx].isAllZeros() = store_no_data;
@@ -45,9 +45,11 @@
 
 #include "arch/generic/debugfaults.hh"
 #include "arch/locked_mem.hh"
+#include "base/intmath.hh"
 #include "base/str.hh"
 #include "config/the_isa.hh"
 #include "cpu/checker/cpu.hh"
+#include "cpu/global_utils.hh"
 #include "cpu/o3/lsq.hh"
 #include "cpu/o3/lsq_unit.hh"
 #include "debug/Activity.hh"
@@ -61,8 +63,7 @@
 template<class Impl>
 LSQUnit<Impl>::WritebackEvent::WritebackEvent(const DynInstPtr &_inst,
         PacketPtr _pkt, LSQUnit *lsq_ptr)
-    : Event(Default_Pri, AutoDelete),
-      inst(_inst), pkt(_pkt), lsqPtr(lsq_ptr)
+    : inst(_inst), pkt(_pkt), lsqPtr(lsq_ptr)
 {
     assert(_inst->savedReq);
     _inst->savedReq->writebackScheduled();
@@ -166,6 +167,26 @@ LSQUnit<Impl>::completeDataAccess(PacketPtr pkt)
         }
     }
 
+    // The line left the L1 between the probe in delayOnMiss() and the
+    // access, and the L1 refused to fill it. The load waits for VP as if
+    // the probe had missed.
+    if (pkt->isDeferredMiss()) {
+        if (!inst->isSquashed()) {
+            DPRINTF(LSQUnit, "Fenced load [sn:%lli] missed in the L1 after "
+                    "its probe, delaying it to VP\n", inst->seqNum);
+            iewStage->refenceMemInst(inst);
+            inst->clearIssued();
+            inst->effAddrValid(false);
+            inst->resetDeferredTouch();
+            ++stats.delayOnMissNacks;
+
+            // Must discard the request.
+            state->request()->discard();
+            inst->lqIt->setRequest(nullptr);
+        }
+        return;
+    }
+
     cpu->ppDataAccessComplete->notify(std::make_pair(inst, pkt));
 
     /* Notify the sender state that the access is complete (for ownership
@@ -206,7 +227,8 @@ LSQUnit<Impl>::LSQUnit(uint32_t lqEntries, uint32_t sqEntries)
       loads(0), stores(0), storesToWB(0),
       htmStarts(0), htmStops(0),
       lastRetiredHtmUid(0),
-      cacheBlockMask(0), stalled(false),
+      cacheBlockMask(0), useAddrIndex(false), checkAddrIndex(false),
+      stalled(false),
       isStoreBlocked(false), storeInFlight(false), hasPendingRequest(false),
       pendingRequest(nullptr), stats(nullptr)
 {
@@ -232,6 +254,14 @@ LSQUnit<Impl>::init(O3CPU *cpu_ptr, IEW *iew_ptr, DerivO3CPUParams *params,
     checkLoads = params->LSQCheckLoads;
     needsTSO = params->needsTSO;
 
+    checkAddrIndex = params->LSQAddrIndexCheck;
+    useAddrIndex = params->LSQAddrIndex || checkAddrIndex;
+    // Coarser blocks than depCheckShift still find every candidate
+    unsigned block_shift = floorLog2(cpu->cacheLineSize());
+    lqAddrIndex.init(loadQueue.capacity(),
+                     std::max(block_shift, depCheckShift));
+    sqAddrIndex.init(storeQueue.capacity(), block_shift);
+
     resetState();
 }
 
@@ -254,6 +284,9 @@ LSQUnit<Impl>::resetState()
     stalled = false;
 
     cacheBlockMask = ~(cpu->cacheLineSize() - 1);
+
+    lqAddrIndex.clear();
+    sqAddrIndex.clear();
 }
 
 template<class Impl>
@@ -281,7 +314,15 @@ LSQUnit<Impl>::LSQUnitStats::LSQUnitStats(Stats::Group *parent)
       ADD_STAT(blockedByCache, "Number of times an access to memory failed"
           " due to the cache being blocked"),
       ADD_STAT(lqSquashSet, "Number of times squash was set in Load Queue"),
-      ADD_STAT(sqSquashSet, "Number of times squash was set in Store Queue")
+      ADD_STAT(sqSquashSet, "Number of times squash was set in Store Queue"),
+      ADD_STAT(delayOnMissHits, "Number of fenced loads that hit in the L1"
+          " under DelayOnMiss"),
+      ADD_STAT(delayOnMissDelays, "Number of fenced loads that missed in the"
+          " L1 under DelayOnMiss and waited for VP"),
+      ADD_STAT(delayOnMissNacks, "Number of fenced loads that hit in the L1"
+          " probe, were refused by the L1 and waited for VP"),
+      ADD_STAT(delayOnMissTouches, "Number of replacement updates deferred"
+          " by DelayOnMiss that were applied at VP")
 {
 }
 
@@ -292,6 +333,59 @@ LSQUnit<Impl>::setDcachePort(RequestPort *dcache_port)
     dcachePort = dcache_port;
 }
 
+template<class Impl>
+bool
+LSQUnit<Impl>::delayOnMiss(const DynInstPtr &inst, LSQRequest *req)
+{
+    using bridge::GCONFIG;
+
+    if (GCONFIG.hw != utils::DELAY_ON_MISS || !inst->isFenced() ||
+        inst->isReachedVP() || !inst->isSpeculative() ||
+        !(GCONFIG.isSpectre || GCONFIG.isFuturistic) ||
+        inst->isSquashed() || inst->isProtectionLifted()) {
+        return false;
+    }
+
+    // Accesses that span two lines or have side effects at the cache
+    // are not probed and wait as they would under Fence.
+    const RequestPtr &main_req = req->mainRequest();
+    bool hit = false;
+    if (!req->isSplit() && !main_req->isLLSC() && !main_req->isHTMCmd() &&
+        !main_req->isLockedRMW()) {
+        Packet probe(main_req, MemCmd::ReadReq);
+        hit = dcachePort->sendFunctionalProbe(&probe);
+    }
+
+    if (hit) {
+        DPRINTF(LSQUnit, "Fenced load [sn:%lli] hit in the L1, deferring "
+                "its replacement update to VP\n", inst->seqNum);
+        main_req->setFlags(Request::DEFER_REPLACEMENT);
+        inst->setDeferredTouch();
+        ++stats.delayOnMissHits;
+        return false;
+    }
+
+    DPRINTF(LSQUnit, "Fenced load [sn:%lli] missed in the L1, delaying it "
+            "to VP\n", inst->seqNum);
+    inst->setDelayedOnMiss();
+    ++stats.delayOnMissDelays;
+    return true;
+}
+
+template<class Impl>
+void
+LSQUnit<Impl>::touchDeferred(const DynInstPtr &inst)
+{
+    assert(inst->isDeferredTouch());
+    inst->resetDeferredTouch();
+
+    RequestPtr req = makeRequest(inst->physEffAddr, inst->effSize, 0,
+                                 cpu->dataRequestorId());
+    Packet touch(req, MemCmd::ReadReq);
+    if (dcachePort->sendFunctionalProbe(&touch, true))
+        ++stats.delayOnMissTouches;
+}
+
 template<class Impl>
 void
 LSQUnit<Impl>::drainSanityCheck() const
@@ -526,83 +620,303 @@ LSQUnit<Impl>::checkSnoop(PacketPtr pkt)
 }
 
 template <class Impl>
-Fault
-LSQUnit<Impl>::checkViolations(typename LoadQueue::iterator& loadIt,
-        const DynInstPtr& inst)
+bool
+LSQUnit<Impl>::violationCandidate(const DynInstPtr& inst,
+        const DynInstPtr& ld_inst) const
 {
+    if (!ld_inst->effAddrValid() || ld_inst->strictlyOrdered())
+        return false;
+
     Addr inst_eff_addr1 = inst->effAddr >> depCheckShift;
     Addr inst_eff_addr2 = (inst->effAddr + inst->effSize - 1) >> depCheckShift;
+    Addr ld_eff_addr1 = ld_inst->effAddr >> depCheckShift;
+    Addr ld_eff_addr2 =
+        (ld_inst->effAddr + ld_inst->effSize - 1) >> depCheckShift;
 
-    /** @todo in theory you only need to check an instruction that has executed
-     * however, there isn't a good way in the pipeline at the moment to check
-     * all instructions that will execute before the store writes back. Thus,
-     * like the implementation that came before it, we're overly conservative.
-     */
-    while (loadIt != loadQueue.end()) {
-        DynInstPtr ld_inst = loadIt->instruction();
-        if (!ld_inst->effAddrValid() || ld_inst->strictlyOrdered()) {
-            ++loadIt;
-            continue;
-        }
+    return inst_eff_addr2 >= ld_eff_addr1 && inst_eff_addr1 <= ld_eff_addr2;
+}
 
-        Addr ld_eff_addr1 = ld_inst->effAddr >> depCheckShift;
-        Addr ld_eff_addr2 =
-            (ld_inst->effAddr + ld_inst->effSize - 1) >> depCheckShift;
-
-        if (inst_eff_addr2 >= ld_eff_addr1 && inst_eff_addr1 <= ld_eff_addr2) {
-            if (inst->isLoad()) {
-                // If this load is to the same block as an external snoop
-                // invalidate that we've observed then the load needs to be
-                // squashed as it could have newer data
-                if (ld_inst->hitExternalSnoop()) {
-                    if (!memDepViolator ||
-                            ld_inst->seqNum < memDepViolator->seqNum) {
-                        DPRINTF(LSQUnit, "Detected fault with inst [sn:%lli] "
-                                "and [sn:%lli] at address %#x\n",
-                                inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
-                        memDepViolator = ld_inst;
-
-                        ++stats.memOrderViolation;
-
-                        return std::make_shared<GenericISA::M5PanicFault>(
-                            "Detected fault with inst [sn:%lli] and "
-                            "[sn:%lli] at address %#x\n",
-                            inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
-                    }
-                }
-
-                // Otherwise, mark the load has a possible load violation
-                // and if we see a snoop before it's commited, we need to squash
-                ld_inst->possibleLoadViolation(true);
-                DPRINTF(LSQUnit, "Found possible load violation at addr: %#x"
-                        " between instructions [sn:%lli] and [sn:%lli]\n",
-                        inst_eff_addr1, inst->seqNum, ld_inst->seqNum);
-            } else {
-                // A load/store incorrectly passed this store.
-                // Check if we already have a violator, or if it's newer
-                // squash and refetch.
-                if (memDepViolator && ld_inst->seqNum > memDepViolator->seqNum)
-                    break;
-
-                DPRINTF(LSQUnit, "Detected fault with inst [sn:%lli] and "
-                        "[sn:%lli] at address %#x\n",
+template <class Impl>
+void
+LSQUnit<Impl>::findViolationCandidates(typename LoadQueue::iterator loadIt,
+        const DynInstPtr& inst, bool indexed, std::vector<int> &idxs)
+{
+    idxs.clear();
+
+    if (indexed && lqAddrIndex.find(inst->effAddr, inst->effSize, idxs)) {
+        // The loads from loadIt on are the ones younger than inst
+        auto not_candidate = [this, &inst](int idx) {
+            if (!loadQueue.isValidIdx(idx))
+                return true;
+            const DynInstPtr& ld_inst = loadQueue[idx].instruction();
+            return ld_inst->seqNum <= inst->seqNum ||
+                   !violationCandidate(inst, ld_inst);
+        };
+        idxs.erase(std::remove_if(idxs.begin(), idxs.end(), not_candidate),
+                   idxs.end());
+        std::sort(idxs.begin(), idxs.end(), [this](int a, int b) {
+            return loadQueue[a].instruction()->seqNum <
+                   loadQueue[b].instruction()->seqNum;
+        });
+        idxs.erase(std::unique(idxs.begin(), idxs.end()), idxs.end());
+        return;
+    }
+
+    for (; loadIt != loadQueue.end(); ++loadIt) {
+        if (violationCandidate(inst, loadIt->instruction()))
+            idxs.push_back(loadIt._idx);
+    }
+}
+
+template <class Impl>
+Fault
+LSQUnit<Impl>::checkViolation(const DynInstPtr& inst,
+        const DynInstPtr& ld_inst, bool &done)
+{
+    Addr inst_eff_addr1 = inst->effAddr >> depCheckShift;
+    Addr ld_eff_addr1 = ld_inst->effAddr >> depCheckShift;
+
+    if (inst->isLoad()) {
+        // If this load is to the same block as an external snoop
+        // invalidate that we've observed then the load needs to be
+        // squashed as it could have newer data
+        if (ld_inst->hitExternalSnoop()) {
+            if (!memDepViolator ||
+                    ld_inst->seqNum < memDepViolator->seqNum) {
+                DPRINTF(LSQUnit, "Detected fault with inst [sn:%lli] "
+                        "and [sn:%lli] at address %#x\n",
                         inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
                 memDepViolator = ld_inst;
 
                 ++stats.memOrderViolation;
 
+                done = true;
                 return std::make_shared<GenericISA::M5PanicFault>(
-                    "Detected fault with "
-                    "inst [sn:%lli] and [sn:%lli] at address %#x\n",
+                    "Detected fault with inst [sn:%lli] and "
+                    "[sn:%lli] at address %#x\n",
                     inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
             }
         }
 
+        // Otherwise, mark the load has a possible load violation
+        // and if we see a snoop before it's commited, we need to squash
+        ld_inst->possibleLoadViolation(true);
+        DPRINTF(LSQUnit, "Found possible load violation at addr: %#x"
+                " between instructions [sn:%lli] and [sn:%lli]\n",
+                inst_eff_addr1, inst->seqNum, ld_inst->seqNum);
+    } else {
+        // A load/store incorrectly passed this store.
+        // Check if we already have a violator, or if it's newer
+        // squash and refetch.
+        if (memDepViolator && ld_inst->seqNum > memDepViolator->seqNum) {
+            done = true;
+            return NoFault;
+        }
+
+        DPRINTF(LSQUnit, "Detected fault with inst [sn:%lli] and "
+                "[sn:%lli] at address %#x\n",
+                inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
+        memDepViolator = ld_inst;
+
+        ++stats.memOrderViolation;
+
+        done = true;
+        return std::make_shared<GenericISA::M5PanicFault>(
+            "Detected fault with "
+            "inst [sn:%lli] and [sn:%lli] at address %#x\n",
+            inst->seqNum, ld_inst->seqNum, ld_eff_addr1);
+    }
+    return NoFault;
+}
+
+template <class Impl>
+Fault
+LSQUnit<Impl>::checkViolations(typename LoadQueue::iterator& loadIt,
+        const DynInstPtr& inst)
+{
+    /** @todo in theory you only need to check an instruction that has executed
+     * however, there isn't a good way in the pipeline at the moment to check
+     * all instructions that will execute before the store writes back. Thus,
+     * like the implementation that came before it, we're overly conservative.
+     */
+    if (useAddrIndex) {
+        findViolationCandidates(loadIt, inst, true, addrIndexHits);
+        if (checkAddrIndex) {
+            findViolationCandidates(loadIt, inst, false, linearHits);
+            panic_if(addrIndexHits != linearHits,
+                     "LQ address index found %d loads to check against "
+                     "[sn:%lli], the LQ has %d\n", addrIndexHits.size(),
+                     inst->seqNum, linearHits.size());
+        }
+        for (int idx : addrIndexHits) {
+            bool done = false;
+            Fault fault = checkViolation(inst, loadQueue[idx].instruction(),
+                                         done);
+            if (done)
+                return fault;
+        }
+        return NoFault;
+    }
+
+    while (loadIt != loadQueue.end()) {
+        const DynInstPtr& ld_inst = loadIt->instruction();
+        if (violationCandidate(inst, ld_inst)) {
+            bool done = false;
+            Fault fault = checkViolation(inst, ld_inst, done);
+            if (done)
+                return fault;
+        }
+
         ++loadIt;
     }
     return NoFault;
 }
 
+template <class Impl>
+typename LSQUnit<Impl>::AddrRangeCoverage
+LSQUnit<Impl>::forwardCoverage(typename StoreQueue::iterator store_it,
+        LSQRequest *req) const
+{
+    int store_size = store_it->size();
+
+    // Cache maintenance instructions go down via the store
+    // path but they carry no data and they shouldn't be
+    // considered for forwarding
+    if (store_size == 0 || store_it->instruction()->strictlyOrdered() ||
+        (store_it->request()->mainRequest() &&
+         store_it->request()->mainRequest()->isCacheMaintenance())) {
+        return AddrRangeCoverage::NoAddrRangeCoverage;
+    }
+    assert(store_it->instruction()->effAddrValid());
+
+    // Check if the store data is within the lower and upper bounds of
+    // addresses that the request needs.
+    auto req_s = req->mainRequest()->getVaddr();
+    auto req_e = req_s + req->mainRequest()->getSize();
+    auto st_s = store_it->instruction()->effAddr;
+    auto st_e = st_s + store_size;
+
+    bool store_has_lower_limit = req_s >= st_s;
+    bool store_has_upper_limit = req_e <= st_e;
+    bool lower_load_has_store_part = req_s < st_e;
+    bool upper_load_has_store_part = req_e > st_s;
+
+    auto coverage = AddrRangeCoverage::NoAddrRangeCoverage;
+
+    // If the store entry is not atomic (atomic does not have valid
+    // data), the store has all of the data needed, and
+    // the load is not LLSC, then
+    // we can forward data from the store to the load
+    if (!store_it->instruction()->isAtomic() &&
+        store_has_lower_limit && store_has_upper_limit &&
+        !req->mainRequest()->isLLSC()) {
+
+        const auto& store_req = store_it->request()->mainRequest();
+        coverage = store_req->isMasked() ?
+            AddrRangeCoverage::PartialAddrRangeCoverage :
+            AddrRangeCoverage::FullAddrRangeCoverage;
+    } else if (
+        // This is the partial store-load forwarding case where a store
+        // has only part of the load's data and the load isn't LLSC
+        (!req->mainRequest()->isLLSC() &&
+         ((store_has_lower_limit && lower_load_has_store_part) ||
+          (store_has_upper_limit && upper_load_has_store_part) ||
+          (lower_load_has_store_part && upper_load_has_store_part))) ||
+        // The load is LLSC, and the store has all or part of the
+        // load's data
+        (req->mainRequest()->isLLSC() &&
+         ((store_has_lower_limit || upper_load_has_store_part) &&
+          (store_has_upper_limit || lower_load_has_store_part))) ||
+        // The store entry is atomic and has all or part of the load's
+        // data
+        (store_it->instruction()->isAtomic() &&
+         ((store_has_lower_limit || upper_load_has_store_part) &&
+          (store_has_upper_limit || lower_load_has_store_part)))) {
+
+        coverage = AddrRangeCoverage::PartialAddrRangeCoverage;
+    }
+    return coverage;
+}
+
+template <class Impl>
+typename LSQUnit<Impl>::StoreQueue::iterator
+LSQUnit<Impl>::searchStores(const DynInstPtr &load_inst, LSQRequest *req,
+        bool indexed, AddrRangeCoverage &coverage)
+{
+    // Empty loads may be covered by stores they do not overlap, so they
+    // always walk the SQ.
+    auto req_s = req->mainRequest()->getVaddr();
+    auto req_size = req->mainRequest()->getSize();
+    addrIndexHits.clear();
+    if (indexed && req_size != 0 &&
+        sqAddrIndex.find(req_s, req_size, addrIndexHits)) {
+        // Only the older stores that have not been written back are
+        // searched, youngest first
+        auto not_candidate = [this, &load_inst](int idx) {
+            return !storeQueue.isValidIdx(idx) ||
+                   storeQueue[idx].instruction()->seqNum >=
+                   load_inst->seqNum ||
+                   storeQueue.getIterator(idx) < storeWBIt;
+        };
+        addrIndexHits.erase(std::remove_if(addrIndexHits.begin(),
+                                           addrIndexHits.end(),
+                                           not_candidate),
+                            addrIndexHits.end());
+        std::sort(addrIndexHits.begin(), addrIndexHits.end(),
+                  [this](int a, int b) {
+            return storeQueue[a].instruction()->seqNum >
+                   storeQueue[b].instruction()->seqNum;
+        });
+        addrIndexHits.erase(std::unique(addrIndexHits.begin(),
+                                        addrIndexHits.end()),
+                            addrIndexHits.end());
+
+        for (int idx : addrIndexHits) {
+            auto store_it = storeQueue.getIterator(idx);
+            coverage = forwardCoverage(store_it, req);
+            if (coverage != AddrRangeCoverage::NoAddrRangeCoverage)
+                return store_it;
+        }
+        return storeQueue.end();
+    }
+
+    auto store_it = load_inst->sqIt;
+    assert (store_it >= storeWBIt);
+    // End once we've reached the top of the LSQ
+    while (store_it != storeWBIt) {
+        // Move the index to one younger
+        store_it--;
+        assert(store_it->valid());
+        assert(store_it->instruction()->seqNum < load_inst->seqNum);
+        coverage = forwardCoverage(store_it, req);
+        if (coverage != AddrRangeCoverage::NoAddrRangeCoverage)
+            return store_it;
+    }
+    return storeQueue.end();
+}
+
+template <class Impl>
+typename LSQUnit<Impl>::StoreQueue::iterator
+LSQUnit<Impl>::findForwardingStore(const DynInstPtr &load_inst,
+        LSQRequest *req, AddrRangeCoverage &coverage)
+{
+    coverage = AddrRangeCoverage::NoAddrRangeCoverage;
+    auto store_it = searchStores(load_inst, req, useAddrIndex, coverage);
+
+    if (checkAddrIndex) {
+        auto linear_coverage = AddrRangeCoverage::NoAddrRangeCoverage;
+        auto linear_it = searchStores(load_inst, req, false,
+                                      linear_coverage);
+        panic_if(linear_coverage != coverage ||
+                 (coverage != AddrRangeCoverage::NoAddrRangeCoverage &&
+                  linear_it != store_it),
+                 "SQ address index found store idx %i to forward to load "
+                 "[sn:%lli], the SQ has idx %i\n", store_it._idx,
+                 load_inst->seqNum, linear_it._idx);
+    }
+    return store_it;
+}
+
 
 
 
@@ -736,6 +1050,7 @@ LSQUnit<Impl>::commitLoad()
     DPRINTF(LSQUnit, "Committing head load instruction, PC %s\n",
             loadQueue.front().instruction()->pcState());
 
+    lqAddrIndex.remove(loadQueue.head());
     loadQueue.front().clear();
     loadQueue.pop_front();
 
@@ -982,6 +1297,7 @@ LSQUnit<Impl>::squash(const InstSeqNum &squashed_num)
           ++stats.lqSquashSet;
         }
 
+        lqAddrIndex.remove(loadQueue.tail());
         loadQueue.back().clear();
 
         --loads;
@@ -1061,6 +1377,7 @@ LSQUnit<Impl>::squash(const InstSeqNum &squashed_num)
         // Must delete request now that it wasn't handed off to
         // memory.  This is quite ugly.  @todo: Figure out the proper
         // place to really handle request deletes.
+        sqAddrIndex.remove(storeQueue.tail());
         storeQueue.back().clear();
         --stores;
 
@@ -1181,6 +1498,7 @@ LSQUnit<Impl>::completeStore(typename StoreQueue::iterator store_idx)
     DynInstPtr store_inst = store_idx->instruction();
     if (store_idx == storeQueue.begin()) {
         do {
+            sqAddrIndex.remove(storeQueue.head());
             storeQueue.front().clear();
             storeQueue.pop_front();
             --stores;
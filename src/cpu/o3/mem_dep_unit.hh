@@ -42,24 +42,13 @@
 #define __CPU_O3_MEM_DEP_UNIT_HH__
 
 #include <list>
-#include <memory>
-#include <set>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/o3/age_ring.hh"
 #include "debug/MemDepUnit.hh"
 
-struct SNHash {
-    size_t operator() (const InstSeqNum &seq_num) const {
-        unsigned a = (unsigned)seq_num;
-        unsigned hash = (((a >> 14) ^ ((a >> 2) & 0xffff))) & 0x7FFFFFFF;
-
-        return hash;
-    }
-};
-
 struct DerivO3CPUParams;
 
 template <class Impl>
@@ -92,9 +81,6 @@ class MemDepUnit
     /** Constructs a MemDepUnit with given parameters. */
     MemDepUnit(DerivO3CPUParams *params);
 
-    /** Frees up any memory allocated. */
-    ~MemDepUnit();
-
     /** Returns the name of the memory dependence unit. */
     std::string name() const { return _name; }
 
@@ -167,87 +153,66 @@ class MemDepUnit
 
     typedef typename std::list<DynInstPtr>::iterator ListIt;
 
-    class MemDepEntry;
-
-    typedef std::shared_ptr<MemDepEntry> MemDepEntryPtr;
-
     /** Memory dependence entries that track memory operations, marking
      *  when the instruction is ready to execute and what instructions depend
      *  upon it.
      */
-    class MemDepEntry {
-      public:
-        /** Constructs a memory dependence entry. */
-        MemDepEntry(const DynInstPtr &new_inst)
-            : inst(new_inst), regsReady(false), memDeps(0),
-              completed(false), squashed(false)
-        {
-#ifdef DEBUG
-            ++memdep_count;
-
-            DPRINTF(MemDepUnit, "Memory dependency entry created.  "
-                    "memdep_count=%i %s\n", memdep_count, inst->pcState());
-#endif
-        }
-
-        /** Frees any pointers. */
-        ~MemDepEntry()
-        {
-            for (int i = 0; i < dependInsts.size(); ++i) {
-                dependInsts[i] = NULL;
-            }
-#ifdef DEBUG
-            --memdep_count;
-
-            DPRINTF(MemDepUnit, "Memory dependency entry deleted.  "
-                    "memdep_count=%i %s\n", memdep_count, inst->pcState());
-#endif
-        }
-
-        /** Returns the name of the memory dependence entry. */
-        std::string name() const { return "memdepentry"; }
-
-        /** The instruction being tracked. */
+    struct MemDepEntry {
+        /** The instruction being tracked, null once it has completed. */
         DynInstPtr inst;
+        /** Sequence number of the instruction. */
+        InstSeqNum seqNum = 0;
+        /** First node of the list of dependent instructions, -1 if none. */
+        int dependents = -1;
+        /** Last node of the list, which is kept in insertion order. */
+        int lastDependent = -1;
+        /** Number of memory dependencies that need to be satisfied. */
+        int memDeps = 0;
+        /** If the registers are ready or not. */
+        bool regsReady = false;
+    };
 
-        /** The iterator to the instruction's location inside the list. */
-        ListIt listIt;
+    /** Node of the intrusive list of instructions waiting on an entry. */
+    struct WaitNode {
+        /** Sequence number of the waiting instruction. */
+        InstSeqNum seqNum;
+        /** Next node of the list, -1 at the end. */
+        int next;
+    };
 
-        /** A vector of any dependent instructions. */
-        std::vector<MemDepEntryPtr> dependInsts;
+    /** Adds an entry for a newly inserted instruction. */
+    MemDepEntry &allocate(const DynInstPtr &inst);
 
-        /** If the registers are ready or not. */
-        bool regsReady;
-        /** Number of memory dependencies that need to be satisfied. */
-        int memDeps;
-        /** If the instruction is completed. */
-        bool completed;
-        /** If the instruction is squashed. */
-        bool squashed;
-
-        /** For debugging. */
-#ifdef DEBUG
-        static int memdep_count;
-        static int memdep_insert;
-        static int memdep_erase;
-#endif
-    };
+    /** Finds the entry of an instruction that has not completed. */
+    MemDepEntry &findEntry(const DynInstConstPtr &inst);
 
-    /** Finds the memory dependence entry in the hash map. */
-    inline MemDepEntryPtr &findInHash(const DynInstConstPtr& inst);
+    /** Finds the entry of an in-flight instruction, null if none. */
+    MemDepEntry *lookup(InstSeqNum seq_num);
 
-    /** Moves an entry to the ready list. */
-    inline void moveToReady(MemDepEntryPtr &ready_inst_entry);
+    /** Makes the instruction seq_num wait on producer. */
+    void addDependent(MemDepEntry &producer, InstSeqNum seq_num);
 
-    typedef std::unordered_map<InstSeqNum, MemDepEntryPtr, SNHash> MemDepHash;
+    /** Returns the dependents list of an entry to the free nodes. */
+    void releaseDependents(MemDepEntry &entry);
 
-    typedef typename MemDepHash::iterator MemDepHashIt;
+    /** Moves an entry to the ready list. */
+    inline void moveToReady(MemDepEntry &ready_inst_entry);
+
+    /**
+     * The memory instructions in flight in program order. Completed
+     * instructions leave holes that are dropped once all older ones
+     * have completed as well, and squashed ones leave from the young
+     * end. The ring is sized for a full ROB, so entries, like the
+     * nodes of the dependents lists, are recycled rather than
+     * allocated per instruction.
+     */
+    AgeRing<MemDepEntry> entries;
 
-    /** A hash map of all memory dependence entries. */
-    MemDepHash memDepHash;
+    /** Storage of the dependents lists. */
+    std::vector<WaitNode> waitNodes;
 
-    /** A list of all instructions in the memory dependence unit. */
-    std::list<DynInstPtr> instList[Impl::MaxThreads];
+    /** First unused node in waitNodes, -1 if none. */
+    int freeWaitNode;
 
     /** A list of all instructions that are going to be replayed. */
     std::list<DynInstPtr> instsToReplay;
@@ -259,11 +224,11 @@ class MemDepUnit
      */
     MemDepPred depPred;
 
-    /** Sequence numbers of outstanding load barriers. */
-    std::unordered_set<InstSeqNum> loadBarrierSNs;
+    /** Sequence numbers of outstanding load barriers, oldest first. */
+    std::vector<InstSeqNum> loadBarrierSNs;
 
-    /** Sequence numbers of outstanding store barriers. */
-    std::unordered_set<InstSeqNum> storeBarrierSNs;
+    /** Sequence numbers of outstanding store barriers, oldest first. */
+    std::vector<InstSeqNum> storeBarrierSNs;
 
     /** Is there an outstanding load barrier that loads must wait on. */
     bool hasLoadBarrier() const { return !loadBarrierSNs.empty(); }
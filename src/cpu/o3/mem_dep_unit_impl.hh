@@ -41,7 +41,7 @@
 #ifndef __CPU_O3_MEM_DEP_UNIT_IMPL_HH__
 #define __CPU_O3_MEM_DEP_UNIT_IMPL_HH__
 
-#include <map>
+#include <algorithm>
 #include <vector>
 
 #include "cpu/o3/inst_queue.hh"
@@ -51,13 +51,15 @@
 
 template <class MemDepPred, class Impl>
 MemDepUnit<MemDepPred, Impl>::MemDepUnit()
-    : iqPtr(NULL)
+    : freeWaitNode(-1), iqPtr(NULL)
 {
 }
 
 template <class MemDepPred, class Impl>
 MemDepUnit<MemDepPred, Impl>::MemDepUnit(DerivO3CPUParams *params)
     : _name(params->name + ".memdepunit"),
+      entries(params->numROBEntries),
+      freeWaitNode(-1),
       depPred(params->store_set_clear_period, params->SSITSize,
               params->LFSTSize),
       iqPtr(NULL)
@@ -65,31 +67,6 @@ MemDepUnit<MemDepPred, Impl>::MemDepUnit(DerivO3CPUParams *params)
     DPRINTF(MemDepUnit, "Creating MemDepUnit object.\n");
 }
 
-template <class MemDepPred, class Impl>
-MemDepUnit<MemDepPred, Impl>::~MemDepUnit()
-{
-    for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++) {
-
-        ListIt inst_list_it = instList[tid].begin();
-
-        MemDepHashIt hash_it;
-
-        while (!instList[tid].empty()) {
-            hash_it = memDepHash.find((*inst_list_it)->seqNum);
-
-            assert(hash_it != memDepHash.end());
-
-            memDepHash.erase(hash_it);
-
-            instList[tid].erase(inst_list_it++);
-        }
-    }
-
-#ifdef DEBUG
-    assert(MemDepEntry::memdep_count == 0);
-#endif
-}
-
 template <class MemDepPred, class Impl>
 void
 MemDepUnit<MemDepPred, Impl>::init(DerivO3CPUParams *params, ThreadID tid)
@@ -99,6 +76,8 @@ MemDepUnit<MemDepPred, Impl>::init(DerivO3CPUParams *params, ThreadID tid)
     _name = csprintf("%s.memDep%d", params->name, tid);
     id = tid;
 
+    entries = AgeRing<MemDepEntry>(params->numROBEntries);
+
     depPred.init(params->store_set_clear_period, params->SSITSize,
             params->LFSTSize);
 }
@@ -128,13 +107,7 @@ template <class MemDepPred, class Impl>
 bool
 MemDepUnit<MemDepPred, Impl>::isDrained() const
 {
-    bool drained = instsToReplay.empty()
-                 && memDepHash.empty()
-                 && instsToReplay.empty();
-    for (int i = 0; i < Impl::MaxThreads; ++i)
-        drained = drained && instList[i].empty();
-
-    return drained;
+    return instsToReplay.empty() && entries.empty();
 }
 
 template <class MemDepPred, class Impl>
@@ -142,11 +115,7 @@ void
 MemDepUnit<MemDepPred, Impl>::drainSanityCheck() const
 {
     assert(instsToReplay.empty());
-    assert(memDepHash.empty());
-    for (int i = 0; i < Impl::MaxThreads; ++i)
-        assert(instList[i].empty());
-    assert(instsToReplay.empty());
-    assert(memDepHash.empty());
+    assert(entries.empty());
 }
 
 template <class MemDepPred, class Impl>
@@ -175,12 +144,12 @@ MemDepUnit<MemDepPred, Impl>::insertBarrierSN(const DynInstPtr &barr_inst)
     // Required also for hardware transactional memory commands which
     // can have strict ordering semantics
     if (barr_inst->isMemBarrier() || barr_inst->isHtmCmd()) {
-        loadBarrierSNs.insert(barr_sn);
-        storeBarrierSNs.insert(barr_sn);
+        loadBarrierSNs.push_back(barr_sn);
+        storeBarrierSNs.push_back(barr_sn);
         DPRINTF(MemDepUnit, "Inserted a memory barrier %s SN:%lli\n",
                 barr_inst->pcState(), barr_sn);
     } else if (barr_inst->isWriteBarrier()) {
-        storeBarrierSNs.insert(barr_sn);
+        storeBarrierSNs.push_back(barr_sn);
         DPRINTF(MemDepUnit, "Inserted a write barrier %s SN:%lli\n",
                 barr_inst->pcState(), barr_sn);
     }
@@ -196,89 +165,66 @@ template <class MemDepPred, class Impl>
 void
 MemDepUnit<MemDepPred, Impl>::insert(const DynInstPtr &inst)
 {
-    ThreadID tid = inst->threadNumber;
-
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(inst);
-
-    // Add the MemDepEntry to the hash.
-    memDepHash.insert(
-        std::pair<InstSeqNum, MemDepEntryPtr>(inst->seqNum, inst_entry));
-#ifdef DEBUG
-    MemDepEntry::memdep_insert++;
-#endif
-
-    instList[tid].push_back(inst);
-
-    inst_entry->listIt = --(instList[tid].end());
+    MemDepEntry &inst_entry = allocate(inst);
 
     // Check any barriers and the dependence predictor for any
     // producing memrefs/stores.
-    std::vector<InstSeqNum>  producing_stores;
+    const InstSeqNum *producing_stores = nullptr;
+    size_t num_producing_stores = 0;
+    InstSeqNum predicted_store = 0;
     if ((inst->isLoad() || inst->isAtomic()) && hasLoadBarrier()) {
         DPRINTF(MemDepUnit, "%d load barriers in flight\n",
                 loadBarrierSNs.size());
-        producing_stores.insert(std::end(producing_stores),
-                                std::begin(loadBarrierSNs),
-                                std::end(loadBarrierSNs));
+        producing_stores = loadBarrierSNs.data();
+        num_producing_stores = loadBarrierSNs.size();
     } else if ((inst->isStore() || inst->isAtomic()) && hasStoreBarrier()) {
         DPRINTF(MemDepUnit, "%d store barriers in flight\n",
                 storeBarrierSNs.size());
-        producing_stores.insert(std::end(producing_stores),
-                                std::begin(storeBarrierSNs),
-                                std::end(storeBarrierSNs));
+        producing_stores = storeBarrierSNs.data();
+        num_producing_stores = storeBarrierSNs.size();
     } else {
-        InstSeqNum dep = depPred.checkInst(inst->instAddr());
-        if (dep != 0)
-            producing_stores.push_back(dep);
+        predicted_store = depPred.checkInst(inst->instAddr());
+        if (predicted_store != 0) {
+            producing_stores = &predicted_store;
+            num_producing_stores = 1;
+        }
     }
 
-    std::vector<MemDepEntryPtr> store_entries;
-
-    // If there is a producing store, try to find the entry.
-    for (auto producing_store : producing_stores) {
+    // If there is a producing store, try to find the entry and add this
+    // instruction to its list of dependents.
+    for (size_t i = 0; i < num_producing_stores; ++i) {
         DPRINTF(MemDepUnit, "Searching for producer [sn:%lli]\n",
-                            producing_store);
-        MemDepHashIt hash_it = memDepHash.find(producing_store);
-
-        if (hash_it != memDepHash.end()) {
-            store_entries.push_back((*hash_it).second);
-            DPRINTF(MemDepUnit, "Producer found\n");
+                producing_stores[i]);
+        MemDepEntry *store_entry = lookup(producing_stores[i]);
+
+        if (store_entry) {
+            DPRINTF(MemDepUnit, "Producer found, inst PC %s is dependent "
+                    "on [sn:%lli].\n", inst->pcState(), producing_stores[i]);
+            addDependent(*store_entry, inst->seqNum);
+            ++inst_entry.memDeps;
         }
     }
 
     // If no store entry, then instruction can issue as soon as the registers
     // are ready.
-    if (store_entries.empty()) {
+    if (inst_entry.memDeps == 0) {
         DPRINTF(MemDepUnit, "No dependency for inst PC "
                 "%s [sn:%lli].\n", inst->pcState(), inst->seqNum);
 
-        assert(inst_entry->memDeps == 0);
-
         if (inst->readyToIssue()) {
-            inst_entry->regsReady = true;
+            inst_entry.regsReady = true;
 
             moveToReady(inst_entry);
         }
     } else {
-        // Otherwise make the instruction dependent on the store/barrier.
-        DPRINTF(MemDepUnit, "Adding to dependency list\n");
-        for (auto M5_VAR_USED producing_store : producing_stores)
-            DPRINTF(MemDepUnit, "\tinst PC %s is dependent on [sn:%lli].\n",
-                inst->pcState(), producing_store);
-
+        // Otherwise the instruction waits for the stores/barriers.
         if (inst->readyToIssue()) {
-            inst_entry->regsReady = true;
+            inst_entry.regsReady = true;
         }
 
         // Clear the bit saying this instruction can issue.
         inst->clearCanIssue();
 
-        // Add this instruction to the list of dependents.
-        for (auto store_entry : store_entries)
-            store_entry->dependInsts.push_back(inst_entry);
-
-        inst_entry->memDeps = store_entries.size();
-
         if (inst->isLoad()) {
             ++conflictingLoads;
         } else {
@@ -329,21 +275,7 @@ template <class MemDepPred, class Impl>
 void
 MemDepUnit<MemDepPred, Impl>::insertBarrier(const DynInstPtr &barr_inst)
 {
-    ThreadID tid = barr_inst->threadNumber;
-
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(barr_inst);
-
-    // Add the MemDepEntry to the hash.
-    memDepHash.insert(
-        std::pair<InstSeqNum, MemDepEntryPtr>(barr_inst->seqNum, inst_entry));
-#ifdef DEBUG
-    MemDepEntry::memdep_insert++;
-#endif
-
-    // Add the instruction to the instruction list.
-    instList[tid].push_back(barr_inst);
-
-    inst_entry->listIt = --(instList[tid].end());
+    allocate(barr_inst);
 
     insertBarrierSN(barr_inst);
 }
@@ -356,11 +288,11 @@ MemDepUnit<MemDepPred, Impl>::regsReady(const DynInstPtr &inst)
             "instruction PC %s [sn:%lli].\n",
             inst->pcState(), inst->seqNum);
 
-    MemDepEntryPtr inst_entry = findInHash(inst);
+    MemDepEntry &inst_entry = findEntry(inst);
 
-    inst_entry->regsReady = true;
+    inst_entry.regsReady = true;
 
-    if (inst_entry->memDeps == 0) {
+    if (inst_entry.memDeps == 0) {
         DPRINTF(MemDepUnit, "Instruction has its memory "
                 "dependencies resolved, adding it to the ready list.\n");
 
@@ -379,9 +311,7 @@ MemDepUnit<MemDepPred, Impl>::nonSpecInstReady(const DynInstPtr &inst)
             "instruction PC %s as ready [sn:%lli].\n",
             inst->pcState(), inst->seqNum);
 
-    MemDepEntryPtr inst_entry = findInHash(inst);
-
-    moveToReady(inst_entry);
+    moveToReady(findEntry(inst));
 }
 
 template <class MemDepPred, class Impl>
@@ -401,12 +331,10 @@ MemDepUnit<MemDepPred, Impl>::replay()
     while (!instsToReplay.empty()) {
         temp_inst = instsToReplay.front();
 
-        MemDepEntryPtr inst_entry = findInHash(temp_inst);
-
         DPRINTF(MemDepUnit, "Replaying mem instruction PC %s [sn:%lli].\n",
                 temp_inst->pcState(), temp_inst->seqNum);
 
-        moveToReady(inst_entry);
+        moveToReady(findEntry(temp_inst));
 
         instsToReplay.pop_front();
     }
@@ -419,21 +347,13 @@ MemDepUnit<MemDepPred, Impl>::completed(const DynInstPtr &inst)
     DPRINTF(MemDepUnit, "Completed mem instruction PC %s [sn:%lli].\n",
             inst->pcState(), inst->seqNum);
 
-    ThreadID tid = inst->threadNumber;
-
-    // Remove the instruction from the hash and the list.
-    MemDepHashIt hash_it = memDepHash.find(inst->seqNum);
+    // Leave a hole, and drop the holes at the old end.
+    MemDepEntry &inst_entry = findEntry(inst);
+    releaseDependents(inst_entry);
+    inst_entry.inst = NULL;
 
-    assert(hash_it != memDepHash.end());
-
-    instList[tid].erase((*hash_it).second->listIt);
-
-    (*hash_it).second = NULL;
-
-    memDepHash.erase(hash_it);
-#ifdef DEBUG
-    MemDepEntry::memdep_erase++;
-#endif
+    while (!entries.empty() && !entries.front().inst)
+        entries.pop_front();
 }
 
 template <class MemDepPred, class Impl>
@@ -447,13 +367,22 @@ MemDepUnit<MemDepPred, Impl>::completeInst(const DynInstPtr &inst)
     if (inst->isMemBarrier() || inst->isHtmCmd()) {
         assert(hasLoadBarrier());
         assert(hasStoreBarrier());
-        loadBarrierSNs.erase(barr_sn);
-        storeBarrierSNs.erase(barr_sn);
+        auto load_it = std::find(loadBarrierSNs.begin(),
+                                 loadBarrierSNs.end(), barr_sn);
+        if (load_it != loadBarrierSNs.end())
+            loadBarrierSNs.erase(load_it);
+        auto store_it = std::find(storeBarrierSNs.begin(),
+                                  storeBarrierSNs.end(), barr_sn);
+        if (store_it != storeBarrierSNs.end())
+            storeBarrierSNs.erase(store_it);
         DPRINTF(MemDepUnit, "Memory barrier completed: %s SN:%lli\n",
                             inst->pcState(), inst->seqNum);
     } else if (inst->isWriteBarrier()) {
         assert(hasStoreBarrier());
-        storeBarrierSNs.erase(barr_sn);
+        auto store_it = std::find(storeBarrierSNs.begin(),
+                                  storeBarrierSNs.end(), barr_sn);
+        if (store_it != storeBarrierSNs.end())
+            storeBarrierSNs.erase(store_it);
         DPRINTF(MemDepUnit, "Write barrier completed: %s SN:%lli\n",
                             inst->pcState(), inst->seqNum);
     }
@@ -470,31 +399,29 @@ MemDepUnit<MemDepPred, Impl>::wakeDependents(const DynInstPtr &inst)
         return;
     }
 
-    MemDepEntryPtr inst_entry = findInHash(inst);
-
-    for (int i = 0; i < inst_entry->dependInsts.size(); ++i ) {
-        MemDepEntryPtr woken_inst = inst_entry->dependInsts[i];
+    MemDepEntry &inst_entry = findEntry(inst);
 
-        if (!woken_inst->inst) {
-            // Potentially removed mem dep entries could be on this list
+    for (int node = inst_entry.dependents; node != -1;
+         node = waitNodes[node].next) {
+        // Squashed dependents are no longer in flight.
+        MemDepEntry *woken_inst = lookup(waitNodes[node].seqNum);
+        if (!woken_inst)
             continue;
-        }
 
         DPRINTF(MemDepUnit, "Waking up a dependent inst, "
                 "[sn:%lli].\n",
-                woken_inst->inst->seqNum);
+                woken_inst->seqNum);
 
         assert(woken_inst->memDeps > 0);
         woken_inst->memDeps -= 1;
 
         if ((woken_inst->memDeps == 0) &&
-            woken_inst->regsReady &&
-            !woken_inst->squashed) {
-            moveToReady(woken_inst);
+            woken_inst->regsReady) {
+            moveToReady(*woken_inst);
         }
     }
 
-    inst_entry->dependInsts.clear();
+    releaseDependents(inst_entry);
 }
 
 template <class MemDepPred, class Impl>
@@ -514,37 +441,21 @@ MemDepUnit<MemDepPred, Impl>::squash(const InstSeqNum &squashed_num,
         }
     }
 
-    ListIt squash_it = instList[tid].end();
-    --squash_it;
-
-    MemDepHashIt hash_it;
-
-    while (!instList[tid].empty() &&
-           (*squash_it)->seqNum > squashed_num) {
-
-        DPRINTF(MemDepUnit, "Squashing inst [sn:%lli]\n",
-                (*squash_it)->seqNum);
-
-        loadBarrierSNs.erase((*squash_it)->seqNum);
-
-        storeBarrierSNs.erase((*squash_it)->seqNum);
-
-        hash_it = memDepHash.find((*squash_it)->seqNum);
-
-        assert(hash_it != memDepHash.end());
-
-        (*hash_it).second->squashed = true;
-
-        (*hash_it).second = NULL;
-
-        memDepHash.erase(hash_it);
-#ifdef DEBUG
-        MemDepEntry::memdep_erase++;
-#endif
-
-        instList[tid].erase(squash_it--);
+    while (!entries.empty() && entries.back().seqNum > squashed_num) {
+        MemDepEntry &squashed = entries.back();
+        if (squashed.inst) {
+            DPRINTF(MemDepUnit, "Squashing inst [sn:%lli]\n",
+                    squashed.seqNum);
+            releaseDependents(squashed);
+        }
+        entries.pop_back();
     }
 
+    while (!loadBarrierSNs.empty() && loadBarrierSNs.back() > squashed_num)
+        loadBarrierSNs.pop_back();
+    while (!storeBarrierSNs.empty() && storeBarrierSNs.back() > squashed_num)
+        storeBarrierSNs.pop_back();
+
     // Tell the dependency predictor to squash as well.
     depPred.squash(squashed_num, tid);
 }
@@ -572,26 +483,81 @@ MemDepUnit<MemDepPred, Impl>::issue(const DynInstPtr &inst)
 }
 
 template <class MemDepPred, class Impl>
-inline typename MemDepUnit<MemDepPred,Impl>::MemDepEntryPtr &
-MemDepUnit<MemDepPred, Impl>::findInHash(const DynInstConstPtr &inst)
+typename MemDepUnit<MemDepPred,Impl>::MemDepEntry &
+MemDepUnit<MemDepPred, Impl>::allocate(const DynInstPtr &inst)
+{
+    MemDepEntry entry;
+    entry.inst = inst;
+    entry.seqNum = inst->seqNum;
+    entries.push_back(entry);
+    return entries.back();
+}
+
+template <class MemDepPred, class Impl>
+typename MemDepUnit<MemDepPred,Impl>::MemDepEntry &
+MemDepUnit<MemDepPred, Impl>::findEntry(const DynInstConstPtr &inst)
 {
-    MemDepHashIt hash_it = memDepHash.find(inst->seqNum);
+    MemDepEntry *entry = lookup(inst->seqNum);
 
-    assert(hash_it != memDepHash.end());
+    assert(entry);
 
-    return (*hash_it).second;
+    return *entry;
+}
+
+template <class MemDepPred, class Impl>
+typename MemDepUnit<MemDepPred,Impl>::MemDepEntry *
+MemDepUnit<MemDepPred, Impl>::lookup(InstSeqNum seq_num)
+{
+    size_t pos = entries.find(seq_num);
+    if (pos == entries.size() || !entries[pos].inst)
+        return nullptr;
+    return &entries[pos];
+}
+
+template <class MemDepPred, class Impl>
+void
+MemDepUnit<MemDepPred, Impl>::addDependent(MemDepEntry &producer,
+                                           InstSeqNum seq_num)
+{
+    int node = freeWaitNode;
+    if (node != -1) {
+        freeWaitNode = waitNodes[node].next;
+    } else {
+        node = waitNodes.size();
+        waitNodes.push_back(WaitNode());
+    }
+    waitNodes[node].seqNum = seq_num;
+    waitNodes[node].next = -1;
+    if (producer.dependents == -1)
+        producer.dependents = node;
+    else
+        waitNodes[producer.lastDependent].next = node;
+    producer.lastDependent = node;
+}
+
+template <class MemDepPred, class Impl>
+void
+MemDepUnit<MemDepPred, Impl>::releaseDependents(MemDepEntry &entry)
+{
+    while (entry.dependents != -1) {
+        int node = entry.dependents;
+        entry.dependents = waitNodes[node].next;
+        waitNodes[node].next = freeWaitNode;
+        freeWaitNode = node;
+    }
+    entry.lastDependent = -1;
 }
 
 template <class MemDepPred, class Impl>
 inline void
-MemDepUnit<MemDepPred, Impl>::moveToReady(MemDepEntryPtr &woken_inst_entry)
+MemDepUnit<MemDepPred, Impl>::moveToReady(MemDepEntry &woken_inst_entry)
 {
     DPRINTF(MemDepUnit, "Adding instruction [sn:%lli] "
-            "to the ready list.\n", woken_inst_entry->inst->seqNum);
+            "to the ready list.\n", woken_inst_entry.seqNum);
 
-    assert(!woken_inst_entry->squashed);
+    assert(woken_inst_entry.inst);
 
-    iqPtr->addReadyMemInst(woken_inst_entry->inst);
+    iqPtr->addReadyMemInst(woken_inst_entry.inst);
 }
 
 
@@ -599,31 +565,20 @@ template <class MemDepPred, class Impl>
 void
 MemDepUnit<MemDepPred, Impl>::dumpLists()
 {
-    for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++) {
-        cprintf("Instruction list %i size: %i\n",
-                tid, instList[tid].size());
-
-        ListIt inst_list_it = instList[tid].begin();
-        int num = 0;
-
-        while (inst_list_it != instList[tid].end()) {
-            cprintf("Instruction:%i\nPC: %s\n[sn:%llu]\n[tid:%i]\nIssued:%i\n"
-                    "Squashed:%i\n\n",
-                    num, (*inst_list_it)->pcState(),
-                    (*inst_list_it)->seqNum,
-                    (*inst_list_it)->threadNumber,
-                    (*inst_list_it)->isIssued(),
-                    (*inst_list_it)->isSquashed());
-            inst_list_it++;
-            ++num;
+    cprintf("Instruction list size: %i\n", entries.size());
+
+    for (size_t num = 0; num < entries.size(); ++num) {
+        const DynInstPtr &inst = entries[num].inst;
+        if (!inst) {
+            cprintf("Instruction:%i\n[sn:%llu]\nCompleted\n\n",
+                    num, entries[num].seqNum);
+            continue;
         }
+        cprintf("Instruction:%i\nPC: %s\n[sn:%llu]\n[tid:%i]\nIssued:%i\n"
+                "Squashed:%i\n\n",
+                num, inst->pcState(), inst->seqNum, inst->threadNumber,
+                inst->isIssued(), inst->isSquashed());
     }
-
-    cprintf("Memory dependence hash size: %i\n", memDepHash.size());
-
-#ifdef DEBUG
-    cprintf("Memory dependence entries: %i\n", MemDepEntry::memdep_count);
-#endif
 }
 
 #endif//__CPU_O3_MEM_DEP_UNIT_IMPL_HH__
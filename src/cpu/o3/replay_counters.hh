@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Replay counters of the Counter replay detection scheme.
+ */
+
+#ifndef __CPU_O3_REPLAY_COUNTERS_HH__
+#define __CPU_O3_REPLAY_COUNTERS_HH__
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "base/logging.hh"
+#include "base/types.hh"
+#include "cpu/global_utils.hh"
+
+/**
+ * The saturating counters live on the static instructions, so threads
+ * running the same code share them. This class applies the counter
+ * width and decay policy of the configuration to them, and keeps the
+ * instructions whose counter went up for periodic decay and resets.
+ *
+ * @tparam StaticInstPtr Pointer to an instruction with numReplays(),
+ * isReplayed(), incrReplays(), decrReplays(), halveReplays(),
+ * clearReplays(), _cleanRetires, _lastReplay and _lastReplayThread.
+ */
+template <class StaticInstPtr>
+class ReplayCounters
+{
+  public:
+    explicit ReplayCounters(const utils::CustomConfigs &config)
+        : maxCount((1 << config.counterSize) - 1),
+          decayPolicy(config.counterDecay),
+          cleanRetires(config.counterCleanRetires),
+          decayPeriod(config.counterDecayPeriod),
+          track(config.counterDecay == utils::DECAY_PERIODIC ||
+                config.counterResetOnSwitch)
+    {}
+
+    /**
+     * Count a squash of thread tid in the counter of si.
+     * @return False if the counter was saturated.
+     */
+    bool
+    count(ThreadID tid, const StaticInstPtr &si)
+    {
+        bool counted = si->numReplays() < maxCount;
+        if (counted)
+            si->incrReplays();
+        si->_cleanRetires = 0;
+        si->_lastReplay = clock;
+        si->_lastReplayThread = tid;
+        if (track)
+            tracked.emplace(&*si, si);
+        return counted;
+    }
+
+    /**
+     * Apply the decay policy to the counter of a retiring replayed
+     * instruction.
+     * @return True if the counter went down.
+     */
+    bool
+    retire(const StaticInstPtr &si)
+    {
+        switch (decayPolicy) {
+          case utils::DECAY_ON_RETIRE:
+            si->decrReplays();
+            return true;
+          case utils::DECAY_ON_CLEAN_RETIRES:
+            if (++si->_cleanRetires < cleanRetires)
+                return false;
+            si->_cleanRetires = 0;
+            si->decrReplays();
+            return true;
+          case utils::DECAY_PERIODIC:
+            return false;
+          default:
+            panic("Unknown counter decay policy!");
+        }
+    }
+
+    /**
+     * Count a committed instruction, halving the counters at the end of
+     * a decay period under periodic decay.
+     * @return Number of counters halved.
+     */
+    unsigned
+    commit()
+    {
+        if (++clock % decayPeriod == 0 &&
+            decayPolicy == utils::DECAY_PERIODIC) {
+            return decay();
+        }
+        return 0;
+    }
+
+    /**
+     * Halve the counters of the instructions tracked.
+     * @return Number of counters halved.
+     */
+    unsigned
+    decay()
+    {
+        unsigned halved = 0;
+        for (auto it = tracked.begin(); it != tracked.end();) {
+            if (it->second->isReplayed()) {
+                it->second->halveReplays();
+                halved++;
+            }
+            if (it->second->isReplayed())
+                ++it;
+            else
+                it = tracked.erase(it);
+        }
+        return halved;
+    }
+
+    /** Clear the counters of the instructions tracked. */
+    void
+    reset()
+    {
+        for (auto &p : tracked) {
+            p.second->clearReplays();
+            p.second->_cleanRetires = 0;
+        }
+        tracked.clear();
+    }
+
+    /** True if the replay count of si is older than a decay period. */
+    bool
+    isStale(const StaticInstPtr &si) const
+    {
+        return clock - si->_lastReplay > decayPeriod;
+    }
+
+    /** True if another thread than tid counted the last replay of si. */
+    static bool
+    isCrossThread(const StaticInstPtr &si, ThreadID tid)
+    {
+        return si->isReplayed() && si->_lastReplayThread != tid;
+    }
+
+    /** Number of instructions tracked for decay and resets. */
+    size_t numTracked() const { return tracked.size(); }
+
+  private:
+    const int32_t maxCount;
+    const utils::CounterDecay decayPolicy;
+    const uint32_t cleanRetires;
+    const uint64_t decayPeriod;
+    /** Keep the instructions whose counter went up. */
+    const bool track;
+
+    /** Instructions committed. */
+    uint64_t clock = 0;
+
+    /**
+     * Instructions whose replay counter went up, kept for periodic decay
+     * and resets only.
+     */
+    std::unordered_map<const void *, StaticInstPtr> tracked;
+};
+
+#endif // __CPU_O3_REPLAY_COUNTERS_HH__
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "cpu/o3/replay_counters.hh"
+
+namespace {
+
+struct Inst
+{
+    int32_t numReplays() { return replays; }
+    bool isReplayed() { return replays > 0; }
+    void clearReplays() { replays = 0; }
+    void incrReplays() { replays++; }
+    void decrReplays() { if (replays > 0) replays--; }
+    void halveReplays() { replays >>= 1; }
+
+    int32_t replays = 0;
+    uint64_t _lastReplay = 0;
+    uint32_t _cleanRetires = 0;
+    ThreadID _lastReplayThread = InvalidThreadID;
+};
+
+typedef std::shared_ptr<Inst> InstPtr;
+typedef ReplayCounters<InstPtr> Counters;
+
+utils::CustomConfigs
+config(utils::CounterDecay decay, bool reset_on_switch = false)
+{
+    utils::CustomConfigs c{};
+    c.counterSize = 2;
+    c.counterDecay = decay;
+    c.counterCleanRetires = 3;
+    c.counterDecayPeriod = 4;
+    c.counterResetOnSwitch = reset_on_switch;
+    return c;
+}
+
+} // anonymous namespace
+
+/** The counters stop at the largest value their width holds. */
+TEST(ReplayCountersTest, Saturation)
+{
+    Counters counters(config(utils::DECAY_ON_RETIRE));
+    auto inst = std::make_shared<Inst>();
+    for (int i = 0; i < 3; i++)
+        ASSERT_TRUE(counters.count(0, inst));
+    ASSERT_FALSE(counters.count(0, inst));
+    ASSERT_EQ(inst->replays, 3);
+}
+
+/** Every retirement of a replayed instruction takes one off. */
+TEST(ReplayCountersTest, DecayOnRetire)
+{
+    Counters counters(config(utils::DECAY_ON_RETIRE));
+    auto inst = std::make_shared<Inst>();
+    counters.count(0, inst);
+    counters.count(0, inst);
+    ASSERT_TRUE(counters.retire(inst));
+    ASSERT_EQ(inst->replays, 1);
+    // Retire-time decay has no use for the instructions.
+    ASSERT_EQ(counters.numTracked(), 0u);
+}
+
+/**
+ * The counter goes down after a number of retirements without a
+ * squash, and a squash starts the count over.
+ */
+TEST(ReplayCountersTest, DecayOnCleanRetires)
+{
+    Counters counters(config(utils::DECAY_ON_CLEAN_RETIRES));
+    auto inst = std::make_shared<Inst>();
+    counters.count(0, inst);
+    counters.count(0, inst);
+    ASSERT_FALSE(counters.retire(inst));
+    ASSERT_FALSE(counters.retire(inst));
+    counters.count(0, inst);
+    ASSERT_EQ(inst->replays, 3);
+
+    ASSERT_FALSE(counters.retire(inst));
+    ASSERT_FALSE(counters.retire(inst));
+    ASSERT_TRUE(counters.retire(inst));
+    ASSERT_EQ(inst->replays, 2);
+}
+
+/**
+ * Retirements leave the counters alone; every period of commits halves
+ * them and forgets the instructions that reach zero.
+ */
+TEST(ReplayCountersTest, DecayPeriodic)
+{
+    Counters counters(config(utils::DECAY_PERIODIC));
+    auto once = std::make_shared<Inst>();
+    auto thrice = std::make_shared<Inst>();
+    counters.count(0, once);
+    for (int i = 0; i < 3; i++)
+        counters.count(0, thrice);
+    ASSERT_FALSE(counters.retire(thrice));
+    ASSERT_EQ(thrice->replays, 3);
+    ASSERT_EQ(counters.numTracked(), 2u);
+
+    for (int i = 0; i < 3; i++)
+        ASSERT_EQ(counters.commit(), 0u);
+    ASSERT_EQ(counters.commit(), 2u);
+    ASSERT_EQ(once->replays, 0);
+    ASSERT_EQ(thrice->replays, 1);
+    ASSERT_EQ(counters.numTracked(), 1u);
+
+    for (int i = 0; i < 3; i++)
+        counters.commit();
+    ASSERT_EQ(counters.commit(), 1u);
+    ASSERT_EQ(counters.numTracked(), 0u);
+}
+
+/** A reset on a context switch clears the counters of every thread. */
+TEST(ReplayCountersTest, ResetOnSwitch)
+{
+    Counters counters(config(utils::DECAY_ON_CLEAN_RETIRES, true));
+    auto inst = std::make_shared<Inst>();
+    auto other = std::make_shared<Inst>();
+    counters.count(0, inst);
+    counters.count(0, inst);
+    counters.retire(inst);
+    counters.count(1, other);
+    ASSERT_EQ(counters.numTracked(), 2u);
+
+    counters.reset();
+    ASSERT_FALSE(inst->isReplayed());
+    ASSERT_EQ(inst->_cleanRetires, 0u);
+    ASSERT_FALSE(other->isReplayed());
+    ASSERT_EQ(counters.numTracked(), 0u);
+}
+
+/**
+ * A count is stale once a decay period passed since its last replay,
+ * and foreign to the threads that did not replay it last.
+ */
+TEST(ReplayCountersTest, StaleAndCrossThread)
+{
+    Counters counters(config(utils::DECAY_ON_RETIRE));
+    auto inst = std::make_shared<Inst>();
+    ASSERT_FALSE(Counters::isCrossThread(inst, 0));
+
+    counters.count(1, inst);
+    ASSERT_TRUE(Counters::isCrossThread(inst, 0));
+    ASSERT_FALSE(Counters::isCrossThread(inst, 1));
+
+    for (int i = 0; i < 4; i++)
+        counters.commit();
+    ASSERT_FALSE(counters.isStale(inst));
+    counters.commit();
+    ASSERT_TRUE(counters.isStale(inst));
+
+    counters.count(0, inst);
+    ASSERT_FALSE(counters.isStale(inst));
+    ASSERT_FALSE(Counters::isCrossThread(inst, 0));
+}
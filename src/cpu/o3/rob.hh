@@ -48,6 +48,7 @@
 #include "arch/registers.hh"
 #include "base/types.hh"
 #include "config/the_isa.hh"
+#include "cpu/o3/fence_waiters.hh"
 #include "enums/SMTQueuePolicy.hh"
 
 struct DerivO3CPUParams;
@@ -102,7 +103,12 @@ class ROB
     /** Takes over another CPU's thread. */
     void takeOverFrom();
 
-    void liftFences(ThreadID tid);
+    /**
+     * Lift the fences of the instructions of a thread that wait on
+     * squash buffer records up to and including record, once these
+     * records are cleared. The IQ picks the instructions up again.
+     */
+    void liftFences(ThreadID tid, InstSeqNum record);
 
     /** Function to insert an instruction into the ROB. Note that whatever
      *  calls this function must ensure that there is enough space within the
@@ -296,6 +302,9 @@ class ROB
     /** ROB List of Instructions */
     std::list<DynInstPtr> instList[Impl::MaxThreads];
 
+    /** Fenced instructions by the squash buffer record they wait on. */
+    FenceWaiters<DynInstPtr> fenceWaiters[Impl::MaxThreads];
+
     /** Number of instructions that can be squashed in a single cycle. */
     unsigned squashWidth;
 
@@ -348,6 +357,7 @@ class ROB
         Stats::Scalar robSquashSet;
         Stats::Scalar robCCMissZeroFences;
         Stats::Scalar robCCMissNonZeroFences;
+        Stats::Scalar robFencesLifted;
     } stats;
 };
 
@@ -41,6 +41,7 @@
 #ifndef __CPU_O3_ROB_IMPL_HH__
 #define __CPU_O3_ROB_IMPL_HH__
 
+#include <limits>
 #include <list>
 
 #include "base/logging.hh"
@@ -108,6 +109,7 @@ void ROB<Impl>::resetState() {
         squashedSeqNum[tid] = 0;
         doneSquashing[tid] = true;
         underShadow[tid] = false;
+        fenceWaiters[tid].clear();
     }
     numInstsInROB = 0;
 
@@ -214,6 +216,11 @@ void ROB<Impl>::insertInst(const DynInstPtr &inst) {
 
     inst->setInROB();
 
+    if (GCONFIG.liftOnClear && inst->isFenced() &&
+        inst->fenceRecord != std::numeric_limits<InstSeqNum>::max()) {
+        fenceWaiters[tid].add(inst, inst->fenceRecord);
+    }
+
     ++numInstsInROB;
     ++threadEntries[tid];
 
@@ -250,6 +257,8 @@ ROB<Impl>::retireHead(ThreadID tid)
     head_inst->clearInROB();
     head_inst->setCommitted();
 
+    fenceWaiters[tid].retire(head_inst, head_inst->fenceRecord);
+
     //Update "Global" Head of ROB
     updateHead();
 
@@ -455,10 +464,8 @@ void ROB<Impl>::updateTail() {
 }
 
 template <class Impl>
-void ROB<Impl>::liftFences(ThreadID tid) {
-    for (auto &inst : instList[tid]) {
-        inst->liftFence();
-    }
+void ROB<Impl>::liftFences(ThreadID tid, InstSeqNum record) {
+    stats.robFencesLifted += fenceWaiters[tid].lift(record);
 }
 
 template <class Impl>
@@ -497,6 +504,8 @@ void ROB<Impl>::updateVPStatus() {
         for (auto inst : instList[tid]) {
             if (!underShadow[tid] && !inst->isReachedVP()) {
                 inst->setReachedVP();
+                if (inst->isDeferredTouch() && !inst->isSquashed())
+                    cpu->touchDeferred(inst);
             }
 
             if (checkShadow(inst)) {
@@ -555,6 +564,9 @@ void ROB<Impl>::squash(InstSeqNum squash_num, ThreadID tid) {
 
     squashedSeqNum[tid] = squash_num;
 
+    // Squashed waiters would hold up the retirement of their record.
+    fenceWaiters[tid].squash(squash_num);
+
     if (!instList[tid].empty()) {
         InstIt tail_thread = instList[tid].end();
         tail_thread--;
@@ -597,7 +609,9 @@ ROB<Impl>::ROBStats::ROBStats(Stats::Group *parent)
       ADD_STAT(robCCMissZeroFences,
                "Number of times Counter Cache miss with zero counter in ROB"),
       ADD_STAT(robCCMissNonZeroFences,
-               "Number of times Counter Cache miss with non zero counter in ROB")
+               "Number of times Counter Cache miss with non zero counter in ROB"),
+      ADD_STAT(robFencesLifted,
+               "Number of fences lifted as their squash buffer record cleared")
 {
 }
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Sharing of the replay detection structures between SMT threads, see
+ * smtReplayDetPolicy.
+ */
+
+#ifndef __CPU_O3_SMT_REPLAY_DET_HH__
+#define __CPU_O3_SMT_REPLAY_DET_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+#include "enums/SMTQueuePolicy.hh"
+
+namespace SMTReplayDet
+{
+
+/**
+ * Epoch records one of threads threads may hold out of total, as
+ * smtROBPolicy caps the ROB entries of a thread: total/threads when
+ * Partitioned, threshold percent of total when Threshold and all of
+ * them when Dynamic.
+ */
+inline size_t
+recordCap(size_t total, ThreadID threads, SMTQueuePolicy policy,
+          unsigned threshold)
+{
+    if (threads <= 1)
+        return total;
+    switch (policy) {
+      case SMTQueuePolicy::Partitioned:
+        return std::max<size_t>(1, total / threads);
+      case SMTQueuePolicy::Threshold:
+        return std::max<size_t>(1,
+            std::min<size_t>(total, total * threshold / 100));
+      default:
+        return total;
+    }
+}
+
+/**
+ * Elements the filters of a thread are sized for. A thread that may
+ * hold cap of the total records sees that share of the squashes the
+ * filters were sized for; the filters cannot grow at run time.
+ */
+inline size_t
+filterElems(size_t elems, size_t total, size_t cap)
+{
+    if (cap >= total)
+        return elems;
+    return std::max<size_t>(1, elems * cap / total);
+}
+
+/** True if the threads share a single counter cache. */
+inline bool
+sharedCounterCache(ThreadID threads, SMTQueuePolicy policy)
+{
+    return threads > 1 && policy != SMTQueuePolicy::Partitioned;
+}
+
+/** Sets of the counter cache of each thread. */
+inline size_t
+counterCacheSets(size_t sets, ThreadID threads, SMTQueuePolicy policy)
+{
+    if (threads <= 1 || sharedCounterCache(threads, policy))
+        return sets;
+    return std::max<size_t>(1, sets / threads);
+}
+
+} // namespace SMTReplayDet
+
+/**
+ * Storage budget the squash buffers of the SMT threads of a CPU share,
+ * following smtReplayDetPolicy as the ROB follows smtROBPolicy. Each
+ * thread may use up to perThread() entries or records, and all of them
+ * together up to total().
+ *
+ * @tparam SquashBuffer Squash buffer with used().
+ */
+template <class SquashBuffer>
+class SquashBufferBudget {
+   public:
+    SquashBufferBudget(size_t total, size_t per_thread)
+        : _total(total), _per_thread(per_thread) {}
+
+    void add(const SquashBuffer *sb) { _members.push_back(sb); }
+
+    size_t total() const { return _total; }
+    size_t perThread() const { return _per_thread; }
+
+    size_t used() const {
+        size_t n = 0;
+        for (auto sb : _members)
+            n += sb->used();
+        return n;
+    }
+
+    /** True if sb has no room for another record. */
+    bool full(const SquashBuffer *sb) const {
+        return sb->used() >= _per_thread || used() >= _total;
+    }
+
+    /** True if only the other members keep sb from growing. */
+    bool crowdedOut(const SquashBuffer *sb) const {
+        return sb->used() < _per_thread && used() >= _total;
+    }
+
+   private:
+    size_t _total;
+    size_t _per_thread;
+    std::vector<const SquashBuffer *> _members;
+};
+
+#endif // __CPU_O3_SMT_REPLAY_DET_HH__
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "cpu/o3/smt_replay_det.hh"
+
+namespace {
+
+struct Buffer
+{
+    size_t used() const { return records; }
+    size_t records = 0;
+};
+
+} // anonymous namespace
+
+/** Epoch record caps follow smtROBPolicy. */
+TEST(SMTReplayDetTest, RecordCap)
+{
+    using namespace SMTReplayDet;
+    EXPECT_EQ(recordCap(8, 2, SMTQueuePolicy::Partitioned, 100), 4u);
+    EXPECT_EQ(recordCap(8, 3, SMTQueuePolicy::Partitioned, 100), 2u);
+    EXPECT_EQ(recordCap(2, 4, SMTQueuePolicy::Partitioned, 100), 1u);
+    EXPECT_EQ(recordCap(8, 2, SMTQueuePolicy::Dynamic, 100), 8u);
+    EXPECT_EQ(recordCap(8, 2, SMTQueuePolicy::Threshold, 75), 6u);
+    EXPECT_EQ(recordCap(8, 2, SMTQueuePolicy::Threshold, 1), 1u);
+    EXPECT_EQ(recordCap(8, 2, SMTQueuePolicy::Threshold, 150), 8u);
+    // A single thread holds all of them whatever the policy.
+    EXPECT_EQ(recordCap(8, 1, SMTQueuePolicy::Partitioned, 100), 8u);
+}
+
+/** The filters of a thread are sized for its share of the records. */
+TEST(SMTReplayDetTest, FilterElems)
+{
+    using namespace SMTReplayDet;
+    EXPECT_EQ(filterElems(1000, 8, 8), 1000u);
+    EXPECT_EQ(filterElems(1000, 8, 4), 500u);
+    EXPECT_EQ(filterElems(1000, 8, 6), 750u);
+    EXPECT_EQ(filterElems(3, 8, 1), 1u);
+
+    // Dynamic keeps the filters whole, Partitioned splits them.
+    size_t cap = recordCap(8, 2, SMTQueuePolicy::Dynamic, 100);
+    EXPECT_EQ(filterElems(1000, 8, cap), 1000u);
+    cap = recordCap(8, 2, SMTQueuePolicy::Partitioned, 100);
+    EXPECT_EQ(filterElems(1000, 8, cap), 500u);
+}
+
+/** Only Partitioned splits the counter cache between threads. */
+TEST(SMTReplayDetTest, CounterCache)
+{
+    using namespace SMTReplayDet;
+    EXPECT_FALSE(sharedCounterCache(2, SMTQueuePolicy::Partitioned));
+    EXPECT_EQ(counterCacheSets(64, 2, SMTQueuePolicy::Partitioned), 32u);
+    EXPECT_EQ(counterCacheSets(1, 2, SMTQueuePolicy::Partitioned), 1u);
+
+    EXPECT_TRUE(sharedCounterCache(2, SMTQueuePolicy::Dynamic));
+    EXPECT_EQ(counterCacheSets(64, 2, SMTQueuePolicy::Dynamic), 64u);
+    EXPECT_TRUE(sharedCounterCache(4, SMTQueuePolicy::Threshold));
+    EXPECT_EQ(counterCacheSets(64, 4, SMTQueuePolicy::Threshold), 64u);
+
+    EXPECT_FALSE(sharedCounterCache(1, SMTQueuePolicy::Dynamic));
+    EXPECT_EQ(counterCacheSets(64, 1, SMTQueuePolicy::Partitioned), 64u);
+}
+
+/** A thread is held back by its cap or by the records of the others. */
+TEST(SMTReplayDetTest, Budget)
+{
+    SquashBufferBudget<Buffer> budget(8, 6);
+    Buffer a, b;
+    budget.add(&a);
+    budget.add(&b);
+
+    a.records = 5;
+    EXPECT_EQ(budget.used(), 5u);
+    EXPECT_FALSE(budget.full(&a));
+    a.records = 6;
+    EXPECT_TRUE(budget.full(&a));
+    EXPECT_FALSE(budget.crowdedOut(&a));
+
+    // b is below its cap but the records run out.
+    b.records = 2;
+    EXPECT_EQ(budget.used(), 8u);
+    EXPECT_TRUE(budget.full(&b));
+    EXPECT_TRUE(budget.crowdedOut(&b));
+
+    a.records = 3;
+    EXPECT_FALSE(budget.full(&b));
+    EXPECT_FALSE(budget.crowdedOut(&b));
+}
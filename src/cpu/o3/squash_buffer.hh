@@ -17,6 +17,8 @@
 #include "cpu/o3/bloom_filter.hh"
 #include "cpu/o3/counting.hh"
 #include "cpu/o3/hash.hh"
+#include "cpu/o3/hybrid_squash_record.hh"
+#include "cpu/o3/smt_replay_det.hh"
 
 struct DerivO3CPUParams;
 template <class Impl>
@@ -43,9 +45,47 @@ class BaseSquashBuffer {
     virtual void insert(DynInstPtr inst) = 0;
     virtual void retire(DynInstPtr inst) = 0;
 
+    /** Entries (Clear-on-Retire) or records (Epoch) in use. */
+    virtual size_t used() const = 0;
+
+    typedef SquashBufferBudget<BaseSquashBuffer<Impl>> Budget;
+
+    /** Share a budget with the squash buffers of the other threads. */
+    void setBudget(const std::shared_ptr<Budget> &budget) {
+        _budget = budget;
+        _budget->add(this);
+    }
+
+    /**
+     * Record whose entries made the last check() return true, or the
+     * maximum InstSeqNum if no clear lifts the fence before the VP.
+     */
+    InstSeqNum hitRecord() const { return _hit_record; }
+
+    /**
+     * Newest record released by the last clear() that returned true.
+     * Records are numbered so that a clear releases all older ones too.
+     */
+    InstSeqNum clearedRecord() const { return _cleared_record; }
+
    protected:
     O3CPU *_cpu;
     size_t _max_size;
+    InstSeqNum _hit_record = 0;
+    InstSeqNum _cleared_record = 0;
+    std::shared_ptr<Budget> _budget;
+
+    /** True if there is no room for another entry or record. */
+    bool overBudget(size_t max_used) const {
+        if (!_budget)
+            return used() >= max_used;
+        return _budget->full(this);
+    }
+
+    /** True if only the other threads keep this one from growing. */
+    bool crowdedOut() const {
+        return _budget && _budget->crowdedOut(this);
+    }
 
     // Stats
     Stats::Scalar SBChecks;
@@ -54,6 +94,8 @@ class BaseSquashBuffer {
     Stats::Scalar SBHits;
     Stats::Scalar SBMisses;
     Stats::Scalar SBOverflows;
+    Stats::Scalar SBSharedOverflows;
+    Stats::Scalar SBSpills;
     Stats::Scalar FFalsePositives;
     Stats::Scalar FFalseNegatives;
     Stats::Scalar SBSeqChange;
@@ -64,6 +106,11 @@ class BaseSquashBuffer {
         return _cpu->name() + ".squashBuffer";
     }
 
+    /** Projected element count of the filter behind a Hybrid CAM. */
+    static long long hybridFilterElems(long long elem_cnt) {
+        return std::max(1LL, elem_cnt - (long long)GCONFIG.sbCAMEntries);
+    }
+
     void regStats() {
         SBChecks
             .name(name() + ".SBChecks")
@@ -93,6 +140,16 @@ class BaseSquashBuffer {
             .name(name() + ".SBOverflows")
             .desc("Number of SB overflows");
 
+        SBSharedOverflows
+            .name(name() + ".SBSharedOverflows")
+            .desc("Number of SB overflows while other SMT threads held the "
+                  "shared budget");
+
+        SBSpills
+            .name(name() + ".SBSpills")
+            .desc("Number of insertions that spilled from the CAM into "
+                  "the filter of a Hybrid SB");
+
         SBInserts
             .name(name() + ".SBInserts")
             .desc("Number of times the a value was inserted in the SB");
@@ -120,8 +177,9 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
 
     SimpleSquashBuffer(O3CPU *cpu, size_t max_size, long long elem_cnt) : BaseSquashBuffer<Impl>(cpu, max_size) {
         _bloom = GCONFIG.sbHW == utils::BLOOM;
-        if (_bloom) {
-            _parameters.projected_element_count = elem_cnt;  //
+        _hybrid = GCONFIG.sbHW == utils::HYBRID;
+        if (_bloom || _hybrid) {
+            _parameters.projected_element_count = elem_cnt;
             _parameters.false_positive_probability = 0.01;   // 1 in 100
             _parameters.random_seed = 0xA5A5A5A5;            // repeatable results
 
@@ -131,7 +189,23 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
 
             _parameters.compute_optimal_parameters();
 
-            blfilter = new bloom_filter(_parameters);
+            if (_hybrid) {
+                // A hybrid buffer takes the bits of the Bloom filter it
+                // replaces. The CAM absorbs the first PCs and the filter
+                // behind it gets the bits the CAM leaves.
+                size_t cells = HybridSquashRecord::filterCells(
+                    _parameters.optimal_parameters.table_size,
+                    GCONFIG.sbCAMEntries, 1, false, 1);
+                size_t hashes = HybridSquashRecord::filterHashes(
+                    cells, this->hybridFilterElems(elem_cnt));
+                _hybridSB.reset(new HybridSquashRecord(
+                    GCONFIG.sbCAMEntries, hashes, cells, 1, false));
+                std::cerr << "Hybrid CAM entries: " << GCONFIG.sbCAMEntries
+                          << ", filter cells: " << cells
+                          << ", filter hashes: " << hashes << std::endl;
+            } else {
+                blfilter = new bloom_filter(_parameters);
+            }
 
             std::cerr << "Bloom Filter projected element count: "
                       << _parameters.projected_element_count << std::endl;
@@ -144,11 +218,13 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
         }
     }
 
+    size_t used() const override { return _sb.size(); }
+
     bool full() const override {
-        if (_bloom)
+        if (_bloom || _hybrid)
             return false;
         else
-            return _sb.size() >= this->_max_size;
+            return this->overBudget(this->_max_size);
     }
 
     bool check(DynInstPtr inst) override {
@@ -160,11 +236,17 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
             if (ret != ret2) {
                 this->FFalsePositives++;
             }
+        } else if (_hybrid) {
+            ret = _hybridSB->contains(inst_addr);
+            if (ret && _sb.find(inst_addr) == _sb.end()) {
+                this->FFalsePositives++;
+            }
         } else {
             ret = _sb.find(inst_addr) != _sb.end();
         }
         if (ret) {
             this->SBHits++;
+            this->_hit_record = _generation;
         } else {
             this->SBMisses++;
         }
@@ -180,8 +262,11 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
 
             if (_bloom) {
                 blfilter->clear();
+            } else if (_hybrid) {
+                _hybridSB->clear();
             }
             _sb.clear();
+            this->_cleared_record = _generation++;
             this->SBClears++;
             return true;
         } else {
@@ -191,8 +276,11 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
                 _oldest_sq_src = std::numeric_limits<InstSeqNum>::max();
                 if (_bloom) {
                     blfilter->clear();
+                } else if (_hybrid) {
+                    _hybridSB->clear();
                 }
                 _sb.clear();
+                this->_cleared_record = _generation++;
                 this->SBClears++;
                 this->SBSeqChange++;
                 return true;
@@ -214,6 +302,11 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
         if (_bloom) {
             blfilter->insert(inst_addr);
             _sb.insert(inst_addr);
+        } else if (_hybrid) {
+            if (!_hybridSB->insert(inst_addr)) {
+                this->SBSpills++;
+            }
+            _sb.insert(inst_addr);
         } else {
             _sb.insert(inst_addr);
         }
@@ -227,10 +320,14 @@ class SimpleSquashBuffer : public BaseSquashBuffer<Impl> {
    private:
     std::unordered_set<Addr> _sb;
     InstSeqNum _oldest_sq_src = std::numeric_limits<InstSeqNum>::max();
+    /** Number of the current contents, bumped on every clear. */
+    InstSeqNum _generation = 0;
 
     bool _bloom;
+    bool _hybrid;
     bloom_parameters _parameters;
     bloom_filter *blfilter;
+    std::unique_ptr<HybridSquashRecord> _hybridSB;
 };
 
 template <class Impl>
@@ -244,8 +341,9 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
     EpochSquashBuffer(O3CPU *cpu, size_t max_size, size_t max_active, long long elem_cnt)
         : BaseSquashBuffer<Impl>(cpu, max_size), _max_active(max_active), _elems(elem_cnt),
         _max_counter((1 << GCONFIG.counterSize) - 1) {
-        if (GCONFIG.sbHW == utils::BLOOM || GCONFIG.sbHW == utils::COUNTING_BLOOM) {
-            _parameters.projected_element_count = elem_cnt;  //
+        if (GCONFIG.sbHW == utils::BLOOM || GCONFIG.sbHW == utils::COUNTING_BLOOM ||
+            GCONFIG.sbHW == utils::HYBRID) {
+            _parameters.projected_element_count = elem_cnt;
             _parameters.false_positive_probability = 0.01;   // 1 in 100
             _parameters.random_seed = 0xA5A5A5A5;            // repeatable results
 
@@ -272,6 +370,25 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                 std::cerr << "Bloom Filter table size: "
                           << _parameters.optimal_parameters.table_size << std::endl;
             }
+            if (GCONFIG.sbHW == utils::HYBRID) {
+                // A hybrid record takes the bits of a CountingBloom record,
+                // table_size counters. The CAM absorbs the first PCs and the
+                // filter behind it gets the bits the CAM leaves; a record
+                // that never deletes has neither counters in its CAM nor in
+                // its filter.
+                _hybridCells = HybridSquashRecord::filterCells(
+                    _parameters.optimal_parameters.table_size *
+                        GCONFIG.counterSize,
+                    GCONFIG.sbCAMEntries, GCONFIG.counterSize,
+                    GCONFIG.deleteOnRetire,
+                    GCONFIG.deleteOnRetire ? GCONFIG.counterSize : 1);
+                _hybridHashes = HybridSquashRecord::filterHashes(
+                    _hybridCells, this->hybridFilterElems(elem_cnt));
+                std::cerr << "Hybrid CAM entries: " << GCONFIG.sbCAMEntries
+                          << ", filter cells: " << _hybridCells
+                          << ", filter hashes: " << _hybridHashes
+                          << std::endl;
+            }
         }
 
         uint _bucket = (uint)max_active / 10;
@@ -291,27 +408,33 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
             .desc("Number of counter overflows");
     }
 
-    bool full() const override {
+    size_t used() const override {
         switch (GCONFIG.sbHW) {
             case utils::BLOOM:
-                return _bf.size() >= _max_active;
-                break;
+                return _bf.size();
             case utils::COUNTING_BLOOM:
-                return _cbf.size() >= _max_active;
-                break;
+                return _cbf.size();
+            case utils::HYBRID:
+                return _hb.size();
             case utils::IDEAL:
-                return _sb.size() >= _max_active;
-                break;
+                return _sb.size();
             default:
                 panic("Unknown SB structure!");
         }
     }
 
+    bool full() const override {
+        return this->overBudget(_max_active);
+    }
+
     bool check(DynInstPtr inst) override {
         Addr inst_addr = inst->instAddr();
         auto epochID = inst->epochID;
         bool found = false, found_set = false;
         bool hitFilter = false;
+        // With all records checked, a fence waits for the newest
+        // record that holds the PC to clear
+        InstSeqNum record = GCONFIG.checkAllRecords ? 0 : epochID;
 
         if (GCONFIG.checkAllRecords) {
             for (auto &p : _sb) {
@@ -338,7 +461,7 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     for (auto &p : _bf) {
                         if (p.second->contains(inst_addr)) {
                             found = true;
-                            break;
+                            record = std::max(record, p.first);
                         }
                     }
                 } else {
@@ -355,7 +478,7 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     for (auto &p : _cbf) {
                         if (p.second->lookup(inst_addr) > 0) {
                             found = true;
-                            break;
+                            record = std::max(record, p.first);
                         }
                     }
                 } else {
@@ -366,6 +489,23 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     hitFilter = IN_MAP(epochID, _cbf);
                 }
                 break;
+            case utils::HYBRID:
+                activeRecords.sample(_hb.size());
+                if (GCONFIG.checkAllRecords) {
+                    for (auto &p : _hb) {
+                        if (p.second->contains(inst_addr)) {
+                            found = true;
+                            record = std::max(record, p.first);
+                        }
+                    }
+                } else {
+                    if (IN_MAP(epochID, _hb) &&
+                        _hb.at(epochID)->contains(inst_addr)) {
+                        found = true;
+                    }
+                    hitFilter = IN_MAP(epochID, _hb);
+                }
+                break;
             case utils::IDEAL:
                 activeRecords.sample(_sb.size());
                 if (GCONFIG.checkAllRecords) {
@@ -377,7 +517,7 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                                 _counterOverflowBuffer.at(p.first).at(inst_addr) > 0) {
 
                                 found = true;
-                                break;
+                                record = std::max(record, p.first);
                             }
                         }
                     }
@@ -410,19 +550,30 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
         else if (!found && found_set)
             this->FFalseNegatives++;
 
+        bool fence;
         if (_ar_overflowed && !hitFilter) {
             // if AR overflows and we do not find a record in SB,
             // then we fence it if epochID <= _overflow_epoch
-            return epochID <= _overflowed_epoch;
+            record = _overflowed_epoch;
+            fence = epochID <= _overflowed_epoch;
         }
         else {
-            return found;
+            fence = found;
         }
+
+        // The retirement of the first instruction of an epoch clears
+        // the records of the epochs before it. The record of the epoch
+        // of inst, or of a newer one, is only cleared after inst has
+        // retired, so the fence lasts until the VP.
+        this->_hit_record = record < epochID ? record :
+            std::numeric_limits<InstSeqNum>::max();
+        return fence;
     }
 
     bool clear(DynInstPtr inst) override {
         auto epochID = inst->epochID - 1;  // clear prev epochs
         CSPRINT(Try2Clear, inst, "clearing epoch <= $lli\n", epochID);
+        this->_cleared_record = epochID;
 
         if (epochID >= _overflowed_epoch) {
             _overflowed_epoch = 0;
@@ -454,6 +605,17 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     _cbf.erase(k);
                 }
                 break;
+            case utils::HYBRID:
+                for (auto &p : _hb) {
+                    if (epochID >= p.first) {
+                        toErase.emplace_back(p.first);
+                    }
+                }
+                for (auto k : toErase) {
+                    _hb.erase(k);
+                }
+                this->SBClears += toErase.size();
+                break;
             case utils::IDEAL:
                 for (auto &p : _counterOverflowBuffer) {
                     if (epochID >= p.first) {
@@ -494,6 +656,9 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
             case utils::COUNTING_BLOOM:
                 return !IN_MAP(epochID, _cbf);
                 break;
+            case utils::HYBRID:
+                return !IN_MAP(epochID, _hb);
+                break;
             case utils::IDEAL:
                 return !IN_MAP(epochID, _sb);
                 break;
@@ -510,6 +675,8 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
 
         if (full() && needsNewEntry(epochID)) {
             this->SBOverflows++;
+            if (this->crowdedOut())
+                this->SBSharedOverflows++;
             _ar_overflowed = true;
             _overflowed_epoch = std::max(_overflowed_epoch, epochID);
             return;
@@ -550,6 +717,16 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     _cbf[inst->epochID]->add(inst->instAddr());
                 }
                 break;
+            case utils::HYBRID:
+                if (!IN_MAP(inst->epochID, _hb)) {
+                    _hb[inst->epochID].reset(new HybridSquashRecord(
+                        GCONFIG.sbCAMEntries, _hybridHashes, _hybridCells,
+                        GCONFIG.counterSize, GCONFIG.deleteOnRetire));
+                }
+                if (!_hb.at(inst->epochID)->insert(inst->instAddr())) {
+                    this->SBSpills++;
+                }
+                break;
             case utils::IDEAL:
                 warn_once("Ideal is checking counter saturation; added for rebuttal");
                 if (IN_MAP(inst->epochID, _sb)) {
@@ -582,6 +759,13 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
                     SBRetireDeletions++;
                 }
                 break;
+            case utils::HYBRID:
+                if (IN_MAP(epochID, _hb) &&
+                    _hb.at(epochID)->contains(inst->instAddr())) {
+                    _hb.at(epochID)->remove(inst->instAddr());
+                    SBRetireDeletions++;
+                }
+                break;
             case utils::IDEAL:
                 if (IN_MAP(epochID, _sb) && IN_MAP(inst->instAddr(), _sb.at(epochID)) &&
                     IN_MAP(epochID, _counterOverflowBuffer) &&
@@ -619,8 +803,12 @@ class EpochSquashBuffer : public BaseSquashBuffer<Impl> {
     std::unordered_map<uint64_t, SquashBuffer> _counterOverflowBuffer;
     std::unordered_map<uint64_t, bloom_filter *> _bf;
     std::unordered_map<uint64_t, counting_bloom_filter *> _cbf;
+    std::unordered_map<uint64_t, std::unique_ptr<HybridSquashRecord>> _hb;
 
     bloom_parameters _parameters;
+    /** Filter geometry of the Hybrid records. */
+    size_t _hybridCells = 1;
+    size_t _hybridHashes = 1;
     uint64_t _overflowed_epoch = 0;
     bool _ar_overflowed = false;
 
@@ -226,7 +226,7 @@ StoreSet::insertStore(Addr store_PC, InstSeqNum store_seq_num, ThreadID tid)
 
         validLFST[store_SSID] = 1;
 
-        storeList[store_seq_num] = store_SSID;
+        storeList.push_back({store_seq_num, SSID(store_SSID), false});
 
         DPRINTF(StoreSet, "Store %#x updated the LFST, SSID: %i\n",
                 store_PC, store_SSID);
@@ -282,10 +282,11 @@ StoreSet::issued(Addr issued_PC, InstSeqNum issued_seq_num, bool is_store)
 
     assert(index < SSITSize);
 
-    SeqNumMapIt store_list_it = storeList.find(issued_seq_num);
-
-    if (store_list_it != storeList.end()) {
-        storeList.erase(store_list_it);
+    size_t pos = storeList.find(issued_seq_num);
+    if (pos != storeList.size()) {
+        storeList[pos].issued = true;
+        while (!storeList.empty() && storeList.front().issued)
+            storeList.pop_front();
     }
 
     // Make sure the SSIT still has a valid entry for the issued store.
@@ -311,27 +312,16 @@ StoreSet::squash(InstSeqNum squashed_num, ThreadID tid)
     DPRINTF(StoreSet, "StoreSet: Squashing until inum %i\n",
             squashed_num);
 
-    int idx;
-    SeqNumMapIt store_list_it = storeList.begin();
-
     //@todo:Fix to only delete from correct thread
-    while (!storeList.empty()) {
-        idx = (*store_list_it).second;
-
-        if ((*store_list_it).first <= squashed_num) {
-            break;
-        }
+    while (!storeList.empty() && storeList.back().seqNum > squashed_num) {
+        const StoreEntry &store = storeList.back();
+        SSID idx = store.ssid;
 
-        bool younger = LFST[idx] > squashed_num;
-
-        if (validLFST[idx] && younger) {
+        if (!store.issued && validLFST[idx] && LFST[idx] > squashed_num) {
             DPRINTF(StoreSet, "Squashed [sn:%lli]\n", LFST[idx]);
             validLFST[idx] = false;
-
-            storeList.erase(store_list_it++);
-        } else if (!validLFST[idx] && younger) {
-            storeList.erase(store_list_it++);
         }
+        storeList.pop_back();
     }
 }
 
@@ -353,14 +343,10 @@ void
 StoreSet::dump()
 {
     cprintf("storeList.size(): %i\n", storeList.size());
-    SeqNumMapIt store_list_it = storeList.begin();
-
-    int num = 0;
 
-    while (store_list_it != storeList.end()) {
-        cprintf("%i: [sn:%lli] SSID:%i\n",
-                num, (*store_list_it).first, (*store_list_it).second);
-        num++;
-        store_list_it++;
+    for (size_t num = 0; num < storeList.size(); num++) {
+        const StoreEntry &store = storeList[num];
+        cprintf("%i: [sn:%lli] SSID:%i%s\n", num, store.seqNum, store.ssid,
+                store.issued ? " (issued)" : "");
     }
 }
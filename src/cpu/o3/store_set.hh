@@ -30,19 +30,12 @@
 #define __CPU_O3_STORE_SET_HH__
 
 #include <list>
-#include <map>
 #include <utility>
 #include <vector>
 
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
-
-struct ltseqnum {
-    bool operator()(const InstSeqNum &lhs, const InstSeqNum &rhs) const
-    {
-        return lhs > rhs;
-    }
-};
+#include "cpu/o3/age_ring.hh"
 
 /**
  * Implements a store set predictor for determining if memory
@@ -127,12 +120,18 @@ class StoreSet
     /** Bit vector to tell if the LFST has a valid entry. */
     std::vector<bool> validLFST;
 
-    /** Map of stores that have been inserted into the store set, but
-     * not yet issued or squashed.
-     */
-    std::map<InstSeqNum, int, ltseqnum> storeList;
+    /** A store that has been inserted into the store set. */
+    struct StoreEntry {
+        InstSeqNum seqNum = 0;
+        SSID ssid = 0;
+        /** Issued stores are only kept until the older ones leave. */
+        bool issued = false;
+    };
 
-    typedef std::map<InstSeqNum, int, ltseqnum>::iterator SeqNumMapIt;
+    /** Stores that have been inserted into the store set, but not yet
+     * issued or squashed, oldest first.
+     */
+    AgeRing<StoreEntry> storeList;
 
     /** Number of loads/stores to process before wiping predictor so all
      * entries don't get saturated
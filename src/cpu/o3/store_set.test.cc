@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "cpu/o3/store_set.hh"
+
+namespace {
+
+// Two store sets, each of one load and one store.
+const Addr LoadA = 0x100, StoreA = 0x200;
+const Addr LoadB = 0x104, StoreB = 0x204;
+
+StoreSet
+twoSets()
+{
+    StoreSet ss(1000000, 1024, 1024);
+    ss.violation(StoreA, LoadA);
+    ss.violation(StoreB, LoadB);
+    return ss;
+}
+
+} // anonymous namespace
+
+/** Loads depend on the youngest fetched store of their set. */
+TEST(StoreSetTest, YoungestStore)
+{
+    StoreSet ss = twoSets();
+    EXPECT_EQ(ss.checkInst(LoadA), 0u);
+
+    ss.insertStore(StoreA, 10, 0);
+    ss.insertStore(StoreB, 11, 0);
+    ss.insertStore(StoreA, 12, 0);
+    EXPECT_EQ(ss.checkInst(LoadA), 12u);
+    EXPECT_EQ(ss.checkInst(LoadB), 11u);
+
+    // Only the issue of the youngest store ends the dependence.
+    ss.issued(StoreA, 10, true);
+    EXPECT_EQ(ss.checkInst(LoadA), 12u);
+    ss.issued(StoreA, 12, true);
+    EXPECT_EQ(ss.checkInst(LoadA), 0u);
+    EXPECT_EQ(ss.checkInst(LoadB), 11u);
+}
+
+/** A squash ends the dependences on the squashed stores only. */
+TEST(StoreSetTest, Squash)
+{
+    StoreSet ss = twoSets();
+    ss.insertStore(StoreA, 10, 0);
+    ss.insertStore(StoreB, 12, 0);
+
+    ss.squash(11, 0);
+    EXPECT_EQ(ss.checkInst(LoadA), 10u);
+    EXPECT_EQ(ss.checkInst(LoadB), 0u);
+
+    // The set of the squashed store is used again on the correct path.
+    ss.insertStore(StoreB, 13, 0);
+    EXPECT_EQ(ss.checkInst(LoadB), 13u);
+}
+
+/**
+ * Stores issued out of order leave the list once the older ones have
+ * issued, and squashing one that has issued keeps the dependences of
+ * the older stores.
+ */
+TEST(StoreSetTest, OutOfOrderIssue)
+{
+    StoreSet ss = twoSets();
+    ss.insertStore(StoreA, 10, 0);
+    ss.insertStore(StoreB, 12, 0);
+    ss.insertStore(StoreA, 14, 0);
+
+    ss.issued(StoreB, 12, true);
+    EXPECT_EQ(ss.checkInst(LoadB), 0u);
+    EXPECT_EQ(ss.checkInst(LoadA), 14u);
+
+    ss.squash(11, 0);
+    EXPECT_EQ(ss.checkInst(LoadA), 0u);
+
+    ss.insertStore(StoreA, 15, 0);
+    ss.issued(StoreA, 10, true);
+    EXPECT_EQ(ss.checkInst(LoadA), 15u);
+    ss.issued(StoreA, 15, true);
+    EXPECT_EQ(ss.checkInst(LoadA), 0u);
+
+    // Squashing past everything finds nothing left to squash.
+    ss.squash(0, 0);
+    EXPECT_EQ(ss.checkInst(LoadA), 0u);
+}
@@ -143,6 +143,15 @@ class TAGEBase(SimObject):
     speculativeHistUpdate = Param.Bool(True,
         "Use speculative update for histories")
 
+    fullPCIndex = Param.Bool(False,
+        "Hash all the bits of the shifted branch PC into the table indices "
+        "instead of the low 32, so that branches 16GB apart do not alias "
+        "in tables large enough to take index bits from above bit 31")
+
+    indexCheck = Param.Bool(False,
+        "Also compute the table indices and tags one table at a time, "
+        "panicking if they differ from the batched ones")
+
 # TAGE branch predictor as described in https://www.jilp.org/vol8/v8paper1.pdf
 # The default sizes below are for the 8C-TAGE configuration (63.5 Kbits)
 class TAGE(BranchPredictor):
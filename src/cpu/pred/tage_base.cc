@@ -63,6 +63,8 @@ TAGEBase::TAGEBase(const TAGEBaseParams *p)
      noSkip(p->noSkip),
      speculativeHistUpdate(p->speculativeHistUpdate),
      instShiftAmt(p->instShiftAmt),
+     fullPCIndex(p->fullPCIndex),
+     indexCheck(p->indexCheck),
      initialized(false),
      stats(this, nHistoryTables)
 {
@@ -138,6 +140,12 @@ TAGEBase::init()
 
     tableIndices = new int [nHistoryTables+1];
     tableTags = new int [nHistoryTables+1];
+
+    indexer.init(nHistoryTables, logTagTableSizes, tagTableTagWidths,
+                 histLengths, pathHistBits, instShiftAmt, fullPCIndex);
+    lookupCompIndices.resize(nHistoryTables+1, 0);
+    lookupCompTags[0].resize(nHistoryTables+1, 0);
+    lookupCompTags[1].resize(nHistoryTables+1, 0);
     initialized = true;
 }
 
@@ -159,8 +167,15 @@ TAGEBase::initFoldedHistories(ThreadHistory & history)
 void
 TAGEBase::buildTageTables()
 {
+    // All the tagged tables share one contiguous allocation
+    size_t entries = 0;
+    for (int i = 1; i <= nHistoryTables; i++) {
+        entries += ULL(1) << logTagTableSizes[i];
+    }
+    TageEntry *storage = new TageEntry[entries];
     for (int i = 1; i <= nHistoryTables; i++) {
-        gtable[i] = new TageEntry[1<<(logTagTableSizes[i])];
+        gtable[i] = storage;
+        storage += ULL(1) << logTagTableSizes[i];
     }
 }
 
@@ -226,7 +241,8 @@ TAGEBase::gindex(ThreadID tid, Addr pc, int bank) const
     int index;
     int hlen = (histLengths[bank] > pathHistBits) ? pathHistBits :
                                                     histLengths[bank];
-    const unsigned int shiftedPc = pc >> instShiftAmt;
+    const Addr shiftedPc = fullPCIndex ? pc >> instShiftAmt :
+                                         (unsigned int) (pc >> instShiftAmt);
     index =
         shiftedPc ^
         (shiftedPc >> ((int) abs(logTagTableSizes[bank] - bank) + 1)) ^
@@ -334,11 +350,27 @@ void
 TAGEBase::calculateIndicesAndTags(ThreadID tid, Addr branch_pc,
                                   BranchInfo* bi)
 {
+    const ThreadHistory &tHist = threadHistory[tid];
+    for (int i = 1; i <= nHistoryTables; i++) {
+        lookupCompIndices[i] = tHist.computeIndices[i].comp;
+        lookupCompTags[0][i] = tHist.computeTags[0][i].comp;
+        lookupCompTags[1][i] = tHist.computeTags[1][i].comp;
+    }
+
     // computes the table addresses and the partial tags
+    indexer.compute(branch_pc, tHist.pathHist, lookupCompIndices.data(),
+                    lookupCompTags[0].data(), lookupCompTags[1].data(),
+                    tableIndices, tableTags);
     for (int i = 1; i <= nHistoryTables; i++) {
-        tableIndices[i] = gindex(tid, branch_pc, i);
+        if (indexCheck) {
+            int index = gindex(tid, branch_pc, i);
+            int tag = gtag(tid, branch_pc, i);
+            panic_if(tableIndices[i] != index || tableTags[i] != tag,
+                     "TAGE indexer found index %#x tag %#x in bank %d for "
+                     "pc %#x, gindex() and gtag() give %#x %#x\n",
+                     tableIndices[i], tableTags[i], i, branch_pc, index, tag);
+        }
         bi->tableIndices[i] = tableIndices[i];
-        tableTags[i] = gtag(tid, branch_pc, i);
         bi->tableTags[i] = tableTags[i];
     }
 }
@@ -51,6 +51,7 @@
 #include <vector>
 
 #include "base/statistics.hh"
+#include "cpu/pred/tage_index.hh"
 #include "cpu/static_inst.hh"
 #include "params/TAGEBase.hh"
 #include "sim/sim_object.hh"
@@ -64,13 +65,13 @@ class TAGEBase : public SimObject
   protected:
     // Prediction Structures
 
-    // Tage Entry
+    // Tage Entry, packed in 4 bytes
     struct TageEntry
     {
-        int8_t ctr;
         uint16_t tag;
+        int8_t ctr;
         uint8_t u;
-        TageEntry() : ctr(0), tag(0), u(0) { }
+        TageEntry() : tag(0), ctr(0), u(0) { }
     };
 
     // Folded History Table - compressed history
@@ -353,7 +354,10 @@ class TAGEBase : public SimObject
 
     /**
      * On a prediction, calculates the TAGE indices and tags for
-     * all the different history lengths
+     * all the different history lengths. This base implementation
+     * computes them all at once with indexer, which gives the same
+     * results as gindex() and gtag(), so derived classes that change
+     * those must override this method too.
      */
     virtual void calculateIndicesAndTags(
         ThreadID tid, Addr branch_pc, BranchInfo* bi);
@@ -463,6 +467,12 @@ class TAGEBase : public SimObject
     int *tableIndices;
     int *tableTags;
 
+    /** Index and tag hashes of all the tagged tables */
+    TAGEIndexer indexer;
+    /** Folded histories of the current lookup, contiguous for indexer */
+    std::vector<unsigned> lookupCompIndices;
+    std::vector<unsigned> lookupCompTags[2];
+
     std::vector<int8_t> useAltPredForNewlyAllocated;
     int64_t tCounter;
     uint64_t logUResetPeriod;
@@ -480,6 +490,12 @@ class TAGEBase : public SimObject
 
     const unsigned instShiftAmt;
 
+    /** Hash the shifted PC above bit 31 into the indices too */
+    const bool fullPCIndex;
+
+    /** Also compute the indices and tags with gindex() and gtag() */
+    const bool indexCheck;
+
     bool initialized;
 
     struct TAGEBaseStats : public Stats::Group {
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/tage_index.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "base/logging.hh"
+
+void
+TAGEIndexer::init(unsigned n_tables, const std::vector<int> &log_sizes,
+                  const std::vector<unsigned> &tag_widths,
+                  const int *hist_lengths, unsigned path_hist_bits,
+                  unsigned inst_shift_amt, bool full_pc)
+{
+    fatal_if(log_sizes.size() < n_tables + 1 ||
+             tag_widths.size() < n_tables + 1,
+             "TAGE table parameters do not cover %d tables", n_tables);
+
+    nTables = n_tables;
+    instShiftAmt = inst_shift_amt;
+    fullPc = full_pc;
+
+    bank.assign(n_tables + 1, 0);
+    logSize.assign(n_tables + 1, 0);
+    indexMask.assign(n_tables + 1, 0);
+    tagMask.assign(n_tables + 1, 0);
+    pathMask.assign(n_tables + 1, 0);
+    pcShift.assign(n_tables + 1, 0);
+    foldShift.assign(n_tables + 1, 0);
+
+    for (int i = 1; i <= n_tables; i++) {
+        fatal_if(log_sizes[i] < 1 || log_sizes[i] > 31 || tag_widths[i] > 31,
+                 "TAGE table %d is too large to index", i);
+        int hlen = std::min<int>(hist_lengths[i], path_hist_bits);
+
+        bank[i] = i;
+        logSize[i] = log_sizes[i];
+        indexMask[i] = (1u << log_sizes[i]) - 1;
+        tagMask[i] = (1u << tag_widths[i]) - 1;
+        pathMask[i] = hlen >= 32 ? ~0u : (1u << hlen) - 1;
+        pcShift[i] = std::abs(log_sizes[i] - i) + 1;
+        foldShift[i] = log_sizes[i] >= i ? log_sizes[i] - i : 31;
+    }
+}
+
+void
+TAGEIndexer::compute(Addr pc, int path_hist, const unsigned *ci,
+                     const unsigned *ct0, const unsigned *ct1,
+                     int *indices, int *tags) const
+{
+    const Addr shifted_pc = fullPc ? pc >> instShiftAmt :
+                                     (uint32_t) (pc >> instShiftAmt);
+    const uint32_t phist = path_hist;
+
+    for (unsigned i = 1; i <= nTables; i++) {
+        // F(): fold the path history into the index width
+        uint32_t a = phist & pathMask[i];
+        uint32_t a1 = a & indexMask[i];
+        uint32_t a2 = a >> logSize[i];
+        a2 = ((a2 << bank[i]) & indexMask[i]) + (a2 >> foldShift[i]);
+        a = a1 ^ a2;
+        a = ((a << bank[i]) & indexMask[i]) + (a >> foldShift[i]);
+
+        indices[i] = (shifted_pc ^ (shifted_pc >> pcShift[i]) ^ ci[i] ^ a) &
+                     indexMask[i];
+        tags[i] = (shifted_pc ^ ct0[i] ^ (ct1[i] << 1)) & tagMask[i];
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Index and tag hashes of the tagged TAGE tables, computed for all the
+ * tables of one lookup at once.
+ */
+
+#ifndef __CPU_PRED_TAGE_INDEX_HH__
+#define __CPU_PRED_TAGE_INDEX_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Holds the per-table parameters of TAGEBase::gindex(), TAGEBase::gtag()
+ * and TAGEBase::F() as structure-of-arrays, with the masks and shift
+ * amounts precomputed, so that the indices and tags of all the tagged
+ * tables are produced by a single branch-free loop the compiler can
+ * vectorize. Results are bit-identical to the scalar functions. As in
+ * TAGEBase, the arrays are indexed by bank and entry 0 (the bimodal
+ * table) is unused.
+ */
+class TAGEIndexer
+{
+  public:
+    /**
+     * @param n_tables Number of tagged tables.
+     * @param log_sizes Log2 of the table sizes, indexed by bank.
+     * @param tag_widths Tag widths, indexed by bank.
+     * @param hist_lengths Global history lengths, indexed by bank.
+     * @param path_hist_bits Length of the path history.
+     * @param inst_shift_amt Number of PC bits dropped before hashing.
+     * @param full_pc Hash the shifted PC above bit 31 into the indices.
+     */
+    void init(unsigned n_tables, const std::vector<int> &log_sizes,
+              const std::vector<unsigned> &tag_widths,
+              const int *hist_lengths, unsigned path_hist_bits,
+              unsigned inst_shift_amt, bool full_pc = false);
+
+    /**
+     * Computes the index and tag of every tagged table.
+     * @param pc Branch PC.
+     * @param path_hist Path history of the thread.
+     * @param ci Folded index histories, indexed by bank.
+     * @param ct0 First folded tag histories, indexed by bank.
+     * @param ct1 Second folded tag histories, indexed by bank.
+     * @param indices Table indices, indexed by bank.
+     * @param tags Partial tags, indexed by bank.
+     */
+    void compute(Addr pc, int path_hist, const unsigned *ci,
+                 const unsigned *ct0, const unsigned *ct1,
+                 int *indices, int *tags) const;
+
+  private:
+    unsigned nTables = 0;
+    unsigned instShiftAmt = 0;
+    bool fullPc = false;
+
+    std::vector<uint32_t> bank;
+    std::vector<uint32_t> logSize;
+    /** Mask of the table index. */
+    std::vector<uint32_t> indexMask;
+    /** Mask of the partial tag. */
+    std::vector<uint32_t> tagMask;
+    /** Mask of the path history bits mixed into the index. */
+    std::vector<uint32_t> pathMask;
+    /** Right shift of the PC mixed into the index. */
+    std::vector<uint32_t> pcShift;
+    /**
+     * Right shift of the path history rotation in F(). Banks above the
+     * table size would shift by a negative amount, which leaves nothing
+     * of the value on the hosts gem5 runs on; 31 does the same without
+     * undefined behaviour.
+     */
+    std::vector<uint32_t> foldShift;
+};
+
+#endif // __CPU_PRED_TAGE_INDEX_HH__
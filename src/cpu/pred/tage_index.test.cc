@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "cpu/pred/tage_index.hh"
+
+namespace {
+
+/**
+ * Scalar TAGE hashes and history updates as written in TAGEBase, kept
+ * here as the reference TAGEIndexer must match bit for bit.
+ */
+struct FoldedHistory
+{
+    unsigned comp = 0;
+    int compLength;
+    int origLength;
+    int outpoint;
+
+    void init(int original_length, int compressed_length)
+    {
+        origLength = original_length;
+        compLength = compressed_length;
+        outpoint = original_length % compressed_length;
+    }
+
+    void update(uint8_t * h)
+    {
+        comp = (comp << 1) | h[0];
+        comp ^= h[origLength] << outpoint;
+        comp ^= (comp >> compLength);
+        comp &= (1ULL << compLength) - 1;
+    }
+};
+
+struct ReferenceTAGE
+{
+    unsigned nHistoryTables;
+    unsigned pathHistBits = 16;
+    unsigned instShiftAmt = 2;
+    bool fullPCIndex = false;
+    std::vector<int> logTagTableSizes;
+    std::vector<unsigned> tagTableTagWidths;
+    std::vector<int> histLengths;
+
+    std::vector<uint8_t> globalHistory;
+    int ptGhist;
+    int pathHist = 0;
+    std::vector<FoldedHistory> computeIndices;
+    std::vector<FoldedHistory> computeTags[2];
+
+    ReferenceTAGE(unsigned n, unsigned min_hist, unsigned max_hist,
+                  std::vector<int> log_sizes, std::vector<unsigned> widths)
+        : nHistoryTables(n), logTagTableSizes(log_sizes),
+          tagTableTagWidths(widths), histLengths(n + 1),
+          globalHistory(4 * max_hist, 0), ptGhist(2 * max_hist),
+          computeIndices(n + 1)
+    {
+        computeTags[0].resize(n + 1);
+        computeTags[1].resize(n + 1);
+
+        histLengths[1] = min_hist;
+        histLengths[n] = max_hist;
+        for (int i = 2; i <= n; i++) {
+            histLengths[i] = (int) (((double) min_hist *
+                pow((double) max_hist / (double) min_hist,
+                    (double) (i - 1) / (double) (n - 1))) + 0.5);
+        }
+        for (int i = 1; i <= n; i++) {
+            computeIndices[i].init(histLengths[i], logTagTableSizes[i]);
+            computeTags[0][i].init(histLengths[i], tagTableTagWidths[i]);
+            computeTags[1][i].init(histLengths[i], tagTableTagWidths[i] - 1);
+        }
+    }
+
+    int
+    F(int A, int size, int bank) const
+    {
+        int A1, A2;
+
+        A = A & ((1ULL << size) - 1);
+        A1 = (A & ((1ULL << logTagTableSizes[bank]) - 1));
+        A2 = (A >> logTagTableSizes[bank]);
+        A2 = ((A2 << bank) & ((1ULL << logTagTableSizes[bank]) - 1))
+           + (A2 >> (logTagTableSizes[bank] - bank));
+        A = A1 ^ A2;
+        A = ((A << bank) & ((1ULL << logTagTableSizes[bank]) - 1))
+          + (A >> (logTagTableSizes[bank] - bank));
+        return (A);
+    }
+
+    int
+    gindex(Addr pc, int bank) const
+    {
+        int index;
+        int hlen = (histLengths[bank] > pathHistBits) ? pathHistBits :
+                                                        histLengths[bank];
+        const Addr shiftedPc = fullPCIndex ?
+            pc >> instShiftAmt : (unsigned int) (pc >> instShiftAmt);
+        index =
+            shiftedPc ^
+            (shiftedPc >> ((int) abs(logTagTableSizes[bank] - bank) + 1)) ^
+            computeIndices[bank].comp ^
+            F(pathHist, hlen, bank);
+
+        return (index & ((1ULL << (logTagTableSizes[bank])) - 1));
+    }
+
+    uint16_t
+    gtag(Addr pc, int bank) const
+    {
+        int tag = (pc >> instShiftAmt) ^
+                  computeTags[0][bank].comp ^
+                  (computeTags[1][bank].comp << 1);
+
+        return (tag & ((1ULL << tagTableTagWidths[bank]) - 1));
+    }
+
+    void
+    update(Addr pc, bool taken)
+    {
+        // The history moves towards lower addresses; keep enough of it
+        // behind the pointer instead of rolling it over.
+        if (ptGhist == 0) {
+            std::fill(globalHistory.begin(), globalHistory.end(), 0);
+            ptGhist = globalHistory.size() / 2;
+        }
+        uint8_t *h = &globalHistory[--ptGhist];
+        h[0] = taken;
+        pathHist = (pathHist << 1) + ((pc >> instShiftAmt) & 1);
+        pathHist &= (1ULL << pathHistBits) - 1;
+        for (int i = 1; i <= nHistoryTables; i++) {
+            computeIndices[i].update(h);
+            computeTags[0][i].update(h);
+            computeTags[1][i].update(h);
+        }
+    }
+};
+
+/**
+ * Checks the indexer against the reference along a branch stream, with
+ * the code placed at pc_base.
+ */
+void
+checkTrace(ReferenceTAGE &ref, Addr pc_base = 0)
+{
+    const unsigned n = ref.nHistoryTables;
+    TAGEIndexer indexer;
+    indexer.init(n, ref.logTagTableSizes, ref.tagTableTagWidths,
+                 ref.histLengths.data(), ref.pathHistBits, ref.instShiftAmt,
+                 ref.fullPCIndex);
+
+    std::vector<unsigned> ci(n + 1), ct0(n + 1), ct1(n + 1);
+    std::vector<int> indices(n + 1), tags(n + 1);
+
+    // A synthetic stream: a loop nest with a data dependent branch,
+    // followed by far-apart call sites.
+    uint64_t lfsr = 0xace1;
+    for (int step = 0; step < 20000; step++) {
+        Addr pc;
+        bool taken;
+        switch (step % 4) {
+          case 0:
+            pc = 0x400a10;
+            taken = (step / 4) % 17 != 16;
+            break;
+          case 1:
+            pc = 0x400a3c;
+            taken = lfsr & 1;
+            break;
+          case 2:
+            pc = 0x400a58;
+            taken = (step / 4) % 3 == 0;
+            break;
+          default:
+            pc = 0x7fff0000ULL + ((lfsr & 0xffff) << 4);
+            taken = true;
+            break;
+        }
+        pc += pc_base;
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xb400);
+
+        for (int i = 1; i <= n; i++) {
+            ci[i] = ref.computeIndices[i].comp;
+            ct0[i] = ref.computeTags[0][i].comp;
+            ct1[i] = ref.computeTags[1][i].comp;
+        }
+        indexer.compute(pc, ref.pathHist, ci.data(), ct0.data(), ct1.data(),
+                        indices.data(), tags.data());
+        for (int i = 1; i <= n; i++) {
+            ASSERT_EQ(indices[i], ref.gindex(pc, i))
+                << "bank " << i << " step " << step;
+            ASSERT_EQ(tags[i], ref.gtag(pc, i))
+                << "bank " << i << " step " << step;
+        }
+
+        ref.update(pc, taken);
+    }
+}
+
+/**
+ * Runs the code of checkTrace() above 16GB, e.g., kernel code, on tables
+ * large enough to take index bits from above bit 31 of the shifted PC,
+ * and returns the banks that tell apart two branches differing only in
+ * bit 32 of their shifted PC.
+ */
+std::vector<bool>
+highPCBanks(bool full_pc)
+{
+    ReferenceTAGE ref(3, 5, 40, {13, 20, 18, 16}, {0, 9, 10, 11});
+    ref.fullPCIndex = full_pc;
+    checkTrace(ref, 0xffff800000000000ULL);
+
+    const unsigned n = ref.nHistoryTables;
+    TAGEIndexer indexer;
+    indexer.init(n, ref.logTagTableSizes, ref.tagTableTagWidths,
+                 ref.histLengths.data(), ref.pathHistBits, ref.instShiftAmt,
+                 full_pc);
+    std::vector<unsigned> zeros(n + 1, 0);
+    std::vector<int> low(n + 1), high(n + 1), tags(n + 1);
+    indexer.compute(0x400a10, 0, zeros.data(), zeros.data(), zeros.data(),
+                    low.data(), tags.data());
+    indexer.compute(0x400a10 + (1ULL << 34), 0, zeros.data(), zeros.data(),
+                    zeros.data(), high.data(), tags.data());
+
+    std::vector<bool> apart(n + 1, false);
+    for (int i = 1; i <= n; i++)
+        apart[i] = low[i] != high[i];
+    return apart;
+}
+
+} // anonymous namespace
+
+/** The tables of LTAGE, including banks above their log size. */
+TEST(TAGEIndexerTest, LTAGE)
+{
+    ReferenceTAGE ref(12, 4, 640,
+        {14, 10, 10, 11, 11, 11, 11, 10, 10, 10, 10, 9, 9},
+        {0, 7, 7, 8, 8, 9, 10, 11, 12, 12, 13, 14, 15});
+    checkTrace(ref);
+}
+
+/** The default TAGEBase tables. */
+TEST(TAGEIndexerTest, TAGE)
+{
+    ReferenceTAGE ref(7, 5, 130,
+        {13, 9, 9, 9, 9, 9, 9, 9},
+        {0, 9, 9, 10, 10, 11, 11, 12});
+    checkTrace(ref);
+}
+
+/** Like gindex(), the indexer drops the shifted PC above bit 31. */
+TEST(TAGEIndexerTest, HighPC)
+{
+    std::vector<bool> apart = highPCBanks(false);
+    for (int i = 1; i < apart.size(); i++)
+        EXPECT_FALSE(apart[i]) << "bank " << i;
+}
+
+/**
+ * With fullPCIndex the banks whose index takes bits from above bit 31
+ * of the shifted PC tell the branches apart.
+ */
+TEST(TAGEIndexerTest, HighPCFull)
+{
+    const std::vector<int> log_sizes = {13, 20, 18, 16};
+    std::vector<bool> apart = highPCBanks(true);
+    for (int i = 1; i < apart.size(); i++) {
+        bool high_bits = std::abs(log_sizes[i] - i) + 1 + log_sizes[i] > 32;
+        EXPECT_EQ(apart[i], high_bits) << "bank " << i;
+    }
+}
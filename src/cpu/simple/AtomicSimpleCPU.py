@@ -60,7 +60,8 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
 
-    def addSimPointProbe(self, interval):
+    def addSimPointProbe(self, interval, compact=False):
         simpoint = SimPoint()
         simpoint.interval = interval
+        simpoint.compact_format = compact
         self.probeListener = simpoint
@@ -44,3 +44,7 @@ class SimPoint(ProbeListenerObject):
 
     interval = Param.UInt64(100000000, "Interval Size (insts)")
     profile_file = Param.String("simpoint.bb.gz", "BBV (output) file")
+    compact_format = Param.Bool(False, "Write BBVs in the compact binary "
+        "format instead of the SimPoint 3.2 text format")
+    bb_cache_size = Param.Unsigned(4096, "Entries of the direct-mapped "
+        "basic block cache (power of 2)")
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/simple/probes/bbv.hh"
+
+#include <zlib.h>
+
+#include <cstring>
+
+#include "base/logging.hh"
+
+namespace BBV
+{
+
+namespace
+{
+
+/** Read a whole file, decompressing it if it is gzip compressed. */
+std::string
+slurp(const std::string &path)
+{
+    gzFile f = gzopen(path.c_str(), "rb");
+    if (!f)
+        fatal("Can't open BBV file %s\n", path);
+
+    std::string data;
+    char buf[1 << 16];
+    int n;
+    while ((n = gzread(f, buf, sizeof(buf))) > 0)
+        data.append(buf, n);
+    if (n < 0)
+        fatal("Error reading BBV file %s\n", path);
+    gzclose(f);
+    return data;
+}
+
+uint64_t
+readVarint(const std::string &data, size_t &pos, const std::string &path)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        fatal_if(pos >= data.size(), "Truncated BBV file %s\n", path);
+        uint8_t byte = data[pos++];
+        v |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return v;
+    }
+    fatal("Corrupt BBV file %s\n", path);
+}
+
+std::vector<Interval>
+readCompact(const std::string &data, const std::string &path)
+{
+    std::vector<Interval> intervals;
+    size_t pos = sizeof(Magic);
+    while (pos < data.size()) {
+        uint64_t blocks = readVarint(data, pos, path);
+        // Each block takes at least a byte for its ID and one for its count
+        fatal_if(blocks > (data.size() - pos) / 2,
+                 "Corrupt BBV file %s: interval of %d blocks in %d bytes\n",
+                 path, blocks, data.size() - pos);
+        intervals.emplace_back(blocks);
+        uint64_t id = 0;
+        for (auto &bb : intervals.back()) {
+            id += readVarint(data, pos, path);
+            bb.first = id;
+            bb.second = readVarint(data, pos, path);
+        }
+    }
+    return intervals;
+}
+
+std::vector<Interval>
+readText(const std::string &data, const std::string &path)
+{
+    std::vector<Interval> intervals;
+    const char *p = data.c_str();
+    const char *end = p + data.size();
+    while (p < end) {
+        const char *eol = static_cast<const char *>(
+            std::memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+        if (*p == 'T') {
+            intervals.emplace_back();
+            const char *q = p + 1;
+            while (q < eol && *q == ':') {
+                char *next;
+                uint64_t id = strtoull(q + 1, &next, 10);
+                fatal_if(*next != ':', "Malformed interval in BBV file %s\n",
+                         path);
+                uint64_t count = strtoull(next + 1, &next, 10);
+                intervals.back().emplace_back(id, count);
+                q = next;
+                while (q < eol && *q == ' ')
+                    q++;
+            }
+        }
+        p = eol + 1;
+    }
+    return intervals;
+}
+
+} // anonymous namespace
+
+std::vector<Interval>
+read(const std::string &path)
+{
+    std::string data = slurp(path);
+    if (data.size() >= sizeof(Magic) &&
+        std::memcmp(data.data(), Magic, sizeof(Magic)) == 0) {
+        return readCompact(data, path);
+    }
+    return readText(data, path);
+}
+
+} // namespace BBV
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Basic block vector files written by the SimPoint probe.
+ */
+
+#ifndef __CPU_SIMPLE_PROBES_BBV_HH__
+#define __CPU_SIMPLE_PROBES_BBV_HH__
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * The SimPoint probe writes one basic block vector (BBV) per interval,
+ * either in the text format of SimPoint 3.2,
+ *
+ *     T:<id>:<count> :<id>:<count> ...
+ *
+ * or in a compact binary format that starts with Magic and holds, per
+ * interval, the number of blocks followed by the difference to the
+ * previous block ID and the instruction count of every block, all as
+ * LEB128 varints. In both formats block IDs start at 1 and increase
+ * within an interval. Either may be gzip compressed.
+ */
+namespace BBV
+{
+
+static const char Magic[8] = { 'g', 'e', 'm', '5', 'b', 'b', 'v', '1' };
+
+/** Blocks executed in an interval: (block ID, instruction count). */
+typedef std::vector<std::pair<uint64_t, uint64_t>> Interval;
+
+inline void
+writeVarint(std::ostream &os, uint64_t v)
+{
+    char buf[10];
+    int n = 0;
+    do {
+        buf[n] = v & 0x7f;
+        v >>= 7;
+        if (v)
+            buf[n] |= 0x80;
+        n++;
+    } while (v);
+    os.write(buf, n);
+}
+
+/** Append one interval to os in the compact format. */
+inline void
+writeCompact(std::ostream &os, const Interval &interval)
+{
+    writeVarint(os, interval.size());
+    uint64_t prev = 0;
+    for (const auto &bb : interval) {
+        writeVarint(os, bb.first - prev);
+        writeVarint(os, bb.second);
+        prev = bb.first;
+    }
+}
+
+/** Append one interval to os in the SimPoint text format. */
+inline void
+writeText(std::ostream &os, const Interval &interval)
+{
+    os << "T";
+    for (const auto &bb : interval)
+        os << ":" << bb.first << ":" << bb.second << " ";
+    os << "\n";
+}
+
+/** Read all intervals of a text or compact, plain or gzip file. */
+std::vector<Interval> read(const std::string &path);
+
+} // namespace BBV
+
+#endif // __CPU_SIMPLE_PROBES_BBV_HH__
@@ -37,20 +37,32 @@
 
 #include "cpu/simple/probes/simpoint.hh"
 
+#include <algorithm>
+
+#include "base/intmath.hh"
 #include "base/output.hh"
+#include "cpu/simple/probes/bbv.hh"
 
 SimPoint::SimPoint(const SimPointParams *p)
     : ProbeListenerObject(p),
       intervalSize(p->interval),
+      compact(p->compact_format),
       intervalCount(0),
       intervalDrift(0),
       simpointStream(NULL),
+      bbCache(p->bb_cache_size, CacheEntry{BasicBlockRange(0, 0), 0}),
+      bbCacheMask(p->bb_cache_size - 1),
       currentBBV(0, 0),
       currentBBVInstCount(0)
 {
-    simpointStream = simout.create(p->profile_file, false);
+    fatal_if(!isPowerOf2(p->bb_cache_size),
+             "SimPoint bb_cache_size must be a power of 2\n");
+
+    simpointStream = simout.create(p->profile_file, compact);
     if (!simpointStream)
         fatal("unable to open SimPoint profile_file");
+    if (compact)
+        simpointStream->stream()->write(BBV::Magic, sizeof(BBV::Magic));
 }
 
 SimPoint::~SimPoint()
@@ -71,6 +83,25 @@ SimPoint::regProbeListeners()
                                              &SimPoint::profile));
 }
 
+uint64_t
+SimPoint::blockId(const BasicBlockRange &bb, uint64_t insts)
+{
+    CacheEntry &entry = bbCache[(bb.first ^ (bb.first >> 16)) & bbCacheMask];
+    if (entry.id && entry.bb == bb)
+        return entry.id;
+
+    auto map_itr = bbMap.find(bb);
+    if (map_itr == bbMap.end()) {
+        // If a new (previously unseen) basic block is found,
+        // add a new unique id and record num of insts.
+        blocks.push_back(BBInfo{insts, 0});
+        map_itr = bbMap.emplace(bb, blocks.size()).first;
+    }
+    entry.bb = bb;
+    entry.id = map_itr->second;
+    return entry.id;
+}
+
 void
 SimPoint::profile(const std::pair<SimpleThread*, StaticInstPtr>& p)
 {
@@ -90,55 +121,44 @@ SimPoint::profile(const std::pair<SimpleThread*, StaticInstPtr>& p)
     if (inst->isControl()) {
         currentBBV.second = thread->pcState().instAddr();
 
-        auto map_itr = bbMap.find(currentBBV);
-        if (map_itr == bbMap.end()){
-            // If a new (previously unseen) basic block is found,
-            // add a new unique id, record num of insts and insert
-            // into bbMap.
-            BBInfo info;
-            info.id = bbMap.size() + 1;
-            info.insts = currentBBVInstCount;
-            info.count = currentBBVInstCount;
-            bbMap.insert(std::make_pair(currentBBV, info));
-        } else {
-            // If basic block is seen before, just increment the count by the
-            // number of insts in basic block.
-            BBInfo& info = map_itr->second;
-            info.count += currentBBVInstCount;
-        }
+        uint64_t id = blockId(currentBBV, currentBBVInstCount);
+        BBInfo &info = blocks[id - 1];
+        if (!info.count)
+            touched.push_back(id);
+        info.count += currentBBVInstCount;
         currentBBVInstCount = 0;
 
         // Reached end of interval if the sum of the current inst count
         // (intervalCount) and the excessive inst count from the previous
         // interval (intervalDrift) is greater than/equal to the interval size.
         if (intervalCount + intervalDrift >= intervalSize) {
-            // summarize interval and display BBV info
-            std::vector<std::pair<uint64_t, uint64_t> > counts;
-            for (auto map_itr = bbMap.begin(); map_itr != bbMap.end();
-                    ++map_itr) {
-                BBInfo& info = map_itr->second;
-                if (info.count != 0) {
-                    counts.push_back(std::make_pair(info.id, info.count));
-                    info.count = 0;
-                }
-            }
-            std::sort(counts.begin(), counts.end());
-
-            // Print output BBV info
-            *simpointStream->stream() << "T";
-            for (auto cnt_itr = counts.begin(); cnt_itr != counts.end();
-                    ++cnt_itr) {
-                *simpointStream->stream() << ":" << cnt_itr->first
-                                << ":" << cnt_itr->second << " ";
-            }
-            *simpointStream->stream() << "\n";
-
+            dumpInterval();
             intervalDrift = (intervalCount + intervalDrift) - intervalSize;
             intervalCount = 0;
         }
     }
 }
 
+void
+SimPoint::dumpInterval()
+{
+    // Only the blocks executed in this interval have to be visited.
+    std::sort(touched.begin(), touched.end());
+    BBV::Interval counts;
+    counts.reserve(touched.size());
+    for (uint64_t id : touched) {
+        BBInfo &info = blocks[id - 1];
+        counts.emplace_back(id, info.count);
+        info.count = 0;
+    }
+    touched.clear();
+
+    if (compact)
+        BBV::writeCompact(*simpointStream->stream(), counts);
+    else
+        BBV::writeText(*simpointStream->stream(), counts);
+}
+
 /** SimPoint SimObject */
 SimPoint*
 SimPointParams::create()
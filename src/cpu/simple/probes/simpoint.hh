@@ -39,6 +39,7 @@
 #define __CPU_SIMPLE_PROBES_SIMPOINT_HH__
 
 #include <unordered_map>
+#include <vector>
 
 #include "base/output.hh"
 #include "cpu/simple_thread.hh"
@@ -87,8 +88,16 @@ class SimPoint : public ProbeListenerObject
     void profile(const std::pair<SimpleThread*, StaticInstPtr>&);
 
   private:
+    /** ID of a basic block, assigning a new one if it is unseen. */
+    uint64_t blockId(const BasicBlockRange &bb, uint64_t insts);
+
+    /** Write the BBV of the interval that just ended. */
+    void dumpInterval();
+
     /** SimPoint profiling interval size in instructions */
     const uint64_t intervalSize;
+    /** Write BBVs in the compact binary format, see BBV */
+    const bool compact;
 
     /** Inst count in current basic block */
     uint64_t intervalCount;
@@ -99,16 +108,32 @@ class SimPoint : public ProbeListenerObject
 
     /** Basic Block information */
     struct BBInfo {
-        /** Unique ID */
-        uint64_t id;
         /** Num of static insts in BB */
         uint64_t insts;
         /** Accumulated dynamic inst count executed by BB */
         uint64_t count;
     };
 
-    /** Hash table containing all previously seen basic blocks */
-    std::unordered_map<BasicBlockRange, BBInfo> bbMap;
+    /** All previously seen basic blocks, indexed by ID - 1 */
+    std::vector<BBInfo> blocks;
+    /** IDs of all previously seen basic blocks */
+    std::unordered_map<BasicBlockRange, uint64_t> bbMap;
+
+    /**
+     * Direct-mapped cache of bbMap indexed by the start PC, which
+     * resolves almost all block ends without hashing the range.
+     */
+    struct CacheEntry {
+        BasicBlockRange bb;
+        /** 0 if the entry is invalid */
+        uint64_t id;
+    };
+    std::vector<CacheEntry> bbCache;
+    const Addr bbCacheMask;
+
+    /** IDs of the blocks executed in the current interval */
+    std::vector<uint64_t> touched;
+
     /** Currently executing basic block */
     BasicBlockRange currentBBV;
     /** inst count in current basic block */
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/simple/probes/simpoint_cluster.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace SimPointCluster
+{
+
+namespace
+{
+
+uint64_t
+mix(uint64_t x)
+{
+    // splitmix64 finaliser
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+double
+squaredDistance(const double *a, const double *b, unsigned dims)
+{
+    double sum = 0;
+    for (unsigned i = 0; i < dims; i++) {
+        double diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+struct Run
+{
+    double distortion;
+    std::vector<double> centers;
+    std::vector<unsigned> labels;
+};
+
+/** Pick k initial centres with k-means++. */
+void
+seedCenters(const std::vector<double> &points, size_t n, unsigned dims,
+            unsigned k, std::mt19937_64 &rng, std::vector<double> &centers)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    centers.resize(size_t(k) * dims);
+
+    size_t first = rng() % n;
+    std::copy_n(&points[first * dims], dims, &centers[0]);
+
+    std::vector<double> nearest(n);
+    for (size_t i = 0; i < n; i++)
+        nearest[i] = squaredDistance(&points[i * dims], &centers[0], dims);
+
+    for (unsigned c = 1; c < k; c++) {
+        double total = 0;
+        for (double d : nearest)
+            total += d;
+
+        size_t pick = n - 1;
+        if (total > 0) {
+            double r = uniform(rng) * total;
+            for (size_t i = 0; i < n; i++) {
+                r -= nearest[i];
+                if (r < 0) {
+                    pick = i;
+                    break;
+                }
+            }
+        } else {
+            pick = rng() % n;
+        }
+
+        double *center = &centers[size_t(c) * dims];
+        std::copy_n(&points[pick * dims], dims, center);
+        for (size_t i = 0; i < n; i++) {
+            nearest[i] = std::min(nearest[i],
+                squaredDistance(&points[i * dims], center, dims));
+        }
+    }
+}
+
+Run
+kmeans(const std::vector<double> &points, size_t n, unsigned dims,
+       unsigned k, uint64_t seed, unsigned max_iterations)
+{
+    std::mt19937_64 rng(seed);
+    Run run;
+    seedCenters(points, n, dims, k, rng, run.centers);
+    run.labels.assign(n, k);
+
+    std::vector<double> sums(size_t(k) * dims);
+    std::vector<size_t> sizes(k);
+    for (unsigned it = 0; it < max_iterations; it++) {
+        bool changed = false;
+        for (size_t i = 0; i < n; i++) {
+            const double *p = &points[i * dims];
+            unsigned best = 0;
+            double best_dist = std::numeric_limits<double>::max();
+            for (unsigned c = 0; c < k; c++) {
+                double d = squaredDistance(p, &run.centers[c * dims], dims);
+                if (d < best_dist) {
+                    best_dist = d;
+                    best = c;
+                }
+            }
+            if (run.labels[i] != best) {
+                run.labels[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed)
+            break;
+
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (size_t i = 0; i < n; i++) {
+            unsigned c = run.labels[i];
+            sizes[c]++;
+            for (unsigned j = 0; j < dims; j++)
+                sums[c * dims + j] += points[i * dims + j];
+        }
+        // Empty clusters keep their previous centre.
+        for (unsigned c = 0; c < k; c++) {
+            if (!sizes[c])
+                continue;
+            for (unsigned j = 0; j < dims; j++)
+                run.centers[c * dims + j] = sums[c * dims + j] / sizes[c];
+        }
+    }
+
+    run.distortion = 0;
+    for (size_t i = 0; i < n; i++) {
+        run.distortion += squaredDistance(&points[i * dims],
+            &run.centers[run.labels[i] * dims], dims);
+    }
+    return run;
+}
+
+/**
+ * Bayesian information criterion of a clustering under the spherical
+ * Gaussian model of X-means (Pelleg and Moore), as used by SimPoint.
+ */
+double
+bic(const Run &run, size_t n, unsigned dims, unsigned k)
+{
+    std::vector<size_t> sizes(k);
+    for (unsigned c : run.labels)
+        sizes[c]++;
+
+    double variance = n > k ? run.distortion / (double(dims) * (n - k)) : 0;
+    variance = std::max(variance, std::numeric_limits<double>::min());
+
+    double log_likelihood = -0.5 * dims * (double(n) - k);
+    for (size_t size : sizes) {
+        if (!size)
+            continue;
+        log_likelihood += size * std::log(double(size)) -
+            size * std::log(double(n)) -
+            0.5 * size * dims * std::log(2 * M_PI * variance);
+    }
+    double params = (k - 1) + double(k) * dims + 1;
+    return log_likelihood - 0.5 * params * std::log(double(n));
+}
+
+} // anonymous namespace
+
+std::vector<double>
+project(const std::vector<BBV::Interval> &intervals, unsigned dims,
+        uint64_t seed)
+{
+    std::vector<double> points(intervals.size() * dims, 0.0);
+    for (size_t i = 0; i < intervals.size(); i++) {
+        double total = 0;
+        for (const auto &bb : intervals[i])
+            total += bb.second;
+        if (total == 0)
+            continue;
+
+        double *p = &points[i * dims];
+        for (const auto &bb : intervals[i]) {
+            double freq = bb.second / total;
+            // The projection matrix is derived from the block ID rather
+            // than stored, so it needs no bound on the number of blocks.
+            for (unsigned j = 0; j < dims; j++) {
+                uint64_t h = mix(seed ^ mix(bb.first * dims + j));
+                p[j] += freq * ((h >> 11) / double(1ULL << 52) - 1.0);
+            }
+        }
+    }
+    return points;
+}
+
+Result
+cluster(const std::vector<double> &points, size_t n, const Options &opts)
+{
+    // Without intervals there is nothing to seed k-means with.
+    if (n == 0)
+        return Result{0, {}, {}};
+
+    const unsigned dims = opts.dims;
+    const unsigned max_k = std::max<size_t>(1, std::min<size_t>(opts.maxK, n));
+    const unsigned seeds = std::max(1u, opts.seeds);
+    const size_t jobs = size_t(max_k) * seeds;
+
+    std::vector<Run> runs(jobs);
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t job; (job = next++) < jobs; ) {
+            unsigned k = job / seeds + 1;
+            uint64_t seed = mix(opts.seed ^ mix(job));
+            runs[job] = kmeans(points, n, dims, k, seed, opts.maxIterations);
+        }
+    };
+
+    unsigned threads = opts.threads ? opts.threads :
+        std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, jobs);
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    // Keep the best seed of every k and score it.
+    std::vector<const Run *> best(max_k);
+    std::vector<double> scores(max_k);
+    for (unsigned k = 1; k <= max_k; k++) {
+        const Run *b = &runs[(k - 1) * seeds];
+        for (unsigned s = 1; s < seeds; s++) {
+            const Run *r = &runs[(k - 1) * seeds + s];
+            if (r->distortion < b->distortion)
+                b = r;
+        }
+        best[k - 1] = b;
+        scores[k - 1] = bic(*b, n, dims, k);
+    }
+
+    auto range = std::minmax_element(scores.begin(), scores.end());
+    double threshold = *range.first +
+        opts.bicThreshold * (*range.second - *range.first);
+    unsigned k = 1;
+    while (scores[k - 1] < threshold)
+        k++;
+    const Run &run = *best[k - 1];
+
+    // Number the non-empty clusters in order and pick the interval
+    // closest to the centre of each.
+    Result result;
+    result.k = k;
+    std::vector<int> index(k, -1);
+    std::vector<double> closest;
+    std::vector<size_t> sizes;
+    result.labels.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        unsigned c = run.labels[i];
+        double d = squaredDistance(&points[i * dims],
+                                   &run.centers[c * dims], dims);
+        if (index[c] < 0) {
+            index[c] = result.points.size();
+            result.points.push_back({i, 0.0});
+            closest.push_back(d);
+            sizes.push_back(0);
+        } else if (d < closest[index[c]]) {
+            result.points[index[c]].interval = i;
+            closest[index[c]] = d;
+        }
+        sizes[index[c]]++;
+        result.labels[i] = index[c];
+    }
+    for (size_t c = 0; c < result.points.size(); c++)
+        result.points[c].weight = double(sizes[c]) / n;
+
+    return result;
+}
+
+} // namespace SimPointCluster
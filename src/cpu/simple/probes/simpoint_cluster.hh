@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * SimPoint clustering of basic block vectors.
+ */
+
+#ifndef __CPU_SIMPLE_PROBES_SIMPOINT_CLUSTER_HH__
+#define __CPU_SIMPLE_PROBES_SIMPOINT_CLUSTER_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "cpu/simple/probes/bbv.hh"
+
+/**
+ * Picks simulation points from the BBVs of fixed-length intervals the
+ * way SimPoint 3.2 does by default, so that no external tool is needed
+ * between profiling and taking checkpoints:
+ *
+ * - every BBV is normalised to sum 1 and randomly projected to a few
+ *   dimensions (uniform projection matrix in [-1, 1]),
+ * - k-means is run for k = 1..maxK with several k-means++ seeds, and
+ *   the run with the lowest distortion is kept for every k,
+ * - the smallest k whose BIC reaches bicThreshold of the range of BIC
+ *   scores is chosen,
+ * - the interval closest to the centre of each cluster becomes its
+ *   simulation point, weighted by the fraction of intervals in it.
+ *
+ * The runs are spread over threads. Results only depend on the seed,
+ * not on the number of threads.
+ */
+namespace SimPointCluster
+{
+
+struct Options
+{
+    unsigned maxK = 30;
+    unsigned dims = 15;
+    unsigned seeds = 5;
+    unsigned maxIterations = 100;
+    double bicThreshold = 0.9;
+    /** 0 uses one thread per host core */
+    unsigned threads = 0;
+    uint64_t seed = 493575226;
+};
+
+struct SimPoint
+{
+    uint64_t interval;
+    double weight;
+};
+
+struct Result
+{
+    unsigned k;
+    /** Simulation points, one per non-empty cluster */
+    std::vector<SimPoint> points;
+    /** Cluster of every interval, indexing points */
+    std::vector<unsigned> labels;
+};
+
+/** Normalise and project BBVs, returning n * dims coordinates. */
+std::vector<double> project(const std::vector<BBV::Interval> &intervals,
+                            unsigned dims, uint64_t seed);
+
+/**
+ * Cluster the projected points of n intervals. Without intervals, the
+ * result has k = 0 and no simulation points.
+ */
+Result cluster(const std::vector<double> &points, size_t n,
+               const Options &opts);
+
+} // namespace SimPointCluster
+
+#endif // __CPU_SIMPLE_PROBES_SIMPOINT_CLUSTER_HH__
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "cpu/simple/probes/simpoint_cluster.hh"
+
+namespace
+{
+
+/**
+ * Intervals alternating between three phases that run disjoint sets of
+ * blocks with some noise on the counts.
+ */
+std::vector<BBV::Interval>
+phases(size_t n)
+{
+    std::mt19937 rng(1);
+    std::vector<BBV::Interval> intervals;
+    for (size_t i = 0; i < n; i++) {
+        intervals.emplace_back();
+        uint64_t base = 1 + 100 * (i % 3);
+        for (uint64_t bb = base; bb < base + 20; bb++)
+            intervals.back().emplace_back(bb, 1000 + rng() % 100);
+    }
+    return intervals;
+}
+
+} // anonymous namespace
+
+/** Projection only depends on the block frequencies of an interval. */
+TEST(SimPointClusterTest, ProjectNormalises)
+{
+    std::vector<BBV::Interval> intervals = {
+        {{1, 10}, {2, 30}}, {{1, 100}, {2, 300}}, {}};
+    std::vector<double> points = SimPointCluster::project(intervals, 4, 1);
+    ASSERT_EQ(points.size(), 12u);
+    for (unsigned j = 0; j < 4; j++) {
+        EXPECT_DOUBLE_EQ(points[j], points[4 + j]);
+        EXPECT_LE(std::abs(points[j]), 1.0);
+        EXPECT_EQ(points[8 + j], 0.0);
+    }
+}
+
+/** Well-separated phases end up in one cluster each. */
+TEST(SimPointClusterTest, FindsPhases)
+{
+    std::vector<BBV::Interval> intervals = phases(90);
+    SimPointCluster::Options opts;
+    opts.maxK = 10;
+    std::vector<double> points =
+        SimPointCluster::project(intervals, opts.dims, opts.seed);
+    SimPointCluster::Result result =
+        SimPointCluster::cluster(points, intervals.size(), opts);
+
+    ASSERT_EQ(result.points.size(), 3u);
+    double total = 0;
+    for (size_t c = 0; c < result.points.size(); c++) {
+        const SimPointCluster::SimPoint &sp = result.points[c];
+        EXPECT_DOUBLE_EQ(sp.weight, 1.0 / 3);
+        EXPECT_EQ(result.labels[sp.interval], c);
+        total += sp.weight;
+    }
+    EXPECT_DOUBLE_EQ(total, 1.0);
+    for (size_t i = 3; i < intervals.size(); i++)
+        EXPECT_EQ(result.labels[i], result.labels[i % 3]);
+}
+
+/** The result does not depend on the number of threads. */
+TEST(SimPointClusterTest, ThreadIndependent)
+{
+    std::vector<BBV::Interval> intervals;
+    for (size_t i = 0; i < 200; i++) {
+        intervals.push_back({{1 + i % 11, 100 + (i * 37) % 50},
+                             {20 + i % 5, 100}});
+    }
+    SimPointCluster::Options opts;
+    opts.maxK = 8;
+    std::vector<double> points =
+        SimPointCluster::project(intervals, opts.dims, opts.seed);
+
+    opts.threads = 1;
+    SimPointCluster::Result one =
+        SimPointCluster::cluster(points, intervals.size(), opts);
+    opts.threads = 4;
+    SimPointCluster::Result four =
+        SimPointCluster::cluster(points, intervals.size(), opts);
+
+    EXPECT_EQ(one.k, four.k);
+    EXPECT_EQ(one.labels, four.labels);
+    ASSERT_EQ(one.points.size(), four.points.size());
+    for (size_t c = 0; c < one.points.size(); c++)
+        EXPECT_EQ(one.points[c].interval, four.points[c].interval);
+}
+
+/** Clustering no intervals yields no simulation points. */
+TEST(SimPointClusterTest, NoIntervals)
+{
+    SimPointCluster::Options opts;
+    std::vector<double> points =
+        SimPointCluster::project({}, opts.dims, opts.seed);
+    SimPointCluster::Result result =
+        SimPointCluster::cluster(points, 0, opts);
+
+    EXPECT_EQ(result.k, 0u);
+    EXPECT_TRUE(result.points.empty());
+    EXPECT_TRUE(result.labels.empty());
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <iomanip>
+
+#include "base/logging.hh"
+#include "cpu/simple/probes/bbv.hh"
+#include "cpu/simple/probes/simpoint_cluster.hh"
+#include "python/pybind11/pybind.hh"
+#include "sim/init.hh"
+
+namespace
+{
+
+/**
+ * Cluster the BBVs in bbv and write the SimPoint 3.2 style simpoints and
+ * weights files --take-simpoint-checkpoints expects. Returns the number
+ * of clusters chosen.
+ */
+unsigned
+clusterFile(const std::string &bbv, const std::string &simpoints,
+            const std::string &weights, unsigned max_k, unsigned dims,
+            unsigned threads, uint64_t seed)
+{
+    std::vector<BBV::Interval> intervals = BBV::read(bbv);
+    fatal_if(intervals.empty(), "No intervals in BBV file %s\n", bbv);
+
+    SimPointCluster::Options opts;
+    opts.maxK = max_k;
+    opts.dims = dims;
+    opts.threads = threads;
+    opts.seed = seed;
+    std::vector<double> points =
+        SimPointCluster::project(intervals, dims, seed);
+    SimPointCluster::Result result =
+        SimPointCluster::cluster(points, intervals.size(), opts);
+
+    std::ofstream sp(simpoints), wt(weights);
+    fatal_if(!sp || !wt, "Can't write %s and %s\n", simpoints, weights);
+    wt << std::setprecision(10);
+    for (size_t c = 0; c < result.points.size(); c++) {
+        sp << result.points[c].interval << " " << c << "\n";
+        wt << result.points[c].weight << " " << c << "\n";
+    }
+    return result.k;
+}
+
+void
+simpoint_pybind(pybind11::module &m_internal)
+{
+    using namespace pybind11::literals;
+
+    pybind11::module m = m_internal.def_submodule("simpoint");
+    m.def("cluster", &clusterFile, "bbv"_a, "simpoints"_a, "weights"_a,
+          "max_k"_a = 30, "dims"_a = 15, "threads"_a = 0,
+          "seed"_a = SimPointCluster::Options().seed);
+}
+EmbeddedPyBind embed_("simpoint", &simpoint_pybind);
+
+} // anonymous namespace
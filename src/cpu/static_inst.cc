@@ -67,7 +67,7 @@ class NopStaticInst : public StaticInst
 }
 
 StaticInstPtr StaticInst::nullStaticInstPtr;
-StaticInstPtr StaticInst::nopStaticInstPtr = new NopStaticInst;
+thread_local StaticInstPtr StaticInst::nopStaticInstPtr = new NopStaticInst;
 
 using namespace std;
 
@@ -130,6 +130,12 @@ class StaticInst : public RefCounted, public StaticInstFlags
     bool _violator = false;
     uint64_t _violator_seqNum;
 
+    // replay counter decay, see FullO3CPU::countReplay()
+    uint64_t _lastReplay = 0;
+    uint32_t _cleanRetires = 0;
+    // hardware thread whose squash counted the last replay
+    ThreadID _lastReplayThread = InvalidThreadID;
+
     /// @name Register information.
     /// The sum of numFPDestRegs(), numIntDestRegs(), numVecDestRegs(),
     /// numVecElemDestRegs() and numVecPredDestRegs() equals numDestRegs().
@@ -233,6 +239,7 @@ class StaticInst : public RefCounted, public StaticInstFlags
     int32_t setReplays() { _replays = 1; return _replays; }
     int32_t incrReplays() { _replays += 1; return _replays; }
     int32_t decrReplays() { return _replays>0 ? _replays -= 1 :  _replays = 0; }
+    int32_t halveReplays() { return _replays >>= 1; }
 
 
     void setFirstMicroop() { flags[IsFirstMicroop] = true; }
@@ -256,7 +263,9 @@ class StaticInst : public RefCounted, public StaticInstFlags
     static StaticInstPtr nullStaticInstPtr;
 
     /// Pointer to a statically allocated generic "nop" instruction object.
-    static StaticInstPtr nopStaticInstPtr;
+    /// There is one per host thread so that reference counting stays
+    /// within the thread when CPUs run on separate event queues.
+    static thread_local StaticInstPtr nopStaticInstPtr;
 
     /// The binary machine instruction.
     const ExtMachInst machInst;
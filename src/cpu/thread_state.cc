@@ -92,7 +92,8 @@ ThreadState::initMemProxies(ThreadContext *tc)
         // itself is created in the base cpu constructor and the
         // getSendFunctional is a virtual function
         physProxy = new PortProxy(baseCpu->getSendFunctional(),
-                                  baseCpu->cacheLineSize());
+                                  baseCpu->cacheLineSize(),
+                                  baseCpu->getSendFunctionalBackdoor());
 
         assert(virtProxy == NULL);
         virtProxy = new TranslatingPortProxy(tc);
@@ -274,8 +274,8 @@ class DmaCallback : public Drainable
     Event *getChunkEvent()
     {
         ++count;
-        return new EventFunctionWrapper([this]{ chunkComplete(); }, name(),
-                                        true);
+        return new OneShotEvent([this]{ chunkComplete(); },
+                                "DmaCallback chunk");
     }
 };
 
@@ -892,7 +892,7 @@ ComputeUnit::DataPort::recvTimingResp(PacketPtr pkt)
         return true;
     }
 
-    EventFunctionWrapper *mem_resp_event =
+    Event *mem_resp_event =
         computeUnit->memPort[index].createMemRespEvent(pkt);
 
     DPRINTF(GPUPort,
@@ -1123,7 +1123,7 @@ ComputeUnit::sendRequest(GPUDynInstPtr gpuDynInst, PortID index, PacketPtr pkt)
 
             // translation is done. Schedule the mem_req_event at the
             // appropriate cycle to send the timing memory request to ruby
-            EventFunctionWrapper *mem_req_event =
+            Event *mem_req_event =
                 memPort[index].createMemReqEvent(pkt);
 
             DPRINTF(GPUPort, "CU%d: WF[%d][%d]: index %d, addr %#x data "
@@ -1252,7 +1252,7 @@ ComputeUnit::injectGlobalMemFence(GPUDynInstPtr gpuDynInst,
             pkt->pushSenderState(
                new ComputeUnit::DataPort::SenderState(gpuDynInst, 0, nullptr));
 
-            EventFunctionWrapper *mem_req_event =
+            Event *mem_req_event =
               memPort[0].createMemReqEvent(pkt);
 
             DPRINTF(GPUPort, "CU%d: WF[%d][%d]: index %d, addr %#x scheduling "
@@ -1272,7 +1272,7 @@ ComputeUnit::injectGlobalMemFence(GPUDynInstPtr gpuDynInst,
           pkt->pushSenderState(
              new ComputeUnit::DataPort::SenderState(gpuDynInst, 0, nullptr));
 
-          EventFunctionWrapper *mem_req_event =
+          Event *mem_req_event =
             memPort[0].createMemReqEvent(pkt);
 
           DPRINTF(GPUPort, "CU%d: WF[%d][%d]: index %d, addr %#x scheduling "
@@ -1290,7 +1290,7 @@ ComputeUnit::injectGlobalMemFence(GPUDynInstPtr gpuDynInst,
         pkt->pushSenderState(
             new ComputeUnit::DataPort::SenderState(gpuDynInst, 0, nullptr));
 
-        EventFunctionWrapper *mem_req_event =
+        Event *mem_req_event =
           memPort[0].createMemReqEvent(pkt);
 
         DPRINTF(GPUPort,
@@ -1541,7 +1541,7 @@ ComputeUnit::DTLBPort::recvTimingResp(PacketPtr pkt)
 
     // translation is done. Schedule the mem_req_event at the appropriate
     // cycle to send the timing memory request to ruby
-    EventFunctionWrapper *mem_req_event =
+    Event *mem_req_event =
         computeUnit->memPort[mp_index].createMemReqEvent(new_pkt);
 
     DPRINTF(GPUPort, "CU%d: WF[%d][%d]: index %d, addr %#x data scheduled\n",
@@ -1554,20 +1554,20 @@ ComputeUnit::DTLBPort::recvTimingResp(PacketPtr pkt)
     return true;
 }
 
-EventFunctionWrapper*
+Event*
 ComputeUnit::DataPort::createMemReqEvent(PacketPtr pkt)
 {
-    return new EventFunctionWrapper(
+    return new OneShotEvent(
         [this, pkt]{ processMemReqEvent(pkt); },
-        "ComputeUnit memory request event", true);
+        "ComputeUnit memory request event");
 }
 
-EventFunctionWrapper*
+Event*
 ComputeUnit::DataPort::createMemRespEvent(PacketPtr pkt)
 {
-    return new EventFunctionWrapper(
+    return new OneShotEvent(
         [this, pkt]{ processMemRespEvent(pkt); },
-        "ComputeUnit memory response event", true);
+        "ComputeUnit memory response event");
 }
 
 void
@@ -671,10 +671,10 @@ class ComputeUnit : public ClockedObject
         };
 
         void processMemReqEvent(PacketPtr pkt);
-        EventFunctionWrapper *createMemReqEvent(PacketPtr pkt);
+        Event *createMemReqEvent(PacketPtr pkt);
 
         void processMemRespEvent(PacketPtr pkt);
-        EventFunctionWrapper *createMemRespEvent(PacketPtr pkt);
+        Event *createMemRespEvent(PacketPtr pkt);
 
         std::deque<std::pair<PacketPtr, GPUDynInstPtr>> retries;
 
@@ -720,7 +720,7 @@ class ComputeUnit : public ClockedObject
             Packet::SenderState *saved;
         };
 
-        class MemReqEvent : public Event
+        class MemReqEvent : public PooledEvent
         {
           private:
             ScalarDataPort &scalarDataPort;
@@ -728,9 +728,8 @@ class ComputeUnit : public ClockedObject
 
           public:
             MemReqEvent(ScalarDataPort &_scalar_data_port, PacketPtr _pkt)
-                : Event(), scalarDataPort(_scalar_data_port), pkt(_pkt)
+                : scalarDataPort(_scalar_data_port), pkt(_pkt)
             {
-              setFlags(Event::AutoDelete);
             }
 
             void process();
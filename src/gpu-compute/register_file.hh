@@ -72,7 +72,7 @@ class RegisterFile : public SimObject
     virtual void markReg(int regIdx, bool value);
 
     // Abstract Register Event
-    class RegisterEvent : public Event
+    class RegisterEvent : public PooledEvent
     {
       protected:
         RegisterFile *rf;
@@ -80,7 +80,7 @@ class RegisterFile : public SimObject
 
       public:
         RegisterEvent(RegisterFile *_rf, int _regIdx)
-            : rf(_rf), regIdx(_regIdx) { setFlags(AutoDelete); }
+            : rf(_rf), regIdx(_regIdx) { }
     };
 
     // Register Event to mark a register as free in the scoreboard/busy vector
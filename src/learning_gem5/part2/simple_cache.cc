@@ -205,8 +205,8 @@ SimpleCache::handleRequest(PacketPtr pkt, int port_id)
     waitingPortId = port_id;
 
     // Schedule an event after cache access latency to actually access
-    schedule(new EventFunctionWrapper([this, pkt]{ accessTiming(pkt); },
-                                      name() + ".accessEvent", true),
+    schedule(new OneShotEvent([this, pkt]{ accessTiming(pkt); },
+                              params()->name.c_str()),
              clockEdge(latency));
 
     return true;
@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "arch/locked_mem.hh"
+#include "base/intmath.hh"
 #include "base/loader/memory_image.hh"
 #include "base/loader/object_file.hh"
 #include "cpu/base.hh"
@@ -59,6 +60,7 @@ AbstractMemory::AbstractMemory(const Params *p) :
     backdoor(params()->range, nullptr,
              (MemBackdoor::Flags)(MemBackdoor::Readable |
                                   MemBackdoor::Writeable)),
+    writtenPages(nullptr), backdoorWritten(false),
     confTableReported(p->conf_table_reported), inAddrMap(p->in_addr_map),
     kvmMap(p->kvm_map), _system(NULL),
     stats(*this)
@@ -99,8 +101,18 @@ AbstractMemory::initState()
     panic_if(!image.write(proxy), "%s: Unable to write image.");
 }
 
+WrittenPages::WrittenPages(size_t size, size_t page_bytes)
+    : pageShift(floorLog2(page_bytes)), pages(divCeil(size, page_bytes)),
+      words(new std::atomic<uint64_t>[divCeil(pages, 64)])
+{
+    assert(isPowerOf2(page_bytes));
+    for (size_t i = 0; i < divCeil(pages, 64); ++i)
+        words[i] = 0;
+}
+
 void
-AbstractMemory::setBackingStore(uint8_t* pmem_addr)
+AbstractMemory::setBackingStore(uint8_t* pmem_addr,
+                                WrittenPages *written_pages)
 {
     // If there was an existing backdoor, let everybody know it's going away.
     if (backdoor.ptr())
@@ -110,6 +122,19 @@ AbstractMemory::setBackingStore(uint8_t* pmem_addr)
     backdoor.ptr(range.interleaved() ? nullptr : pmem_addr);
 
     pmemAddr = pmem_addr;
+    writtenPages = written_pages;
+    backdoorWritten = false;
+}
+
+void
+AbstractMemory::markBackdoorWritten() const
+{
+    if (!writtenPages || backdoorWritten.load(std::memory_order_relaxed))
+        return;
+
+    // An interleaved range spans the whole backing store it shares.
+    markWritten(pmemAddr, range.end() - range.start());
+    backdoorWritten = true;
 }
 
 AbstractMemory::MemStats::MemStats(AbstractMemory &_mem)
@@ -393,6 +418,7 @@ AbstractMemory::access(PacketPtr pkt)
             if (pmemAddr) {
                 pkt->setData(host_addr);
                 (*(pkt->getAtomicOp()))(host_addr);
+                markWritten(host_addr, pkt->getSize());
             }
         } else {
             std::vector<uint8_t> overwrite_val(pkt->getSize());
@@ -421,8 +447,10 @@ AbstractMemory::access(PacketPtr pkt)
                     panic("Invalid size for conditional read/write\n");
             }
 
-            if (overwrite_mem)
+            if (overwrite_mem) {
                 std::memcpy(host_addr, &overwrite_val[0], pkt->getSize());
+                markWritten(host_addr, pkt->getSize());
+            }
 
             assert(!pkt->req->isInstFetch());
             TRACE_PACKET("Read/Write");
@@ -454,6 +482,7 @@ AbstractMemory::access(PacketPtr pkt)
         if (writeOK(pkt)) {
             if (pmemAddr) {
                 pkt->writeData(host_addr);
+                markWritten(host_addr, pkt->getSize());
                 DPRINTF(MemoryAccess, "%s write due to %s\n",
                         __func__, pkt->print());
             }
@@ -487,6 +516,7 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
     } else if (pkt->isWrite()) {
         if (pmemAddr) {
             pkt->writeData(host_addr);
+            markWritten(host_addr, pkt->getSize());
         }
         TRACE_PACKET("Write");
         pkt->makeResponse();
@@ -504,3 +534,20 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
               pkt->cmdString());
     }
 }
+
+bool
+AbstractMemory::functionalBackdoor(const AddrRange &r,
+                                   MemBackdoor::Flags access,
+                                   MemBackdoor &_backdoor) const
+{
+    if (!pmemAddr || !r.isSubset(range))
+        return false;
+
+    if (access & MemBackdoor::Writeable)
+        markBackdoorWritten();
+
+    _backdoor.range(range);
+    _backdoor.ptr(pmemAddr);
+    _backdoor.flags(access);
+    return true;
+}
@@ -46,6 +46,9 @@
 #ifndef __MEM_ABSTRACT_MEMORY_HH__
 #define __MEM_ABSTRACT_MEMORY_HH__
 
+#include <atomic>
+#include <memory>
+
 #include "mem/backdoor.hh"
 #include "mem/port.hh"
 #include "params/AbstractMemory.hh"
@@ -94,6 +97,53 @@ class LockedAddr {
     {}
 };
 
+/**
+ * Bitmap of the host pages of a backing store that have been written,
+ * which sparse checkpoints use to find the pages in use. Memories of an
+ * interleaved range share a backing store and may be accessed from
+ * different event queues, so bits are set atomically, but only after a
+ * plain load found them clear.
+ */
+class WrittenPages
+{
+  public:
+
+    WrittenPages(size_t size, size_t page_bytes);
+
+    /** Mark the pages overlapping [offset, offset + size) as written. */
+    void
+    mark(size_t offset, size_t size)
+    {
+        if (!size)
+            return;
+        const size_t last = (offset + size - 1) >> pageShift;
+        for (size_t page = offset >> pageShift; page <= last; ++page) {
+            std::atomic<uint64_t> &word = words[page / 64];
+            const uint64_t bit = 1ULL << (page % 64);
+            if (!(word.load(std::memory_order_relaxed) & bit))
+                word.fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+
+    /** Whether page has been written. */
+    bool
+    written(size_t page) const
+    {
+        return words[page / 64].load(std::memory_order_relaxed) &
+            (1ULL << (page % 64));
+    }
+
+    size_t pageBytes() const { return size_t(1) << pageShift; }
+
+    size_t numPages() const { return pages; }
+
+  private:
+
+    const unsigned pageShift;
+    const size_t pages;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+};
+
 /**
  * An abstract memory represents a contiguous block of physical
  * memory, with an associated address range, and also provides basic
@@ -114,6 +164,14 @@ class AbstractMemory : public ClockedObject
     // Backdoor to access this memory.
     MemBackdoor backdoor;
 
+    // Written pages of the backing store, or NULL if they are not
+    // tracked, see PhysicalMemory::createBackingStore()
+    WrittenPages *writtenPages;
+
+    // Whether the whole backing store has been marked as written
+    // because a back door that allows writes was handed out
+    mutable std::atomic<bool> backdoorWritten;
+
     // Enable specific memories to be reported to the configuration table
     const bool confTableReported;
 
@@ -224,8 +282,29 @@ class AbstractMemory : public ClockedObject
      * controller.
      *
      * @param pmem_addr Pointer to a segment of host memory
+     * @param written_pages Bitmap to record the written pages of the
+     *                      segment in, if they are tracked
      */
-    void setBackingStore(uint8_t* pmem_addr);
+    void setBackingStore(uint8_t* pmem_addr,
+                         WrittenPages *written_pages = nullptr);
+
+    /**
+     * Record a write of size bytes at host_addr, a pointer into the
+     * backing store, for sparse checkpoints.
+     */
+    void
+    markWritten(const uint8_t *host_addr, size_t size) const
+    {
+        if (writtenPages)
+            writtenPages->mark(host_addr - pmemAddr, size);
+    }
+
+    /**
+     * Record that the backing store may be written through a back door,
+     * which bypasses access() and functionalAccess(). As the writes
+     * cannot be seen, all pages are marked, once.
+     */
+    void markBackdoorWritten() const;
 
     /**
      * Get the list of locked addresses to allow checkpointing.
@@ -333,6 +412,18 @@ class AbstractMemory : public ClockedObject
      * @param pkt Packet performing the access
      */
     void functionalAccess(PacketPtr pkt);
+
+    /**
+     * Set up a back door for functional accesses of range, see
+     * FunctionalResponseProtocol::recvFunctionalBackdoor(). As memories
+     * with interleaved ranges share one backing store, the back door
+     * covers the whole range of this memory, interleaved or not.
+     *
+     * @return false if this memory has no backing store or range is not
+     *         completely within it
+     */
+    bool functionalBackdoor(const AddrRange &r, MemBackdoor::Flags access,
+                            MemBackdoor &_backdoor) const;
 };
 
 #endif //__MEM_ABSTRACT_MEMORY_HH__
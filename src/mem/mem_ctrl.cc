@@ -1353,6 +1353,18 @@ MemCtrl::recvFunctional(PacketPtr pkt)
    }
 }
 
+bool
+MemCtrl::recvFunctionalBackdoor(const AddrRange &range,
+                                MemBackdoor::Flags access,
+                                MemBackdoor &backdoor)
+{
+    // Writes update the backing store when they are accepted, and reads
+    // access it when they are serviced, so only the memories matter.
+    if (dram && dram->functionalBackdoor(range, access, backdoor))
+        return true;
+    return nvm && nvm->functionalBackdoor(range, access, backdoor);
+}
+
 Port &
 MemCtrl::getPort(const string &if_name, PortID idx)
 {
@@ -1455,6 +1467,17 @@ MemCtrl::MemoryPort::recvFunctional(PacketPtr pkt)
     pkt->popLabel();
 }
 
+bool
+MemCtrl::MemoryPort::recvFunctionalBackdoor(const AddrRange &range,
+                                            MemBackdoor::Flags access,
+                                            MemBackdoor &backdoor)
+{
+    // A functional write would also update the queued responses.
+    if ((access & MemBackdoor::Writeable) && queue.size())
+        return false;
+    return ctrl.recvFunctionalBackdoor(range, access, backdoor);
+}
+
 Tick
 MemCtrl::MemoryPort::recvAtomic(PacketPtr pkt)
 {
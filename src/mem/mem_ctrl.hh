@@ -255,6 +255,10 @@ class MemCtrl : public QoS::MemCtrl
 
         void recvFunctional(PacketPtr pkt);
 
+        bool recvFunctionalBackdoor(const AddrRange &range,
+                                    MemBackdoor::Flags access,
+                                    MemBackdoor &backdoor);
+
         bool recvTimingReq(PacketPtr);
 
         virtual AddrRangeList getAddrRanges() const;
@@ -702,6 +706,9 @@ class MemCtrl : public QoS::MemCtrl
 
     Tick recvAtomic(PacketPtr pkt);
     void recvFunctional(PacketPtr pkt);
+    bool recvFunctionalBackdoor(const AddrRange &range,
+                                MemBackdoor::Flags access,
+                                MemBackdoor &backdoor);
     bool recvTimingReq(PacketPtr pkt);
 
 };
@@ -56,6 +56,7 @@
 #include "base/compiler.hh"
 #include "base/flags.hh"
 #include "base/logging.hh"
+#include "base/pool_alloc.hh"
 #include "base/printable.hh"
 #include "base/types.hh"
 #include "mem/htm.hh"
@@ -316,6 +317,9 @@ class Packet : public Printable
         /// the packet is destroyed. The pointer is assumed to be pointing
         /// to an array, and delete [] is consequently called
         DYNAMIC_DATA           = 0x00002000,
+        /// Set together with DYNAMIC_DATA if the data was allocated by
+        /// allocate() from the PoolAlloc pools and must be returned there
+        POOLED_DATA            = 0x00004000,
 
         /// suppress the error if this packet encounters a functional
         /// access failure.
@@ -323,7 +327,11 @@ class Packet : public Printable
 
         // Signal block present to squash prefetch and cache evict packets
         // through express snoop flag
-        BLOCK_CACHED          = 0x00010000
+        BLOCK_CACHED          = 0x00010000,
+
+        // A Request::DEFER_REPLACEMENT load that missed in the L1. It
+        // carries no data and the requestor has to issue it again.
+        DEFERRED_MISS          = 0x00020000
     };
 
     Flags flags;
@@ -719,6 +727,8 @@ class Packet : public Printable
     void setBlockCached()          { flags.set(BLOCK_CACHED); }
     bool isBlockCached() const     { return flags.isSet(BLOCK_CACHED); }
     void clearBlockCached()        { flags.clear(BLOCK_CACHED); }
+    void setDeferredMiss()         { flags.set(DEFERRED_MISS); }
+    bool isDeferredMiss() const    { return flags.isSet(DEFERRED_MISS); }
 
     /**
      * QoS Value getter
@@ -996,6 +1006,19 @@ class Packet : public Printable
         deleteData();
     }
 
+    /** Packets are recycled through the per-thread PoolAlloc pools. */
+    static void *
+    operator new(size_t size)
+    {
+        return PoolAlloc::allocate(size);
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        PoolAlloc::deallocate(p, size);
+    }
+
     /**
      * Take a request packet and modify it in place to be suitable for
      * returning as a response to that request.
@@ -1287,10 +1310,12 @@ class Packet : public Printable
     void
     deleteData()
     {
-        if (flags.isSet(DYNAMIC_DATA))
+        if (flags.isSet(POOLED_DATA))
+            PoolAlloc::deallocate(data, getSize());
+        else if (flags.isSet(DYNAMIC_DATA))
             delete [] data;
 
-        flags.clear(STATIC_DATA|DYNAMIC_DATA);
+        flags.clear(STATIC_DATA|DYNAMIC_DATA|POOLED_DATA);
         data = NULL;
     }
 
@@ -1302,8 +1327,8 @@ class Packet : public Printable
         // payload, actually allocate space
         if (hasData() || hasRespData()) {
             assert(flags.noneSet(STATIC_DATA|DYNAMIC_DATA));
-            flags.set(DYNAMIC_DATA);
-            data = new uint8_t[getSize()];
+            flags.set(DYNAMIC_DATA|POOLED_DATA);
+            data = static_cast<uint8_t *>(PoolAlloc::allocate(getSize()));
         }
     }
 
@@ -189,6 +189,10 @@ EmulationPageTable::unserialize(CheckpointIn &cp)
     ScopedCheckpointSection sec(cp, "ptable");
     paramIn(cp, "size", count);
 
+    // Drop mappings made since the checkpoint when rewinding to a
+    // snapshot.
+    pTable.clear();
+
     for (int i = 0; i < count; ++i) {
         ScopedCheckpointSection sec(cp, csprintf("Entry%d", i));
 
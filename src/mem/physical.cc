@@ -44,16 +44,21 @@
 #include <unistd.h>
 #include <zlib.h>
 
+#include <atomic>
 #include <cerrno>
 #include <climits>
+#include <csignal>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
 #include "mem/abstract_mem.hh"
+#include "sim/snapshot.hh"
 
 /**
  * On Linux, MAP_NORESERVE allow us to simulate a very large memory
@@ -67,14 +72,135 @@
 #endif
 #endif
 
+/**
+ * The element type of the vector filled by mincore.
+ */
+#if defined(__APPLE__) || defined(__FreeBSD__)
+typedef char MincoreVec;
+#else
+typedef unsigned char MincoreVec;
+#endif
+
 using namespace std;
 
+/**
+ * A backing store that is write-protected while a snapshot is held. The
+ * fault handler below saves a page into the shadow copy the first time
+ * it is written, which may happen on any simulation thread, so the page
+ * states are atomic and the handler does not allocate.
+ */
+struct SnapshotStore
+{
+    enum PageState : uint8_t { Clean, Saving, Dirty };
+
+    uint8_t *pmem;
+    size_t size;
+    uint8_t *shadow;
+    std::unique_ptr<std::atomic<uint8_t>[]> pages;
+    size_t numPages;
+};
+
+namespace
+{
+
+const size_t MaxSnapshotStores = 64;
+
+size_t snapshotPageBytes;
+SnapshotStore *activeStores[MaxSnapshotStores];
+std::atomic<size_t> numActiveStores(0);
+struct sigaction previousSegvAction;
+
+void
+snapshotFaultHandler(int sig, siginfo_t *info, void *context)
+{
+    uint8_t *addr = static_cast<uint8_t *>(info->si_addr);
+    size_t num_stores = numActiveStores.load(std::memory_order_acquire);
+    for (size_t i = 0; i < num_stores; i++) {
+        SnapshotStore &s = *activeStores[i];
+        if (addr < s.pmem || addr >= s.pmem + s.size)
+            continue;
+
+        size_t page = (addr - s.pmem) / snapshotPageBytes;
+        size_t offset = page * snapshotPageBytes;
+        size_t bytes = std::min(snapshotPageBytes, s.size - offset);
+        uint8_t state = SnapshotStore::Clean;
+        if (s.pages[page].compare_exchange_strong(state,
+                                                  SnapshotStore::Saving)) {
+            memcpy(s.shadow + offset, s.pmem + offset, bytes);
+            if (mprotect(s.pmem + offset, bytes, PROT_READ | PROT_WRITE))
+                abort();
+            s.pages[page].store(SnapshotStore::Dirty);
+        }
+        // Return to retry the write. A thread that lost the race above
+        // faults again until the page has been unprotected.
+        return;
+    }
+
+    // Not a snapshot page, let the previous handler deal with the fault
+    // when the access is retried.
+    sigaction(SIGSEGV, &previousSegvAction, nullptr);
+}
+
+void
+installSnapshotFaultHandler()
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = snapshotFaultHandler;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER | SA_ONSTACK;
+
+    struct sigaction current;
+    sigaction(SIGSEGV, nullptr, &current);
+    if (current.sa_sigaction == snapshotFaultHandler)
+        return;
+    if (sigaction(SIGSEGV, &sa, &previousSegvAction) == -1)
+        panic("Failed to install the snapshot page fault handler\n");
+}
+
+/**
+ * Query which host pages of a backing store are resident. Pages that
+ * were never touched are not, and neither are pages that were only
+ * read on some hosts or that were swapped out, so this measures host
+ * memory use rather than which pages are in use.
+ */
+vector<MincoreVec>
+residentPages(uint8_t *pmem, size_t size)
+{
+    const size_t page_bytes = sysconf(_SC_PAGESIZE);
+    vector<MincoreVec> resident(divCeil(size, page_bytes));
+    if (mincore(pmem, size, resident.data())) {
+        // Without the information, assume every page is in use.
+        warn_once("mincore failed, cannot tell untouched pages apart\n");
+        fill(resident.begin(), resident.end(), 1);
+    }
+    return resident;
+}
+
+bool
+isZeroPage(const uint8_t *page, size_t bytes)
+{
+    const uint64_t *words = reinterpret_cast<const uint64_t *>(page);
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); i++) {
+        if (words[i])
+            return false;
+    }
+    for (size_t i = bytes & ~(sizeof(uint64_t) - 1); i < bytes; i++) {
+        if (page[i])
+            return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve,
-                               const std::string& shared_backstore) :
+                               const std::string& shared_backstore,
+                               bool sparse_backstore) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
-    sharedBackstore(shared_backstore)
+    sharedBackstore(shared_backstore), sparseBackstore(sparse_backstore)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -213,8 +339,8 @@ PhysicalMemory::createBackingStore(AddrRange range,
     }
 
     // to be able to simulate very large memories, the user can opt to
-    // pass noreserve to mmap
-    if (mmapUsingNoReserve) {
+    // pass noreserve to mmap, which a sparse backing store implies
+    if (mmapUsingNoReserve || sparseBackstore) {
         map_flags |= MAP_NORESERVE;
     }
 
@@ -228,21 +354,34 @@ PhysicalMemory::createBackingStore(AddrRange range,
               range.to_string());
     }
 
+    // sparse stores keep track of the pages written, as pages the host
+    // has resident are not necessarily in use, and pages that are in
+    // use may have been swapped out
+    WrittenPages *written_pages = nullptr;
+    if (sparseBackstore) {
+        writtenPages.emplace_back(
+            new WrittenPages(range.size(), sysconf(_SC_PAGESIZE)));
+        written_pages = writtenPages.back().get();
+    }
+
     // remember this backing store so we can checkpoint it and unmap
     // it appropriately
     backingStore.emplace_back(range, pmem,
-                              conf_table_reported, in_addr_map, kvm_map);
+                              conf_table_reported, in_addr_map, kvm_map,
+                              written_pages);
 
     // point the memories to their backing store
     for (const auto& m : _memories) {
         DPRINTF(AddrRanges, "Mapping memory %s to backing store\n",
                 m->name());
-        m->setBackingStore(pmem);
+        m->setBackingStore(pmem, written_pages);
     }
 }
 
 PhysicalMemory::~PhysicalMemory()
 {
+    releaseSnapshot();
+
     // unmap the backing store
     for (auto& s : backingStore)
         munmap((char*)s.pmem, s.range.size());
@@ -326,15 +465,20 @@ PhysicalMemory::serialize(CheckpointOut &cp) const
     SERIALIZE_CONTAINER(lal_addr);
     SERIALIZE_CONTAINER(lal_cid);
 
-    // serialize the backing stores
-    unsigned int nbr_of_stores = backingStore.size();
+    // serialize the backing stores, unless they are tracked by an
+    // in-process snapshot
+    unsigned int nbr_of_stores =
+        Snapshot::capturing() ? 0 : backingStore.size();
     SERIALIZE_SCALAR(nbr_of_stores);
 
-    unsigned int store_id = 0;
     // store each backing store memory segment in a file
-    for (auto& s : backingStore) {
+    for (unsigned int store_id = 0; store_id < nbr_of_stores; ++store_id) {
+        const auto& s = backingStore[store_id];
         ScopedCheckpointSection sec(cp, csprintf("store%d", store_id));
-        serializeStore(cp, store_id++, s.range, s.pmem);
+        if (sparseBackstore)
+            serializeSparseStore(cp, store_id, s);
+        else
+            serializeStore(cp, store_id, s.range, s.pmem);
     }
 }
 
@@ -384,6 +528,58 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 
 }
 
+void
+PhysicalMemory::serializeSparseStore(CheckpointOut &cp,
+                                     unsigned int store_id,
+                                     const BackingStoreEntry &store) const
+{
+    const AddrRange &range = store.range;
+    const uint8_t *pmem = store.pmem;
+    const WrittenPages &written = *store.writtenPages;
+
+    string filename = name() + ".store" + to_string(store_id) + ".pmem";
+    long range_size = range.size();
+    bool sparse = true;
+    uint64_t page_bytes = written.pageBytes();
+
+    SERIALIZE_SCALAR(store_id);
+    SERIALIZE_SCALAR(filename);
+    SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(sparse);
+    SERIALIZE_SCALAR(page_bytes);
+
+    string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+    gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filename);
+
+    // Each page in use is written as its 64-bit offset followed by its
+    // content; pages that were never written or are zero are left out.
+    uint64_t pages_written = 0;
+    for (uint64_t page = 0; page < written.numPages(); page++) {
+        uint64_t offset = page * page_bytes;
+        uint64_t bytes = min(page_bytes, range.size() - offset);
+        if (!written.written(page) || isZeroPage(pmem + offset, bytes))
+            continue;
+
+        if (gzwrite(compressed_mem, &offset, sizeof(offset)) !=
+                sizeof(offset) ||
+            gzwrite(compressed_mem, pmem + offset, bytes) != (int)bytes) {
+            fatal("Write failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        }
+        pages_written++;
+    }
+
+    DPRINTF(Checkpoint, "Serialized %d of %d pages of physical memory %s\n",
+            pages_written, written.numPages(), filename);
+
+    if (gzclose(compressed_mem))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filename);
+}
+
 void
 PhysicalMemory::unserialize(CheckpointIn &cp)
 {
@@ -429,6 +625,7 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
     AddrRange range = backingStore[store_id].range;
+    WrittenPages *written_pages = backingStore[store_id].writtenPages;
 
     long range_size;
     UNSERIALIZE_SCALAR(range_size);
@@ -440,6 +637,35 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    // Sparse stores only hold the pages in use, the others are left
+    // untouched so that they need no host memory.
+    bool sparse = false;
+    UNSERIALIZE_OPT_SCALAR(sparse);
+    if (sparse) {
+        uint64_t page_bytes;
+        UNSERIALIZE_SCALAR(page_bytes);
+
+        uint64_t offset;
+        while (gzread(compressed_mem, &offset, sizeof(offset)) ==
+               sizeof(offset)) {
+            fatal_if(offset >= range.size(), "Page offset %#x outside of "
+                     "physical memory checkpoint file '%s'\n", offset,
+                     filename);
+            int bytes = min(page_bytes, range.size() - offset);
+            if (gzread(compressed_mem, pmem + offset, bytes) != bytes) {
+                fatal("Read failed on physical memory checkpoint file "
+                      "'%s'\n", filename);
+            }
+            if (written_pages)
+                written_pages->mark(offset, bytes);
+        }
+
+        if (gzclose(compressed_mem))
+            fatal("Close failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        return;
+    }
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
@@ -457,6 +683,9 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
             if (*(temp_page + x) != 0) {
                 pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
                 *pmem_current = *(temp_page + x);
+                if (written_pages)
+                    written_pages->mark(curr_size + x * sizeof(long),
+                                        sizeof(long));
             }
         }
         curr_size += bytes_read;
@@ -468,3 +697,106 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Close failed on physical memory checkpoint file '%s'\n",
               filename);
 }
+
+uint64_t
+PhysicalMemory::residentSize() const
+{
+    const uint64_t page_bytes = sysconf(_SC_PAGESIZE);
+    uint64_t resident_bytes = 0;
+    for (auto& s : backingStore) {
+        for (MincoreVec page : residentPages(s.pmem, s.range.size()))
+            resident_bytes += (page & 1) * page_bytes;
+    }
+    return resident_bytes;
+}
+
+void
+PhysicalMemory::takeSnapshot()
+{
+    releaseSnapshot();
+
+    snapshotPageBytes = sysconf(_SC_PAGESIZE);
+    for (auto& b : backingStore) {
+        fatal_if(numActiveStores == MaxSnapshotStores,
+                 "Too many backing stores for a snapshot\n");
+
+        auto store = std::unique_ptr<SnapshotStore>(new SnapshotStore);
+        store->pmem = b.pmem;
+        store->size = b.range.size();
+        store->numPages = divCeil(store->size, snapshotPageBytes);
+        store->pages.reset(new std::atomic<uint8_t>[store->numPages]);
+        for (size_t i = 0; i < store->numPages; i++)
+            store->pages[i] = SnapshotStore::Clean;
+        store->shadow = (uint8_t *)mmap(NULL, store->size,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_ANON | MAP_PRIVATE |
+                                        MAP_NORESERVE, -1, 0);
+        if (store->shadow == (uint8_t *)MAP_FAILED) {
+            perror("mmap");
+            fatal("Could not mmap %d bytes for a snapshot of %s\n",
+                  store->size, b.range.to_string());
+        }
+
+        activeStores[numActiveStores] = store.get();
+        numActiveStores.fetch_add(1, std::memory_order_release);
+        snapshotStores.push_back(std::move(store));
+    }
+
+    installSnapshotFaultHandler();
+    for (auto& store : snapshotStores) {
+        if (mprotect(store->pmem, store->size, PROT_READ))
+            fatal("Could not write-protect %s for a snapshot\n", name());
+    }
+    DPRINTF(Checkpoint, "Snapshot of %s taken\n", name());
+}
+
+void
+PhysicalMemory::rewindSnapshot()
+{
+    size_t restored = 0;
+    for (auto& store : snapshotStores) {
+        for (size_t page = 0; page < store->numPages; page++) {
+            if (store->pages[page] != SnapshotStore::Dirty)
+                continue;
+            size_t offset = page * snapshotPageBytes;
+            size_t bytes = std::min(snapshotPageBytes, store->size - offset);
+            memcpy(store->pmem + offset, store->shadow + offset, bytes);
+            if (mprotect(store->pmem + offset, bytes, PROT_READ))
+                fatal("Could not write-protect %s for a snapshot\n", name());
+            store->pages[page] = SnapshotStore::Clean;
+            restored++;
+        }
+    }
+    DPRINTF(Checkpoint, "Rewound %s, %d pages restored\n", name(),
+            restored);
+}
+
+void
+PhysicalMemory::releaseSnapshot()
+{
+    for (auto& store : snapshotStores) {
+        mprotect(store->pmem, store->size, PROT_READ | PROT_WRITE);
+        munmap(store->shadow, store->size);
+
+        size_t n = numActiveStores;
+        for (size_t i = 0; i < n; i++) {
+            if (activeStores[i] == store.get()) {
+                activeStores[i] = activeStores[n - 1];
+                numActiveStores = n - 1;
+                break;
+            }
+        }
+    }
+    snapshotStores.clear();
+}
+
+size_t
+PhysicalMemory::snapshotDirtyPages() const
+{
+    size_t dirty = 0;
+    for (auto& store : snapshotStores) {
+        for (size_t page = 0; page < store->numPages; page++)
+            dirty += store->pages[page] == SnapshotStore::Dirty;
+    }
+    return dirty;
+}
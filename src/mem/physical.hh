@@ -38,6 +38,8 @@
 #ifndef __MEM_PHYSICAL_HH__
 #define __MEM_PHYSICAL_HH__
 
+#include <memory>
+
 #include "base/addr_range_map.hh"
 #include "mem/packet.hh"
 
@@ -45,6 +47,8 @@
  * Forward declaration to avoid header dependencies.
  */
 class AbstractMemory;
+struct SnapshotStore;
+class WrittenPages;
 
 /**
  * A single entry for the backing store.
@@ -58,9 +62,11 @@ class BackingStoreEntry
      * pointers, because PhysicalMemory is responsible for that.
      */
     BackingStoreEntry(AddrRange range, uint8_t* pmem,
-                      bool conf_table_reported, bool in_addr_map, bool kvm_map)
+                      bool conf_table_reported, bool in_addr_map, bool kvm_map,
+                      WrittenPages *written_pages = nullptr)
         : range(range), pmem(pmem), confTableReported(conf_table_reported),
-          inAddrMap(in_addr_map), kvmMap(kvm_map)
+          inAddrMap(in_addr_map), kvmMap(kvm_map),
+          writtenPages(written_pages)
         {}
 
     /**
@@ -89,6 +95,12 @@ class BackingStoreEntry
       * acceleration.
       */
      bool kvmMap;
+
+     /**
+      * The pages written so far if the store is sparse, or NULL. Users
+      * that write the memory directly, like KVM, mark what they write.
+      */
+     WrittenPages *writtenPages;
 };
 
 /**
@@ -129,10 +141,21 @@ class PhysicalMemory : public Serializable
 
     const std::string sharedBackstore;
 
+    // Only store the pages in use in checkpoints
+    const bool sparseBackstore;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
 
+    // Write-protection state of the backing stores while a snapshot is
+    // held, see takeSnapshot()
+    std::vector<std::unique_ptr<SnapshotStore>> snapshotStores;
+
+    // Pages of the sparse backing stores the simulation has written,
+    // which are the only ones checkpoints need to look at
+    std::vector<std::unique_ptr<WrittenPages>> writtenPages;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -161,7 +184,8 @@ class PhysicalMemory : public Serializable
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
-                   const std::string& shared_backstore);
+                   const std::string& shared_backstore,
+                   bool sparse_backstore = false);
 
     /**
      * Unmap all the backing store we have used.
@@ -200,6 +224,14 @@ class PhysicalMemory : public Serializable
      */
     uint64_t totalSize() const { return size; }
 
+    /**
+     * Get the number of bytes of the backing store that are backed by
+     * host memory, i.e., that the simulation has touched so far.
+     *
+     * @return The resident size of all backing stores
+     */
+    uint64_t residentSize() const;
+
      /**
      * Get the pointers to the backing store for external host
      * access. Note that memory in the guest should be accessed using
@@ -254,6 +286,14 @@ class PhysicalMemory : public Serializable
     void serializeStore(CheckpointOut &cp, unsigned int store_id,
                         AddrRange range, uint8_t* pmem) const;
 
+    /**
+     * Write only the non-zero pages of a store that have been written,
+     * each preceded by its offset. Used instead of serializeStore() for
+     * sparse backing stores.
+     */
+    void serializeSparseStore(CheckpointOut &cp, unsigned int store_id,
+                              const BackingStoreEntry &store) const;
+
     /**
      * Unserialize the memories in the system. As with the
      * serialization, this action is independent of how the address
@@ -266,6 +306,29 @@ class PhysicalMemory : public Serializable
      */
     void unserializeStore(CheckpointIn &cp);
 
+    /**
+     * Start tracking changes to the backing stores for an in-process
+     * snapshot. The stores are write-protected, and the first write to
+     * a page saves its original content before the page is unprotected
+     * again, so the cost of a snapshot is proportional to the number of
+     * pages written afterwards. While a snapshot is being captured
+     * (Snapshot::capturing()) serialize() leaves the stores out.
+     */
+    void takeSnapshot();
+
+    /**
+     * Copy the saved content back into the pages written since the
+     * snapshot or the last rewind and protect them again. The snapshot
+     * stays valid, so the same point can be returned to repeatedly.
+     */
+    void rewindSnapshot();
+
+    /** Stop tracking changes and free the saved pages. */
+    void releaseSnapshot();
+
+    /** Pages written since the snapshot was taken or last rewound. */
+    size_t snapshotDirtyPages() const;
+
 };
 
 #endif //__MEM_PHYSICAL_HH__
@@ -158,6 +158,39 @@ class RequestPort: public Port, public AtomicRequestProtocol,
      */
     void sendFunctional(PacketPtr pkt) const;
 
+    /**
+     * Ask the responder for a back door to do a functional access of
+     * range directly in host memory.
+     *
+     * @param range Guest physical range to access.
+     * @param access Kind of access, i.e., Readable and/or Writeable.
+     * @param backdoor Set up by the responder on success.
+     *
+     * @return If the responder granted the back door.
+     */
+    bool sendFunctionalBackdoor(const AddrRange &range,
+                                MemBackdoor::Flags access,
+                                MemBackdoor &backdoor) const;
+
+    /**
+     * Ask the responder if a timing access like pkt would hit in the
+     * first level cache, without changing any state. With touch,
+     * apply the replacement update of an access that was sent with
+     * Request::DEFER_REPLACEMENT instead.
+     *
+     * @param pkt Request packet describing the access.
+     * @param touch Update the replacement state instead of probing.
+     *
+     * @return If the access hits; false if nobody can tell.
+     */
+    bool sendFunctionalProbe(PacketPtr pkt, bool touch=false) const;
+
+    /**
+     * Ask if the responder answers sendFunctionalProbe() from a first
+     * level cache, rather than reporting a miss for every access.
+     */
+    bool isFunctionalProbeSupported() const;
+
   public:
     /* The timing protocol. */
 
@@ -488,6 +521,39 @@ RequestPort::sendFunctional(PacketPtr pkt) const
     }
 }
 
+inline bool
+RequestPort::sendFunctionalBackdoor(const AddrRange &range,
+                                    MemBackdoor::Flags access,
+                                    MemBackdoor &backdoor) const
+{
+    try {
+        return FunctionalRequestProtocol::sendBackdoor(_responsePort, range,
+                                                       access, backdoor);
+    } catch (UnboundPortException) {
+        reportUnbound();
+    }
+}
+
+inline bool
+RequestPort::sendFunctionalProbe(PacketPtr pkt, bool touch) const
+{
+    try {
+        return FunctionalRequestProtocol::sendProbe(_responsePort, pkt, touch);
+    } catch (UnboundPortException) {
+        reportUnbound();
+    }
+}
+
+inline bool
+RequestPort::isFunctionalProbeSupported() const
+{
+    try {
+        return FunctionalRequestProtocol::sendProbeSupported(_responsePort);
+    } catch (UnboundPortException) {
+        reportUnbound();
+    }
+}
+
 inline bool
 RequestPort::sendTimingReq(PacketPtr pkt)
 {
@@ -81,10 +81,19 @@ class PortProxy : FunctionalRequestProtocol
 {
   public:
     typedef std::function<void(PacketPtr pkt)> SendFunctionalFunc;
+    typedef std::function<bool(const AddrRange &range,
+                               MemBackdoor::Flags access,
+                               MemBackdoor &backdoor)> SendBackdoorFunc;
 
   private:
     SendFunctionalFunc sendFunctional;
 
+    /**
+     * Optional request for a functional back door, tried for accesses
+     * without request flags that span more than one cache line.
+     */
+    SendBackdoorFunc sendBackdoor;
+
     /** Granularity of any transactions issued through this proxy. */
     const unsigned int _cacheLineSize;
 
@@ -96,13 +105,28 @@ class PortProxy : FunctionalRequestProtocol
         panic("Port proxies should never receive snoops.");
     }
 
+    /**
+     * Return the host address of the size bytes at physical address
+     * addr if the access has no request flags and the peer grants a
+     * back door for them, nullptr otherwise.
+     */
+    uint8_t *tryBackdoor(Addr addr, Request::Flags flags, int size,
+                         MemBackdoor::Flags access) const;
+
   public:
-    PortProxy(SendFunctionalFunc func, unsigned int cacheLineSize) :
-        sendFunctional(func), _cacheLineSize(cacheLineSize)
+    PortProxy(SendFunctionalFunc func, unsigned int cacheLineSize,
+              SendBackdoorFunc backdoor=nullptr) :
+        sendFunctional(func), sendBackdoor(backdoor),
+        _cacheLineSize(cacheLineSize)
     {}
     PortProxy(const RequestPort &port, unsigned int cacheLineSize) :
         sendFunctional([&port](PacketPtr pkt)->void {
                 port.sendFunctional(pkt);
+            }),
+        sendBackdoor([&port](const AddrRange &range,
+                             MemBackdoor::Flags access,
+                             MemBackdoor &backdoor)->bool {
+                return port.sendFunctionalBackdoor(range, access, backdoor);
             }), _cacheLineSize(cacheLineSize)
     {}
     virtual ~PortProxy() { }
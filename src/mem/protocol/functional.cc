@@ -50,6 +50,29 @@ FunctionalRequestProtocol::send(
     return peer->recvFunctional(pkt);
 }
 
+bool
+FunctionalRequestProtocol::sendBackdoor(
+        FunctionalResponseProtocol *peer, const AddrRange &range,
+        MemBackdoor::Flags access, MemBackdoor &backdoor) const
+{
+    return peer->recvFunctionalBackdoor(range, access, backdoor);
+}
+
+bool
+FunctionalRequestProtocol::sendProbe(
+        FunctionalResponseProtocol *peer, PacketPtr pkt, bool touch) const
+{
+    assert(pkt->isRequest());
+    return peer->recvFunctionalProbe(pkt, touch);
+}
+
+bool
+FunctionalRequestProtocol::sendProbeSupported(
+        FunctionalResponseProtocol *peer) const
+{
+    return peer->recvFunctionalProbeSupported();
+}
+
 /* The response protocol. */
 
 void
@@ -41,6 +41,8 @@
 #ifndef __MEM_GEM5_PROTOCOL_FUNCTIONAL_HH__
 #define __MEM_GEM5_PROTOCOL_FUNCTIONAL_HH__
 
+#include "base/addr_range.hh"
+#include "mem/backdoor.hh"
 #include "mem/packet.hh"
 
 class FunctionalResponseProtocol;
@@ -59,6 +61,37 @@ class FunctionalRequestProtocol
      */
     void send(FunctionalResponseProtocol *peer, PacketPtr pkt) const;
 
+    /**
+     * Ask for direct access to the host memory holding range, so that a
+     * functional access of it can be done without packets.
+     *
+     * @param range Guest physical range to access.
+     * @param access Kind of access, i.e., Readable and/or Writeable.
+     * @param backdoor Set up by the peer on success.
+     *
+     * @return If the peer granted the back door.
+     */
+    bool sendBackdoor(FunctionalResponseProtocol *peer,
+                      const AddrRange &range, MemBackdoor::Flags access,
+                      MemBackdoor &backdoor) const;
+
+    /**
+     * Ask if a timing access like pkt would hit in the first level
+     * cache, or apply its deferred replacement update.
+     *
+     * @param pkt Request packet describing the access.
+     * @param touch Update the replacement state instead of probing.
+     *
+     * @return If the access hits.
+     */
+    bool sendProbe(FunctionalResponseProtocol *peer, PacketPtr pkt,
+                   bool touch) const;
+
+    /**
+     * Ask if the peer answers sendProbe() from a first level cache.
+     */
+    bool sendProbeSupported(FunctionalResponseProtocol *peer) const;
+
     /**
      * Receive a functional snoop request packet from the peer.
      */
@@ -83,6 +116,46 @@ class FunctionalResponseProtocol
      * Receive a functional request packet from the peer.
      */
     virtual void recvFunctional(PacketPtr pkt) = 0;
+
+    /**
+     * Receive a request for a functional back door from the peer. On
+     * success, backdoor.ptr() is the host address of
+     * backdoor.range().start(), every address of range is within
+     * backdoor.range() and may be accessed through the pointer, and
+     * doing so is equivalent to a functional access. Unlike the back
+     * doors of the atomic protocol, this one is only valid until the
+     * simulation proceeds, as the owner of the data may change with the
+     * next event. The default implementation refuses, so functional
+     * packets are used instead.
+     */
+    virtual bool
+    recvFunctionalBackdoor(const AddrRange &range, MemBackdoor::Flags access,
+                           MemBackdoor &backdoor)
+    {
+        return false;
+    }
+
+    /**
+     * Receive a cache probe from the peer. Without touch, report if a
+     * timing access like pkt would hit in the first level cache behind
+     * this port right now, without changing the state of any block,
+     * including its replacement state. With touch, update the
+     * replacement state of the block as the access would have, if it
+     * is still present; this completes an access that was sent with
+     * Request::DEFER_REPLACEMENT. The default implementation has no
+     * cache to look at and reports a miss.
+     */
+    virtual bool
+    recvFunctionalProbe(PacketPtr pkt, bool touch)
+    {
+        return false;
+    }
+
+    /**
+     * Report if recvFunctionalProbe() looks at a first level cache. The
+     * default implementation has none.
+     */
+    virtual bool recvFunctionalProbeSupported() const { return false; }
 };
 
 #endif //__MEM_GEM5_PROTOCOL_FUNCTIONAL_HH__
@@ -50,10 +50,13 @@
 
 #include <cassert>
 #include <climits>
+#include <memory>
+#include <utility>
 
 #include "base/amo.hh"
 #include "base/flags.hh"
 #include "base/logging.hh"
+#include "base/pool_alloc.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "mem/htm.hh"
@@ -84,6 +87,18 @@ class ThreadContext;
 typedef std::shared_ptr<Request> RequestPtr;
 typedef uint16_t RequestorID;
 
+/**
+ * Drop-in replacement for std::make_shared<Request>() that takes the
+ * request and its control block from the per-thread PoolAlloc pools.
+ */
+template <typename... Args>
+inline RequestPtr
+makeRequest(Args&&... args)
+{
+    return std::allocate_shared<Request>(PoolAllocator<Request>(),
+                                         std::forward<Args>(args)...);
+}
+
 class Request
 {
   public:
@@ -153,6 +168,12 @@ class Request
         PF_EXCLUSIVE                = 0x02000000,
         /** The request should be marked as LRU. */
         EVICT_NEXT                  = 0x04000000,
+        /**
+         * The request must not update the replacement state of the
+         * first level cache; the CPU applies the update later with a
+         * functional probe, see RequestPort::sendFunctionalProbe().
+         */
+        DEFER_REPLACEMENT           = 0x00002000,
         /** The request should be marked with ACQUIRE. */
         ACQUIRE                     = 0x00020000,
         /** The request should be marked with RELEASE. */
@@ -536,8 +557,8 @@ class Request
         assert(privateFlags.isSet(VALID_VADDR));
         assert(privateFlags.noneSet(VALID_PADDR));
         assert(split_addr > _vaddr && split_addr < _vaddr + _size);
-        req1 = std::make_shared<Request>(*this);
-        req2 = std::make_shared<Request>(*this);
+        req1 = makeRequest(*this);
+        req2 = makeRequest(*this);
         req1->_size = split_addr - _vaddr;
         req2->_vaddr = split_addr;
         req2->_size = _size - req1->_size;
@@ -892,6 +913,7 @@ class Request
     bool isPrefetch() const { return (_flags.isSet(PREFETCH) ||
                                       _flags.isSet(PF_EXCLUSIVE)); }
     bool isPrefetchEx() const { return _flags.isSet(PF_EXCLUSIVE); }
+    bool isDeferReplacement() const { return _flags.isSet(DEFER_REPLACEMENT); }
     bool isLLSC() const { return _flags.isSet(LLSC); }
     bool isPriv() const { return _flags.isSet(PRIVILEGED); }
     bool isLockedRMW() const { return _flags.isSet(LOCKED_RMW); }
@@ -41,15 +41,15 @@ Consumer::scheduleEventAbsolute(Tick evt_time)
 {
     if (!alreadyScheduled(evt_time)) {
         // This wakeup is not redundant
-        auto *evt = new EventFunctionWrapper(
-            [this]{ wakeup(); }, "Consumer Event", true);
+        auto *evt = new OneShotEvent([this]{ wakeup(); }, "Consumer Event");
 
         em->schedule(evt, evt_time);
         insertScheduledWakeupTime(evt_time);
     }
 
     Tick t = em->clockEdge();
-    set<Tick>::iterator bit = m_scheduled_wakeups.begin();
-    set<Tick>::iterator eit = m_scheduled_wakeups.lower_bound(t);
-    m_scheduled_wakeups.erase(bit,eit);
+    m_scheduled_wakeups.erase(
+        std::remove_if(m_scheduled_wakeups.begin(), m_scheduled_wakeups.end(),
+                       [t](Tick wakeup) { return wakeup < t; }),
+        m_scheduled_wakeups.end());
 }
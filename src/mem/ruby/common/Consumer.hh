@@ -35,8 +35,9 @@
 #ifndef __MEM_RUBY_COMMON_CONSUMER_HH__
 #define __MEM_RUBY_COMMON_CONSUMER_HH__
 
+#include <algorithm>
 #include <iostream>
-#include <set>
+#include <vector>
 
 #include "sim/clocked_object.hh"
 
@@ -59,13 +60,15 @@ class Consumer
     bool
     alreadyScheduled(Tick time)
     {
-        return m_scheduled_wakeups.find(time) != m_scheduled_wakeups.end();
+        return std::find(m_scheduled_wakeups.begin(),
+                         m_scheduled_wakeups.end(), time) !=
+            m_scheduled_wakeups.end();
     }
 
     void
     insertScheduledWakeupTime(Tick time)
     {
-        m_scheduled_wakeups.insert(time);
+        m_scheduled_wakeups.push_back(time);
     }
 
     ClockedObject *
@@ -79,7 +82,10 @@ class Consumer
     void scheduleEvent(Cycles timeDelta);
 
   private:
-    std::set<Tick> m_scheduled_wakeups;
+    // Pending wakeup times, unordered. Only a handful of distinct future
+    // cycles are ever pending, so a linear scan of a flat vector is
+    // cheaper than maintaining a tree.
+    std::vector<Tick> m_scheduled_wakeups;
     ClockedObject *em;
 };
 
@@ -57,7 +57,8 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p->ordered),
-    m_randomization(p->randomization)
+    m_randomization(p->randomization), m_remote_in_flight(0),
+    m_published_size(0), m_remote_not_avail(0)
 {
     m_msg_counter = 0;
     m_consumer = NULL;
@@ -97,6 +98,16 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
         return true;
     }
 
+    if (isRemote()) {
+        unsigned int remote_size =
+            m_published_size.load(std::memory_order_relaxed) +
+            m_remote_in_flight.load(std::memory_order_relaxed);
+        if (remote_size + n <= m_max_size)
+            return true;
+        m_remote_not_avail.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
     // determine the correct size for the current cycle
     // pop operations shouldn't effect the network's visible size
     // until schd cycle, but enqueue operations effect the visible
@@ -161,6 +172,29 @@ random_time()
 void
 MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 {
+    assert(delta > 0);
+    Message* msg_ptr = message.get();
+    assert(msg_ptr != NULL);
+
+    assert(current_time >= msg_ptr->getLastEnqueueTime() &&
+           "ensure we aren't dequeued early");
+
+    // A consumer on another event queue can only be handed the message
+    // at a quantum boundary, so the message must not arrive before the
+    // next one. Stretching to a full quantum keeps the arrival time
+    // independent of how far the consumer's thread has progressed.
+    // The state of the buffer belongs to the consumer's thread, so the
+    // message is only counted once it is delivered, see deliverRemote().
+    // Randomization is rejected in this mode.
+    if (isRemote()) {
+        Tick arrival_time = std::max(current_time + delta,
+                                     curTick() + simQuantum);
+        msg_ptr->updateDelayedTicks(current_time);
+        msg_ptr->setLastEnqueueTime(arrival_time);
+        enqueueRemote(std::move(message), arrival_time);
+        return;
+    }
+
     // record current time incase we have a pop that also adjusts my size
     if (m_time_last_time_enqueue < current_time) {
         m_msgs_this_cycle = 0;  // first msg this cycle
@@ -172,7 +206,6 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 
     // Calculate the arrival time of the message, that is, the first
     // cycle the message can be dequeued.
-    assert(delta > 0);
     Tick arrival_time = 0;
 
     // random delays are inserted if either RubySystem level randomization flag
@@ -209,19 +242,13 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     }
 
     // compute the delay cycles and set enqueue time
-    Message* msg_ptr = message.get();
-    assert(msg_ptr != NULL);
-
-    assert(current_time >= msg_ptr->getLastEnqueueTime() &&
-           "ensure we aren't dequeued early");
-
     msg_ptr->updateDelayedTicks(current_time);
     msg_ptr->setLastEnqueueTime(arrival_time);
     msg_ptr->setMsgCounter(m_msg_counter);
 
-    // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    // Insert the message into the priority queue
+    m_prio_heap.push(message);
+    publishOccupancy();
     // Increment the number of messages statistic
     m_buf_msgs++;
 
@@ -234,6 +261,81 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     m_consumer->storeEventInfo(m_vnet_id);
 }
 
+void
+MessageBuffer::enqueueRemote(MsgPtr message, Tick arrival_time)
+{
+    DPRINTF(RubyQueue, "Enqueue remote arrival_time: %lld, Message: %s\n",
+            arrival_time, *(message.get()));
+
+    {
+        std::lock_guard<std::mutex> lock(m_remote_mutex);
+        m_remote_msgs.push_back(std::move(message));
+    }
+    m_remote_in_flight.fetch_add(1, std::memory_order_relaxed);
+
+    // Scheduling on another thread's queue goes through its asynchronous
+    // queue, which is merged at the next quantum boundary.
+    auto *evt = new OneShotEvent(
+        [this]{ deliverRemote(); }, "MessageBuffer remote delivery");
+    m_consumer->getObject()->schedule(evt, arrival_time);
+}
+
+void
+MessageBuffer::deliverRemote()
+{
+    // Only messages that have arrived are taken. They were enqueued
+    // before the last quantum boundary, so their producer is done with
+    // them; younger ones may still be referenced by a running producer.
+    std::vector<MsgPtr> arrived;
+    {
+        std::lock_guard<std::mutex> lock(m_remote_mutex);
+        auto it = m_remote_msgs.begin();
+        while (it != m_remote_msgs.end()) {
+            if ((*it)->getLastEnqueueTime() <= curTick()) {
+                arrived.push_back(std::move(*it));
+                it = m_remote_msgs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    m_not_avail_count +=
+        m_remote_not_avail.exchange(0, std::memory_order_relaxed);
+    if (arrived.empty())
+        return;
+
+    // The messages join the buffer now, so they are counted and ordered
+    // as if they had been enqueued by the consumer's own thread at this
+    // tick. A message of a strict FIFO does not overtake the messages
+    // already enqueued.
+    Tick current_time = curTick();
+    if (m_time_last_time_enqueue < current_time) {
+        m_msgs_this_cycle = 0;
+        m_time_last_time_enqueue = current_time;
+    }
+    Tick wakeup = current_time;
+    for (auto &message : arrived) {
+        m_msg_counter++;
+        m_msgs_this_cycle++;
+        message->setMsgCounter(m_msg_counter);
+        if (m_strict_fifo &&
+            message->getLastEnqueueTime() < m_last_arrival_time) {
+            message->setLastEnqueueTime(m_last_arrival_time);
+        }
+        if (!RubySystem::getWarmupEnabled())
+            m_last_arrival_time = message->getLastEnqueueTime();
+        wakeup = std::max(wakeup, message->getLastEnqueueTime());
+        m_prio_heap.push(std::move(message));
+    }
+
+    m_remote_in_flight.fetch_sub(arrived.size(), std::memory_order_relaxed);
+    publishOccupancy();
+    m_buf_msgs += arrived.size();
+
+    m_consumer->scheduleEventAbsolute(wakeup);
+    m_consumer->storeEventInfo(m_vnet_id);
+}
+
 Tick
 MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
 {
@@ -257,8 +359,8 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    m_prio_heap.pop();
+    publishOccupancy();
     if (decrement_messages) {
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
@@ -289,6 +391,7 @@ void
 MessageBuffer::clear()
 {
     m_prio_heap.clear();
+    publishOccupancy();
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -304,13 +407,12 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
     MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    m_prio_heap.pop();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    m_prio_heap.push(node);
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
@@ -321,9 +423,7 @@ MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
         MsgPtr m = lt.front();
         assert(m->getLastEnqueueTime() <= schdTick);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+        m_prio_heap.push(m);
 
         m_consumer->scheduleEventAbsolute(schdTick);
 
@@ -392,6 +492,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     (m_stall_msg_map[addr]).push_back(message);
     m_stall_map_size++;
     m_stall_count++;
+    publishOccupancy();
 }
 
 bool
@@ -438,15 +539,18 @@ MessageBuffer::print(ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    vector<MsgPtr> copy(m_prio_heap);
-    sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
+    vector<MsgPtr> copy;
+    m_prio_heap.forEach([&copy](const MsgPtr &msg) {
+        copy.push_back(msg);
+    });
+    sort(copy.begin(), copy.end(), greater<MsgPtr>());
     ccprintf(out, "%s] %s", copy, name());
 }
 
 bool
 MessageBuffer::isReady(Tick current_time) const
 {
-    return ((m_prio_heap.size() > 0) &&
+    return (!m_prio_heap.empty() &&
         (m_prio_heap.front()->getLastEnqueueTime() <= current_time));
 }
 
@@ -493,14 +597,30 @@ MessageBuffer::functionalAccess(Packet *pkt, bool is_read)
 
     uint32_t num_functional_accesses = 0;
 
-    // Check the priority heap and write any messages that may
+    // Check the priority queue and write any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
+    bool read_done = false;
+    m_prio_heap.forEach([&](const MsgPtr &msg) {
+        if (read_done)
+            return;
         if (is_read && msg->functionalRead(pkt))
-            return 1;
+            read_done = true;
         else if (!is_read && msg->functionalWrite(pkt))
             num_functional_accesses++;
+    });
+    if (read_done)
+        return 1;
+
+    // Check the messages still in flight from another thread. Functional
+    // accesses stop all event queues, so none is being enqueued now.
+    {
+        std::lock_guard<std::mutex> lock(m_remote_mutex);
+        for (const MsgPtr &msg : m_remote_msgs) {
+            if (is_read && msg->functionalRead(pkt))
+                return 1;
+            else if (!is_read && msg->functionalWrite(pkt))
+                num_functional_accesses++;
+        }
     }
 
     // Check the stall queue and write any messages that may
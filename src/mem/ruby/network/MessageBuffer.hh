@@ -47,9 +47,11 @@
 #define __MEM_RUBY_NETWORK_MESSAGEBUFFER_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -60,6 +62,7 @@
 #include "mem/port.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/MessageQueue.hh"
 #include "mem/ruby/network/dummy_port.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/MessageBuffer.hh"
@@ -84,9 +87,7 @@ class MessageBuffer : public SimObject
     delayHead(Tick current_time, Tick delta)
     {
         MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
+        m_prio_heap.pop();
         enqueue(m, current_time, delta);
     }
 
@@ -136,7 +137,7 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
+    bool isEmpty() const { return m_prio_heap.empty(); }
     bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
     unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
 
@@ -179,11 +180,29 @@ class MessageBuffer : public SimObject
 
     uint32_t functionalAccess(Packet *pkt, bool is_read);
 
+    //! True if the calling thread does not run the consumer's event queue.
+    bool
+    isRemote() const
+    {
+        return inParallelMode &&
+            m_consumer->getObject()->eventQueue() != curEventQueue();
+    }
+
+    void enqueueRemote(MsgPtr message, Tick arrival_time);
+    void deliverRemote();
+
+    void
+    publishOccupancy()
+    {
+        m_published_size.store(m_prio_heap.size() + m_stall_map_size,
+                               std::memory_order_relaxed);
+    }
+
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    std::vector<MsgPtr> m_prio_heap;
+    MessageQueue<MsgPtr> m_prio_heap;
 
     std::function<void()> m_dequeue_callback;
 
@@ -253,6 +272,21 @@ class MessageBuffer : public SimObject
     int m_input_link_id;
     int m_vnet_id;
 
+    /**
+     * Messages enqueued by a thread other than the one running the
+     * consumer, see enqueue(). They are handed over to the consumer in
+     * deliverRemote(), on the consumer's own thread. Producers on other
+     * threads cannot look at the state above, so they judge the free
+     * space by the occupancy last published by the consumer plus the
+     * messages they still have in flight.
+     */
+    std::mutex m_remote_mutex;
+    std::vector<MsgPtr> m_remote_msgs;
+    std::atomic<unsigned int> m_remote_in_flight;
+    std::atomic<unsigned int> m_published_size;
+    /** Failed remote space checks, added to m_not_avail_count. */
+    std::atomic<uint64_t> m_remote_not_avail;
+
     Stats::Average m_buf_msgs;
     Stats::Average m_stall_time;
     Stats::Scalar m_stall_count;
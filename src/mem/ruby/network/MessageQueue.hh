@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Priority queue of Ruby messages ordered by arrival time.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
+#define __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * Messages ordered by (arrival time, message counter), the order the
+ * binary heap of a MessageBuffer used to impose.
+ *
+ * Most buffers only ever see a few constant delays, so the messages of
+ * one delay class arrive in order. The queue keeps NumLanes FIFO lanes,
+ * each of them sorted: a message is appended to the first lane whose
+ * tail it does not precede, which in the common case sorts every delay
+ * class into its own lane at O(1) cost. Messages that fit no lane, e.g.
+ * randomized, recycled or reanalyzed ones, go to a fallback heap. The
+ * head is the smallest of the lane heads and the heap top, so the
+ * dequeue order is exactly that of a single heap.
+ *
+ * @tparam MsgPtr Pointer to a message, ordered by operator>.
+ */
+template <class MsgPtr>
+class MessageQueue
+{
+  public:
+    static const int NumLanes = 4;
+
+    MessageQueue() : m_size(0), m_head(HeapSrc) {}
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    /** The earliest message. The queue must not be empty. */
+    const MsgPtr &
+    front() const
+    {
+        assert(m_size > 0);
+        return m_head == HeapSrc ? m_heap.front() : m_lanes[m_head].front();
+    }
+
+    void
+    push(const MsgPtr &msg)
+    {
+        int src = HeapSrc;
+        for (int i = 0; i < NumLanes; i++) {
+            if (m_lanes[i].empty() || !(m_lanes[i].back() > msg)) {
+                m_lanes[i].push_back(msg);
+                src = i;
+                break;
+            }
+        }
+        if (src == HeapSrc) {
+            m_heap.push_back(msg);
+            std::push_heap(m_heap.begin(), m_heap.end(),
+                           std::greater<MsgPtr>());
+        }
+
+        // A message appended to a non-empty lane is never earlier than
+        // the head, so only an empty lane or the heap can supply a new one.
+        if (m_size == 0 || front() > msg)
+            m_head = src;
+        m_size++;
+    }
+
+    void
+    pop()
+    {
+        assert(m_size > 0);
+        if (m_head == HeapSrc) {
+            std::pop_heap(m_heap.begin(), m_heap.end(),
+                          std::greater<MsgPtr>());
+            m_heap.pop_back();
+        } else {
+            m_lanes[m_head].pop_front();
+        }
+        m_size--;
+        updateHead();
+    }
+
+    void
+    clear()
+    {
+        for (auto &lane : m_lanes)
+            lane.clear();
+        m_heap.clear();
+        m_size = 0;
+        m_head = HeapSrc;
+    }
+
+    /** Apply f to every message, in no particular order. */
+    template <class F>
+    void
+    forEach(F f) const
+    {
+        for (const auto &lane : m_lanes) {
+            for (const MsgPtr &msg : lane)
+                f(msg);
+        }
+        for (const MsgPtr &msg : m_heap)
+            f(msg);
+    }
+
+  private:
+    static const int HeapSrc = -1;
+
+    void
+    updateHead()
+    {
+        const MsgPtr *head = m_heap.empty() ? nullptr : &m_heap.front();
+        m_head = HeapSrc;
+        for (int i = 0; i < NumLanes; i++) {
+            if (!m_lanes[i].empty() &&
+                (!head || *head > m_lanes[i].front())) {
+                head = &m_lanes[i].front();
+                m_head = i;
+            }
+        }
+    }
+
+    std::deque<MsgPtr> m_lanes[NumLanes];
+    std::vector<MsgPtr> m_heap;
+    size_t m_size;
+    /** Lane holding the earliest message, or HeapSrc. */
+    int m_head;
+};
+
+#endif // __MEM_RUBY_NETWORK_MESSAGEQUEUE_HH__
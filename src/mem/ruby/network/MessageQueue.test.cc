@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/network/MessageQueue.hh"
+
+namespace {
+
+/** A message as MessageBuffer orders them. */
+struct Msg
+{
+    uint64_t arrival;
+    uint64_t counter;
+};
+
+bool
+operator>(const Msg &lhs, const Msg &rhs)
+{
+    if (lhs.arrival == rhs.arrival)
+        return lhs.counter > rhs.counter;
+    return lhs.arrival > rhs.arrival;
+}
+
+/**
+ * Sends the messages of a buffer that enqueues them as
+ * MessageBuffer::enqueue() did before the lanes, into a binary heap, and
+ * into a MessageQueue. Each step enqueues the message of one sender
+ * with its delay and dequeues the messages that arrived, and both must
+ * come out in the same order.
+ */
+class Buffer
+{
+  public:
+    void
+    send(uint64_t now, uint64_t delay)
+    {
+        Msg msg{now + delay, counter++};
+        heap.push_back(msg);
+        std::push_heap(heap.begin(), heap.end(), std::greater<Msg>());
+        queue.push(msg);
+        ASSERT_EQ(queue.size(), heap.size());
+    }
+
+    /** Dequeue all the messages that arrived by now. */
+    void
+    receive(uint64_t now)
+    {
+        while (!heap.empty() && heap.front().arrival <= now) {
+            ASSERT_FALSE(queue.empty());
+            const Msg &expected = heap.front();
+            const Msg &msg = queue.front();
+            ASSERT_EQ(msg.arrival, expected.arrival);
+            ASSERT_EQ(msg.counter, expected.counter);
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Msg>());
+            heap.pop_back();
+            queue.pop();
+            received++;
+        }
+        ASSERT_EQ(queue.size(), heap.size());
+        if (!queue.empty()) {
+            ASSERT_GT(queue.front().arrival, now);
+        }
+    }
+
+    MessageQueue<Msg> queue;
+    std::vector<Msg> heap;
+    uint64_t counter = 0;
+    unsigned received = 0;
+};
+
+} // anonymous namespace
+
+/** Senders with a constant delay each get a lane of their own. */
+TEST(MessageQueueTest, ConstantDelays)
+{
+    const uint64_t delays[] = {1, 5, 20};
+    Buffer buffer;
+    for (uint64_t now = 0; now < 2000; now++) {
+        buffer.send(now, delays[now % 3]);
+        if (now % 7 == 0)
+            buffer.send(now, delays[(now / 7) % 3]);
+        buffer.receive(now);
+    }
+    buffer.receive(UINT64_MAX);
+    EXPECT_EQ(buffer.received, buffer.counter);
+}
+
+/**
+ * More delay classes than lanes, messages at the same arrival time and
+ * random delays as with randomization and recycling all go through the
+ * fallback heap.
+ */
+TEST(MessageQueueTest, MixedDelays)
+{
+    std::mt19937_64 rng(0x5eed);
+    Buffer buffer;
+    for (uint64_t now = 0; now < 5000; now++) {
+        unsigned sends = rng() % 4;
+        for (unsigned i = 0; i < sends; i++) {
+            uint64_t delay;
+            switch (rng() % 3) {
+              case 0:
+                delay = 1 + (rng() % 8) * 3;
+                break;
+              case 1:
+                delay = rng() % 100;
+                break;
+              default:
+                delay = 0;
+                break;
+            }
+            buffer.send(now, delay);
+        }
+        if (rng() % 5)
+            buffer.receive(now);
+    }
+    buffer.receive(UINT64_MAX);
+    EXPECT_EQ(buffer.received, buffer.counter);
+}
+
+/** A long delay queued first must not hide shorter ones behind it. */
+TEST(MessageQueueTest, HeadAcrossLanes)
+{
+    Buffer buffer;
+    buffer.send(0, 1000);
+    for (uint64_t now = 0; now < 100; now++) {
+        buffer.send(now, 10);
+        buffer.send(now, 3);
+        buffer.receive(now);
+    }
+    buffer.receive(UINT64_MAX);
+    EXPECT_EQ(buffer.received, buffer.counter);
+}
+
+/** forEach() visits every message and clear() drops them. */
+TEST(MessageQueueTest, ForEachClear)
+{
+    MessageQueue<Msg> queue;
+    uint64_t counter = 0;
+    for (uint64_t arrival : {7, 3, 9, 3, 1, 12, 2, 8})
+        queue.push(Msg{arrival, counter++});
+
+    uint64_t sum = 0;
+    unsigned n = 0;
+    queue.forEach([&](const Msg &msg) { sum += msg.arrival; n++; });
+    EXPECT_EQ(n, 8u);
+    EXPECT_EQ(sum, 45u);
+    EXPECT_EQ(queue.front().arrival, 1u);
+
+    queue.clear();
+    EXPECT_TRUE(queue.empty());
+    queue.push(Msg{4, counter++});
+    EXPECT_EQ(queue.front().arrival, 4u);
+}
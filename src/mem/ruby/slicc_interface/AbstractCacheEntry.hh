@@ -48,6 +48,7 @@
 #include <iostream>
 
 #include "base/logging.hh"
+#include "base/pool_alloc.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
@@ -64,6 +65,13 @@ class AbstractCacheEntry : public ReplaceableEntry
     AbstractCacheEntry();
     virtual ~AbstractCacheEntry() = 0;
 
+    // Entries are allocated and freed on every fill and eviction, so they
+    // come from size-classed pools that keep them packed together.
+    static void *operator new(size_t size)
+    { return PoolAlloc::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { PoolAlloc::deallocate(p, size); }
+
     // Get/Set permission of the entry
     AccessPermission getPermission() const;
     void changePermission(AccessPermission new_perm);
@@ -50,7 +50,8 @@
 AbstractController::AbstractController(const Params *p)
     : ClockedObject(p), Consumer(this), m_version(p->version),
       m_clusterID(p->cluster_id),
-      m_id(p->system->getRequestorId(this)), m_is_blocking(false),
+      m_id(p->system->getRequestorId(this)), m_functional_dir(nullptr),
+      m_is_blocking(false),
       m_number_of_TBEs(p->number_of_TBEs),
       m_transitions_per_cycle(p->transitions_per_cycle),
       m_buffer_size(p->buffer_size), m_recycle_latency(p->recycle_latency),
@@ -219,7 +220,7 @@ AbstractController::serviceMemoryQueue()
     }
 
     RequestPtr req
-        = std::make_shared<Request>(mem_msg->m_addr, req_size, 0, m_id);
+        = makeRequest(mem_msg->m_addr, req_size, 0, m_id);
     PacketPtr pkt;
     if (mem_msg->getType() == MemoryRequestType_MEMORY_WB) {
         pkt = Packet::createWrite(req);
@@ -311,13 +312,28 @@ AbstractController::functionalMemoryWrite(PacketPtr pkt)
     return num_functional_writes + 1;
 }
 
+bool
+AbstractController::functionalMemoryBackdoor(const AddrRange &range,
+                                             MemBackdoor::Flags access,
+                                             MemBackdoor &backdoor)
+{
+    if (!memoryPort.isConnected())
+        return false;
+
+    MessageBuffer *mem_queue = getMemReqQueue();
+    if (mem_queue && !(mem_queue->isEmpty() && mem_queue->isStallMapEmpty()))
+        return false;
+
+    return memoryPort.sendFunctionalBackdoor(range, access, backdoor);
+}
+
 void
 AbstractController::recvTimingResp(PacketPtr pkt)
 {
     assert(getMemRespQueue());
     assert(pkt->isResponse());
 
-    std::shared_ptr<MemoryMsg> msg = std::make_shared<MemoryMsg>(clockEdge());
+    RefCountingPtr<MemoryMsg> msg = new MemoryMsg(clockEdge());
     (*msg).m_addr = pkt->getAddr();
     (*msg).m_Sender = m_machineID;
 
@@ -57,6 +57,7 @@
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
+#include "mem/ruby/system/FunctionalDirectory.hh"
 #include "params/RubyController.hh"
 #include "sim/clocked_object.hh"
 
@@ -83,6 +84,8 @@ class AbstractController : public ClockedObject, public Consumer
     MachineType getType() const { return m_machineID.getType(); }
 
     void initNetworkPtr(Network* net_ptr) { m_net_ptr = net_ptr; }
+    void setFunctionalDirectory(FunctionalDirectory *dir)
+    { m_functional_dir = dir; }
 
     // return instance name
     void blockOnQueue(Addr, MessageBuffer*);
@@ -94,6 +97,9 @@ class AbstractController : public ClockedObject, public Consumer
     virtual MessageBuffer* getMemReqQueue() const = 0;
     virtual MessageBuffer* getMemRespQueue() const = 0;
     virtual AccessPermission getAccessPermission(const Addr &addr) = 0;
+    //! The permission for lines no transition has touched yet, e.g.,
+    //! Read_Write for a directory that owns the memory behind it.
+    virtual AccessPermission initialAccessPermission() const = 0;
 
     virtual void print(std::ostream & out) const = 0;
     virtual void wakeup() = 0;
@@ -122,6 +128,13 @@ class AbstractController : public ClockedObject, public Consumer
     virtual int functionalWriteBuffers(PacketPtr&) = 0;
     virtual int functionalWrite(const Addr &addr, PacketPtr) = 0;
     int functionalMemoryWrite(PacketPtr);
+    //! Asks the memory behind this controller for a functional back
+    //! door, see FunctionalResponseProtocol::recvFunctionalBackdoor().
+    //! Fails for controllers without memory and while memory requests
+    //! are queued, as those are not in the memory yet.
+    bool functionalMemoryBackdoor(const AddrRange &range,
+                                  MemBackdoor::Flags access,
+                                  MemBackdoor &backdoor);
 
     //! Function for enqueuing a prefetch request
     virtual void enqueuePrefetch(const Addr &, const RubyRequestType&)
@@ -174,6 +187,17 @@ class AbstractController : public ClockedObject, public Consumer
     //! Profiles the delay associated with messages.
     void profileMsgDelay(uint32_t virtualNetwork, Cycles delay);
 
+    //! Reports the permission for addr to the functional directory, if
+    //! any. Called at the end of every transition.
+    void
+    recordAccessPermission(Addr addr)
+    {
+        if (m_functional_dir) {
+            m_functional_dir->update(this, makeLineAddress(addr),
+                                     getAccessPermission(addr));
+        }
+    }
+
     void stallBuffer(MessageBuffer* buf, Addr addr);
     void wakeUpBuffers(Addr addr);
     void wakeUpAllBuffers(Addr addr);
@@ -189,6 +213,7 @@ class AbstractController : public ClockedObject, public Consumer
     const RequestorID m_id;
 
     Network *m_net_ptr;
+    FunctionalDirectory *m_functional_dir;
     bool m_is_blocking;
     std::map<Addr, MessageBuffer*> m_block_map;
 
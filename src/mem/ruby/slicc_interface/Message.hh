@@ -30,17 +30,24 @@
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
 #include <iostream>
-#include <memory>
 #include <stack>
 
+#include "base/pool_alloc.hh"
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/protocol/MessageSizeType.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
+typedef RefCountingPtr<Message> MsgPtr;
 
-class Message
+/**
+ * Base class of all Ruby coherence messages. Messages are created for
+ * almost every protocol action and are only ever handled by the thread
+ * simulating their Ruby system, so they use an intrusive, non-atomic
+ * reference count and are allocated from size-classed free-list pools.
+ */
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -56,8 +63,26 @@ class Message
           m_msg_counter(other.m_msg_counter)
     { }
 
+    /** Copies the message contents; the reference count is untouched. */
+    Message &
+    operator=(const Message &other)
+    {
+        m_time = other.m_time;
+        m_LastEnqueueTime = other.m_LastEnqueueTime;
+        m_DelayedTicks = other.m_DelayedTicks;
+        m_msg_counter = other.m_msg_counter;
+        incoming_link = other.incoming_link;
+        vnet = other.vnet;
+        return *this;
+    }
+
     virtual ~Message() { }
 
+    static void *operator new(size_t size)
+    { return PoolAlloc::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { PoolAlloc::deallocate(p, size); }
+
     virtual MsgPtr clone() const = 0;
     virtual void print(std::ostream& out) const = 0;
 
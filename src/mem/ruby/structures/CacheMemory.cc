@@ -41,6 +41,7 @@
 
 #include "mem/ruby/structures/CacheMemory.hh"
 
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "debug/HtmMem.hh"
@@ -54,6 +55,9 @@
 
 using namespace std;
 
+const Addr CacheMemory::InvalidTag;
+const int CacheMemory::MaxFlatTagAssoc;
+
 ostream&
 operator<<(ostream& out, const CacheMemory& obj)
 {
@@ -84,6 +88,10 @@ CacheMemory::CacheMemory(const Params *p)
     m_block_size = p->block_size;  // may be 0 at this point. Updated in init()
     m_use_occupancy = dynamic_cast<WeightedLRUPolicy*>(
                                     m_replacementPolicy_ptr) ? true : false;
+    fatal_if(p->flat_tag_max_assoc > MaxFlatTagAssoc,
+             "%s: flat_tag_max_assoc (%d) must not exceed %d", name(),
+             p->flat_tag_max_assoc, MaxFlatTagAssoc);
+    m_use_flat_tags = m_cache_assoc <= p->flat_tag_max_assoc;
 }
 
 void
@@ -108,6 +116,9 @@ CacheMemory::init()
                                 m_replacementPolicy_ptr->instantiateEntry();
         }
     }
+    if (m_use_flat_tags) {
+        m_tags.assign((size_t)m_cache_num_sets * m_cache_assoc, InvalidTag);
+    }
 }
 
 CacheMemory::~CacheMemory()
@@ -130,12 +141,32 @@ CacheMemory::addressToCacheSet(Addr address) const
                      m_start_index_bit + m_cache_num_set_bits - 1);
 }
 
+// Search the flat tag array of a set. All ways are compared without
+// early exit so the loop vectorizes; returns -1 if the tag is not found.
+int
+CacheMemory::findWayInFlatSet(int64_t cacheSet, Addr tag) const
+{
+    const Addr *tags = &m_tags[cacheSet * m_cache_assoc];
+    uint64_t match = 0;
+    for (int i = 0; i < m_cache_assoc; i++) {
+        match |= (uint64_t)(tags[i] == tag) << i;
+    }
+    return match ? findLsbSet(match) : -1;
+}
+
 // Given a cache index: returns the index of the tag in a set.
 // returns -1 if the tag is not found.
 int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
+    if (m_use_flat_tags) {
+        int way = findWayInFlatSet(cacheSet, tag);
+        if (way != -1 && m_cache[cacheSet][way]->m_Permission !=
+            AccessPermission_NotPresent)
+            return way;
+        return -1;
+    }
     // search the set for the tags
     auto it = m_tag_index.find(tag);
     if (it != m_tag_index.end())
@@ -152,6 +183,8 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
                                            Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
+    if (m_use_flat_tags)
+        return findWayInFlatSet(cacheSet, tag);
     // search the set for the tags
     auto it = m_tag_index.find(tag);
     if (it != m_tag_index.end())
@@ -291,7 +324,16 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            if (m_use_flat_tags) {
+                // A NotPresent way may still carry this tag; keep only
+                // the new way, as overwriting m_tag_index would.
+                int stale = findWayInFlatSet(cacheSet, address);
+                if (stale != -1)
+                    m_tags[cacheSet * m_cache_assoc + stale] = InvalidTag;
+                m_tags[cacheSet * m_cache_assoc + i] = address;
+            } else {
+                m_tag_index[address] = i;
+            }
             set[i]->setPosition(cacheSet, i);
             set[i]->replacementData = replacement_data[cacheSet][i];
             set[i]->setLastAccess(curTick());
@@ -317,7 +359,10 @@ CacheMemory::deallocate(Addr address)
     uint32_t way = entry->getWay();
     delete entry;
     m_cache[cache_set][way] = NULL;
-    m_tag_index.erase(address);
+    if (m_use_flat_tags)
+        m_tags[cache_set * m_cache_assoc + way] = InvalidTag;
+    else
+        m_tag_index.erase(address);
 }
 
 // Returns with the physical address of the conflicting cache line
@@ -186,6 +186,7 @@ class CacheMemory : public SimObject
     // returns -1 if the tag is not found.
     int findTagInSet(int64_t line, Addr tag) const;
     int findTagInSetIgnorePermissions(int64_t cacheSet, Addr tag) const;
+    int findWayInFlatSet(int64_t cacheSet, Addr tag) const;
 
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
@@ -200,6 +201,18 @@ class CacheMemory : public SimObject
     std::unordered_map<Addr, int> m_tag_index;
     std::vector<std::vector<AbstractCacheEntry*> > m_cache;
 
+    /**
+     * Contiguous tag array with m_cache_assoc tags per set, used instead of
+     * m_tag_index when the associativity is at most flat_tag_max_assoc. A
+     * lookup then reads the tags of a single set rather than hashing into a
+     * table shared by the whole cache. Empty ways hold InvalidTag, which is
+     * never a line address.
+     */
+    std::vector<Addr> m_tags;
+    bool m_use_flat_tags;
+    static const Addr InvalidTag = MaxAddr;
+    static const int MaxFlatTagAssoc = 64;
+
     /**
      * We use BaseReplacementPolicy from Classic system here, hence we can use
      * different replacement policies from Classic system in Ruby system.
@@ -39,6 +39,8 @@ class RubyCache(SimObject):
     start_index_bit = Param.Int(6, "index start, default 6 for 64-byte line");
     is_icache = Param.Bool(False, "is instruction only cache");
     block_size = Param.MemorySize("0B", "block size in bytes. 0 means default RubyBlockSize")
+    flat_tag_max_assoc = Param.Int(16, "Largest associativity for which "
+        "tags are kept in a flat per-set array instead of a hash map (<= 64)")
 
     dataArrayBanks = Param.Int(1, "Number of banks for the data array")
     tagArrayBanks = Param.Int(1, "Number of banks for the tag array")
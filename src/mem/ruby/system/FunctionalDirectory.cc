@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/system/FunctionalDirectory.hh"
+
+#include "sim/eventq.hh"
+
+namespace
+{
+
+bool
+holdsLine(AccessPermission perm)
+{
+    return perm != AccessPermission_Invalid &&
+           perm != AccessPermission_NotPresent;
+}
+
+AccessPermission
+normalize(AccessPermission perm)
+{
+    return holdsLine(perm) ? perm : AccessPermission_NotPresent;
+}
+
+const FunctionalDirectory::Holder *
+findHolder(const FunctionalDirectory::Holders &holders,
+           const AbstractController *cntrl)
+{
+    for (const auto &h : holders) {
+        if (h.cntrl == cntrl)
+            return &h;
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+void
+FunctionalDirectory::addHome(AbstractController *cntrl,
+                             AccessPermission perm,
+                             const AddrRangeList &ranges)
+{
+    if (holdsLine(perm))
+        homes.push_back({cntrl, perm, ranges});
+}
+
+AccessPermission
+FunctionalDirectory::initialPermission(const AbstractController *cntrl,
+                                       Addr line) const
+{
+    for (const Home &home : homes) {
+        if (home.cntrl != cntrl)
+            continue;
+        for (const auto &range : home.ranges) {
+            if (range.contains(line))
+                return home.perm;
+        }
+        break;
+    }
+    return AccessPermission_NotPresent;
+}
+
+void
+FunctionalDirectory::update(AbstractController *cntrl, Addr line,
+                            AccessPermission perm)
+{
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (inParallelMode)
+        lock.lock();
+
+    perm = normalize(perm);
+    bool initial = perm == initialPermission(cntrl, line);
+
+    auto it = lines.find(line);
+    if (it == lines.end()) {
+        if (!initial)
+            lines[line].push_back({cntrl, perm});
+        return;
+    }
+
+    Holders &holders = it->second;
+    for (auto h = holders.begin(); h != holders.end(); ++h) {
+        if (h->cntrl != cntrl)
+            continue;
+        if (!initial) {
+            h->perm = perm;
+        } else {
+            *h = holders.back();
+            holders.pop_back();
+            if (holders.empty())
+                lines.erase(it);
+        }
+        return;
+    }
+    if (!initial)
+        holders.push_back({cntrl, perm});
+}
+
+void
+FunctionalDirectory::lookup(Addr line, Holders &holders) const
+{
+    static const Holders none;
+    auto it = lines.find(line);
+    const Holders &recorded = it == lines.end() ? none : it->second;
+
+    for (const Holder &h : recorded) {
+        if (holdsLine(h.perm))
+            holders.push_back(h);
+    }
+    for (const Home &home : homes) {
+        if (findHolder(recorded, home.cntrl))
+            continue;
+        AccessPermission perm = initialPermission(home.cntrl, line);
+        if (holdsLine(perm))
+            holders.push_back({home.cntrl, perm});
+    }
+}
+
+AccessPermission
+FunctionalDirectory::permission(const AbstractController *cntrl,
+                                Addr line) const
+{
+    auto it = lines.find(line);
+    if (it != lines.end()) {
+        if (const Holder *h = findHolder(it->second, cntrl))
+            return h->perm;
+    }
+    return initialPermission(cntrl, line);
+}
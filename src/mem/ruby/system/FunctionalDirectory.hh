@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Line address to controller map used to steer Ruby functional accesses.
+ */
+
+#ifndef __MEM_RUBY_SYSTEM_FUNCTIONALDIRECTORY_HH__
+#define __MEM_RUBY_SYSTEM_FUNCTIONALDIRECTORY_HH__
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "base/addr_range.hh"
+#include "base/types.hh"
+#include "mem/ruby/protocol/AccessPermission.hh"
+
+class AbstractController;
+
+/**
+ * Records, for every line, the controllers whose access permission for
+ * it is neither Invalid nor NotPresent, i.e., the controllers that hold
+ * a copy or have one in transit. Controllers report the permission of
+ * the address of every transition they execute, so the directory holds
+ * exactly what a scan of all controllers with getAccessPermission()
+ * would find, at the cost of one lookup per transition.
+ *
+ * Lines no transition has touched are in the initial state of every
+ * controller. For caches that holds nothing, but a directory owns the
+ * memory behind it from the start. Such home controllers are registered
+ * with their initial permission, and only their departures from it are
+ * recorded.
+ */
+class FunctionalDirectory
+{
+  public:
+    struct Holder
+    {
+        AbstractController *cntrl;
+        AccessPermission perm;
+    };
+    typedef std::vector<Holder> Holders;
+
+    /**
+     * Register a controller that holds the lines of ranges before any
+     * transition touches them, with the permission it has for them.
+     */
+    void addHome(AbstractController *cntrl, AccessPermission perm,
+                 const AddrRangeList &ranges);
+
+    /** Record the permission cntrl has for line after a transition. */
+    void update(AbstractController *cntrl, Addr line, AccessPermission perm);
+
+    /** Append the controllers holding line, in no particular order. */
+    void lookup(Addr line, Holders &holders) const;
+
+    /** The permission of cntrl for line, NotPresent if it holds none. */
+    AccessPermission permission(const AbstractController *cntrl,
+                                Addr line) const;
+
+    size_t size() const { return lines.size(); }
+
+  private:
+    struct Home
+    {
+        AbstractController *cntrl;
+        AccessPermission perm;
+        AddrRangeList ranges;
+    };
+
+    /** The permission cntrl has for line if no transition touched it. */
+    AccessPermission initialPermission(const AbstractController *cntrl,
+                                       Addr line) const;
+
+    /**
+     * Permissions that differ from the initial one of their controller,
+     * with Invalid recorded as NotPresent.
+     */
+    std::unordered_map<Addr, Holders> lines;
+    std::vector<Home> homes;
+    /** Serialises updates of controllers on different event queues. */
+    std::mutex mutex;
+};
+
+#endif // __MEM_RUBY_SYSTEM_FUNCTIONALDIRECTORY_HH__
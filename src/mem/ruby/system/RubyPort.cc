@@ -428,6 +428,42 @@ RubyPort::MemResponsePort::recvFunctional(PacketPtr pkt)
     }
 }
 
+bool
+RubyPort::MemResponsePort::recvFunctionalBackdoor(const AddrRange &range,
+                                                  MemBackdoor::Flags access,
+                                                  MemBackdoor &backdoor)
+{
+    RubyPort *rp = static_cast<RubyPort *>(&owner);
+    RubySystem *rs = rp->m_ruby_system;
+
+    if (!rp->system->isMemAddr(range.start()) ||
+        !rp->system->isMemAddr(range.end() - 1)) {
+        return false;
+    }
+
+    if (access_backing_store) {
+        // As for recvFunctional(), the attached physmem is authoritative.
+        return rs->getPhysMem()->functionalBackdoor(range, access, backdoor);
+    }
+    return rs->functionalBackdoor(range, Request::funcRequestorId, access,
+                                  backdoor);
+}
+
+bool
+RubyPort::MemResponsePort::recvFunctionalProbe(PacketPtr pkt, bool touch)
+{
+    RubyPort *rp = static_cast<RubyPort *>(&owner);
+    if (!rp->system->isMemAddr(pkt->getAddr()))
+        return false;
+    return rp->probeCache(pkt, touch);
+}
+
+bool
+RubyPort::MemResponsePort::recvFunctionalProbeSupported() const
+{
+    return static_cast<const RubyPort &>(owner).canProbeCache();
+}
+
 void
 RubyPort::ruby_hit_callback(PacketPtr pkt)
 {
@@ -617,7 +653,7 @@ RubyPort::ruby_eviction_callback(Addr address)
     // Allocate the invalidate request and packet on the stack, as it is
     // assumed they will not be modified or deleted by receivers.
     // TODO: should this really be using funcRequestorId?
-    auto request = std::make_shared<Request>(
+    auto request = makeRequest(
         address, RubySystem::getBlockSizeBytes(), 0,
         Request::funcRequestorId);
 
@@ -644,6 +680,16 @@ RubyPort::PioRequestPort::recvRangeChange()
     }
 }
 
+bool
+RubyPort::hasQueuedResponses() const
+{
+    for (auto port : response_ports) {
+        if (port->hasQueuedResponses())
+            return true;
+    }
+    return false;
+}
+
 int
 RubyPort::functionalWrite(Packet *func_pkt)
 {
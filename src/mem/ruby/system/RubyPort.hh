@@ -85,6 +85,7 @@ class RubyPort : public ClockedObject
                      PortID id, bool _no_retry_on_stall);
         void hitCallback(PacketPtr pkt);
         void evictionCallback(Addr address);
+        bool hasQueuedResponses() const { return queue.size() > 0; }
 
       protected:
         bool recvTimingReq(PacketPtr pkt);
@@ -93,6 +94,13 @@ class RubyPort : public ClockedObject
 
         void recvFunctional(PacketPtr pkt);
 
+        bool recvFunctionalBackdoor(const AddrRange &range,
+                                    MemBackdoor::Flags access,
+                                    MemBackdoor &backdoor) override;
+
+        bool recvFunctionalProbe(PacketPtr pkt, bool touch) override;
+        bool recvFunctionalProbeSupported() const override;
+
         AddrRangeList getAddrRanges() const
         { AddrRangeList ranges; return ranges; }
 
@@ -169,7 +177,26 @@ class RubyPort : public ClockedObject
 
     virtual int functionalWrite(Packet *func_pkt);
 
+    /**
+     * Whether a functional write of range would also have to update
+     * requests or responses held by this port. Without a record of the
+     * addresses, any outstanding request counts.
+     */
+    virtual bool hasPendingAccess(const AddrRange &range) const
+    { return outstandingCount() > 0 || hasQueuedResponses(); }
+
+    /**
+     * Serve a cache probe of a CPU port, see
+     * FunctionalResponseProtocol::recvFunctionalProbe(). Ports without
+     * a first level cache of their own report a miss.
+     */
+    virtual bool probeCache(PacketPtr pkt, bool touch) { return false; }
+
+    /** Whether probeCache() looks at a first level cache. */
+    virtual bool canProbeCache() const { return false; }
+
   protected:
+    bool hasQueuedResponses() const;
     void trySendRetries();
     void ruby_hit_callback(PacketPtr pkt);
     void testDrainComplete();
@@ -43,6 +43,7 @@
 #include <fcntl.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <list>
 
@@ -73,8 +74,12 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params *p)
     : ClockedObject(p), m_access_backing_store(p->access_backing_store),
+      m_check_functional_dir(p->check_functional_directory),
       m_cache_recorder(NULL)
 {
+    if (p->functional_directory || p->check_functional_directory)
+        m_functional_dir.reset(new FunctionalDirectory);
+
     m_randomization = p->randomization;
 
     m_block_size_bytes = p->block_size_bytes;
@@ -102,6 +107,11 @@ void
 RubySystem::registerAbstractController(AbstractController* cntrl)
 {
     m_abs_cntrl_vec.push_back(cntrl);
+    cntrl->setFunctionalDirectory(m_functional_dir.get());
+    if (m_functional_dir) {
+        m_functional_dir->addHome(cntrl, cntrl->initialAccessPermission(),
+                                  cntrl->getAddrRanges());
+    }
 
     MachineID id = cntrl->getMachineID();
     m_abstract_controls[id.getType()][id.getNum()] = cntrl;
@@ -483,6 +493,10 @@ RubySystem::functionalRead(PacketPtr pkt)
 
     DPRINTF(RubySystem, "Functional Read request for %#x\n", address);
 
+    // The controllers may be spread over several event queues, stop all
+    // of them for a consistent view.
+    EventQueue::ScopedStopAll stop_all;
+
     unsigned int num_ro = 0;
     unsigned int num_rw = 0;
     unsigned int num_busy = 0;
@@ -500,9 +514,13 @@ RubySystem::functionalRead(PacketPtr pkt)
     AbstractController *ctrl_backing_store = nullptr;
 
     // In this loop we count the number of controllers that have the given
-    // address in read only, read write and busy states.
-    for (auto& cntrl : netCntrls[request_net_id]) {
-        access_perm = cntrl-> getAccessPermission(line_address);
+    // address in read only, read write and busy states. Controllers that
+    // do not appear have it invalid or not present.
+    FunctionalDirectory::Holders holders =
+        functionalHolders(line_address, request_net_id);
+    for (auto& holder : holders) {
+        AbstractController *cntrl = holder.cntrl;
+        access_perm = holder.perm;
         if (access_perm == AccessPermission_Read_Only){
             num_ro++;
             if (ctrl_ro == nullptr) ctrl_ro = cntrl;
@@ -528,6 +546,7 @@ RubySystem::functionalRead(PacketPtr pkt)
                  access_perm == AccessPermission_NotPresent)
             num_invalid++;
     }
+    num_invalid += netCntrls[request_net_id].size() - holders.size();
 
     // This if case is meant to capture what happens in a Broadcast/Snoop
     // protocol where the block does not exist in the cache hierarchy. You
@@ -602,6 +621,10 @@ RubySystem::functionalWrite(PacketPtr pkt)
 
     DPRINTF(RubySystem, "Functional Write request for %#x\n", addr);
 
+    // The controllers may be spread over several event queues, stop all
+    // of them for a consistent view.
+    EventQueue::ScopedStopAll stop_all;
+
     uint32_t M5_VAR_USED num_functional_writes = 0;
 
     // Only send functional requests within the same network.
@@ -609,15 +632,20 @@ RubySystem::functionalWrite(PacketPtr pkt)
     int request_net_id = requestorToNetwork[pkt->requestorId()];
     assert(netCntrls.count(request_net_id));
 
-    for (auto& cntrl : netCntrls[request_net_id]) {
-        num_functional_writes += cntrl->functionalWriteBuffers(pkt);
-
-        access_perm = cntrl->getAccessPermission(line_addr);
+    for (auto& holder : functionalHolders(line_addr, request_net_id)) {
+        access_perm = holder.perm;
         if (access_perm != AccessPermission_Invalid &&
             access_perm != AccessPermission_NotPresent) {
             num_functional_writes +=
-                cntrl->functionalWrite(line_addr, pkt);
+                holder.cntrl->functionalWrite(line_addr, pkt);
         }
+    }
+
+    // Messages in flight, e.g., stores waiting in a mandatory queue, are
+    // not reflected by any permission, so all buffers and sequencers
+    // are searched.
+    for (auto& cntrl : netCntrls[request_net_id]) {
+        num_functional_writes += cntrl->functionalWriteBuffers(pkt);
 
         // Also updates requests pending in any sequencer associated
         // with the controller
@@ -639,6 +667,127 @@ RubySystem::functionalWrite(PacketPtr pkt)
     return true;
 }
 
+bool
+RubySystem::functionalBackdoor(const AddrRange &range, RequestorID id,
+                               MemBackdoor::Flags access,
+                               MemBackdoor &backdoor)
+{
+    // Controllers on other event queues could move the data before the
+    // caller uses the back door.
+    if (inParallelMode || !requestorToNetwork.count(id))
+        return false;
+
+    int request_net_id = requestorToNetwork[id];
+
+    // A functional write also updates the data of pending requests.
+    if (access & MemBackdoor::Writeable) {
+        for (auto& cntrl : netCntrls[request_net_id]) {
+            RubyPort *seq = cntrl->getCPUSequencer();
+            RubyPort *dma = cntrl->getDMASequencer();
+            if ((seq && seq->hasPendingAccess(range)) ||
+                (dma && dma->hasPendingAccess(range))) {
+                return false;
+            }
+        }
+    }
+
+    // Memories already asked, and the host address of guest address 0
+    // they agree on.
+    std::vector<std::pair<AbstractController *, AddrRange>> memories;
+    uintptr_t host_base = 0;
+
+    const Addr block = getBlockSizeBytes();
+    for (Addr line = makeLineAddress(range.start()); line < range.end();
+         line += block) {
+        AddrRange line_range = RangeSize(line, block);
+        FunctionalDirectory::Holders holders =
+            functionalHolders(line, request_net_id);
+        if (holders.empty())
+            return false;
+
+        for (auto& holder : holders) {
+            // Busy and Maybe_Stale lines may have newer data in transit.
+            if (holder.perm != AccessPermission_Read_Write &&
+                holder.perm != AccessPermission_Read_Only &&
+                holder.perm != AccessPermission_Backing_Store) {
+                return false;
+            }
+
+            auto known = std::find_if(memories.begin(), memories.end(),
+                [&](const std::pair<AbstractController *, AddrRange> &m) {
+                    return m.first == holder.cntrl &&
+                           line_range.isSubset(m.second);
+                });
+            if (known != memories.end())
+                continue;
+
+            // Caches have no memory, so a copy in any cache ends up here.
+            MemBackdoor door;
+            if (!holder.cntrl->functionalMemoryBackdoor(line_range, access,
+                                                        door)) {
+                return false;
+            }
+            uintptr_t door_base =
+                (uintptr_t)door.ptr() - door.range().start();
+            if (!memories.empty() && door_base != host_base)
+                return false;
+            host_base = door_base;
+            memories.emplace_back(holder.cntrl, door.range());
+        }
+    }
+
+    DPRINTF(RubySystem, "Functional back door for %s\n", range.to_string());
+    backdoor.range(range);
+    backdoor.ptr((uint8_t *)(host_base + range.start()));
+    backdoor.flags(access);
+    return true;
+}
+
+FunctionalDirectory::Holders
+RubySystem::functionalHolders(Addr line, int net_id)
+{
+    FunctionalDirectory::Holders holders;
+    if (!m_functional_dir) {
+        for (auto& cntrl : netCntrls[net_id]) {
+            AccessPermission perm = cntrl->getAccessPermission(line);
+            if (perm != AccessPermission_Invalid &&
+                perm != AccessPermission_NotPresent) {
+                holders.push_back({cntrl, perm});
+            }
+        }
+        return holders;
+    }
+
+    if (m_check_functional_dir)
+        checkFunctionalDirectory(line);
+
+    FunctionalDirectory::Holders all;
+    m_functional_dir->lookup(line, all);
+    for (auto& holder : all) {
+        if (machineToNetwork[holder.cntrl->getMachineID()] == net_id)
+            holders.push_back(holder);
+    }
+    DPRINTF(RubySystem, "Functional directory: %d holders of %#x\n",
+            holders.size(), line);
+    return holders;
+}
+
+void
+RubySystem::checkFunctionalDirectory(Addr line)
+{
+    for (auto& cntrl : m_abs_cntrl_vec) {
+        AccessPermission actual = cntrl->getAccessPermission(line);
+        if (actual == AccessPermission_Invalid)
+            actual = AccessPermission_NotPresent;
+        AccessPermission recorded = m_functional_dir->permission(cntrl, line);
+        panic_if(actual != recorded,
+                 "Functional directory has %s for %#x in %s, "
+                 "the controller reports %s\n",
+                 AccessPermission_to_string(recorded), line,
+                 cntrl->name(), AccessPermission_to_string(actual));
+    }
+}
+
 RubySystem *
 RubySystemParams::create()
 {
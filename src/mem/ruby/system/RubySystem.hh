@@ -35,6 +35,7 @@
 #ifndef __MEM_RUBY_SYSTEM_RUBYSYSTEM_HH__
 #define __MEM_RUBY_SYSTEM_RUBYSYSTEM_HH__
 
+#include <memory>
 #include <unordered_map>
 
 #include "base/callback.hh"
@@ -43,6 +44,7 @@
 #include "mem/ruby/profiler/Profiler.hh"
 #include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
+#include "mem/ruby/system/FunctionalDirectory.hh"
 #include "params/RubySystem.hh"
 #include "sim/clocked_object.hh"
 
@@ -94,6 +96,18 @@ class RubySystem : public ClockedObject
     bool functionalRead(Packet *ptr);
     bool functionalWrite(Packet *ptr);
 
+    /**
+     * Set up a back door for a functional access of range by requestor
+     * id if the memory behind the directories holds the current data of
+     * every line of it, i.e., no cache holds a line and no directory is
+     * in a transient state or waiting for memory. Writes additionally
+     * require that no sequencer has a request pending for the range.
+     * The back door is only valid until the next event.
+     */
+    bool functionalBackdoor(const AddrRange &range, RequestorID id,
+                            MemBackdoor::Flags access,
+                            MemBackdoor &backdoor);
+
     void registerNetwork(Network*);
     void registerAbstractController(AbstractController*);
     void registerMachineID(const MachineID& mach_id, Network* network);
@@ -102,8 +116,7 @@ class RubySystem : public ClockedObject
     bool eventQueueEmpty() { return eventq->empty(); }
     void enqueueRubyEvent(Tick tick)
     {
-        auto e = new EventFunctionWrapper(
-            [this]{ processRubyEvent(); }, "RubyEvent");
+        auto e = new OneShotEvent([this]{ processRubyEvent(); }, "RubyEvent");
         schedule(e, tick);
     }
 
@@ -123,6 +136,18 @@ class RubySystem : public ClockedObject
                                      uint64_t uncompressed_trace_size);
 
     void processRubyEvent();
+
+    /**
+     * The controllers of network net_id that may hold line, with their
+     * permissions, leaving out those that have it Invalid or NotPresent.
+     * Taken from the functional directory if there is one, otherwise
+     * every controller of the network is asked.
+     */
+    FunctionalDirectory::Holders functionalHolders(Addr line, int net_id);
+
+    /** Panic if the functional directory disagrees with the controllers. */
+    void checkFunctionalDirectory(Addr line);
+
   private:
     // configuration parameters
     static bool m_randomization;
@@ -135,6 +160,8 @@ class RubySystem : public ClockedObject
     static bool m_cooldown_enabled;
     SimpleMemory *m_phys_mem;
     const bool m_access_backing_store;
+    std::unique_ptr<FunctionalDirectory> m_functional_dir;
+    const bool m_check_functional_dir;
 
     //std::vector<Network *> m_networks;
     std::vector<std::unique_ptr<Network>> m_networks;
@@ -46,6 +46,11 @@ class RubySystem(ClockedObject):
 
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
+    functional_directory = Param.Bool(False, "Track which controllers \
+        hold every line so functional accesses only visit those")
+    check_functional_directory = Param.Bool(False, "Compare the \
+        functional directory against all controllers on every functional \
+        access")
 
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
@@ -205,6 +205,40 @@ Sequencer::functionalWrite(Packet *func_pkt)
     return num_written;
 }
 
+bool
+Sequencer::hasPendingAccess(const AddrRange &range) const
+{
+    for (const auto &table_entry : m_RequestTable) {
+        AddrRange line = RangeSize(table_entry.first,
+                                   RubySystem::getBlockSizeBytes());
+        if (line.intersects(range))
+            return true;
+    }
+    return hasQueuedResponses();
+}
+
+bool
+Sequencer::probeCache(PacketPtr pkt, bool touch)
+{
+    Addr line = makeLineAddress(pkt->getAddr());
+    if (touch) {
+        m_dataCache_ptr->setMRU(line);
+        return m_dataCache_ptr->isTagPresent(line);
+    }
+
+    // Accesses to lines with outstanding requests would wait for them.
+    if (m_RequestTable.count(line) || m_controller->isBlocked(line))
+        return false;
+
+    const CacheMemory *cache = m_dataCache_ptr;
+    const AbstractCacheEntry *entry = cache->lookup(line);
+    if (entry == nullptr)
+        return false;
+    AccessPermission perm = entry->getPermission();
+    return perm == AccessPermission_Read_Only ||
+           perm == AccessPermission_Read_Write;
+}
+
 void Sequencer::resetStats()
 {
     m_outstandReqHist.reset();
@@ -490,6 +524,35 @@ Sequencer::readCallback(Addr address, DataBlock& data,
     }
 }
 
+void
+Sequencer::deferredMissCallback(Addr address)
+{
+    assert(address == makeLineAddress(address));
+    assert(m_RequestTable.find(address) != m_RequestTable.end());
+    auto &seq_req_list = m_RequestTable[address];
+
+    // Only the request at the head went to the L1, the aliased ones
+    // behind it still have to be issued.
+    SequencerRequest &seq_req = seq_req_list.front();
+    PacketPtr pkt = seq_req.pkt;
+    assert(seq_req.m_type == RubyRequestType_LD);
+    assert(pkt->req->isDeferReplacement());
+    markRemoved();
+    seq_req_list.pop_front();
+
+    if (seq_req_list.empty()) {
+        m_RequestTable.erase(address);
+    } else {
+        SequencerRequest &next = seq_req_list.front();
+        issueRequest(next.pkt, next.m_second_type);
+    }
+
+    DPRINTF(RubySequencer, "Deferred miss on %#x\n", pkt->getAddr());
+    pkt->setDeferredMiss();
+    ruby_hit_callback(pkt);
+    testDrainComplete();
+}
+
 void
 Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
                        bool llscSuccess,
@@ -707,13 +770,12 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
 
     // check if the packet has data as for example prefetch and flush
     // requests do not
-    std::shared_ptr<RubyRequest> msg =
-        std::make_shared<RubyRequest>(clockEdge(), pkt->getAddr(),
-                                      pkt->isFlush() ?
-                                      nullptr : pkt->getPtr<uint8_t>(),
-                                      pkt->getSize(), pc, secondary_type,
-                                      RubyAccessMode_Supervisor, pkt,
-                                      PrefetchBit_No, proc_id, core_id);
+    RefCountingPtr<RubyRequest> msg =
+        new RubyRequest(clockEdge(), pkt->getAddr(),
+                        pkt->isFlush() ? nullptr : pkt->getPtr<uint8_t>(),
+                        pkt->getSize(), pc, secondary_type,
+                        RubyAccessMode_Supervisor, pkt,
+                        PrefetchBit_No, proc_id, core_id);
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %#x %s\n",
             curTick(), m_version, "Seq", "Begin", "", "",
@@ -728,6 +790,11 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
         msg->m_htmTransactionUid = pkt->getHtmTransactionUid();
     }
 
+    // A speculative load that may not leave a trace in the replacement
+    // state; the L1 skips the update on a hit and the CPU applies it
+    // once it is safe, see probeCache().
+    msg->m_deferReplacement = pkt->req->isDeferReplacement();
+
     Tick latency = cyclesToTicks(
                         m_controller->mandatoryQueueLatency(secondary_type));
     assert(latency > 0);
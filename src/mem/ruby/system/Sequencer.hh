@@ -113,6 +113,14 @@ class Sequencer : public RubyPort
                       const Cycles forwardRequestTime = Cycles(0),
                       const Cycles firstResponseTime = Cycles(0));
 
+    /**
+     * Hand a Request::DEFER_REPLACEMENT load that missed in the L1
+     * back to the CPU without data, see Packet::isDeferredMiss(). The
+     * L1 did not allocate the line, so the CPU retries the load once
+     * it is safe to change the cache.
+     */
+    void deferredMissCallback(Addr address);
+
     RequestStatus makeRequest(PacketPtr pkt) override;
     virtual bool empty() const;
     int outstandingCount() const override { return m_outstanding_count; }
@@ -130,6 +138,9 @@ class Sequencer : public RubyPort
     int coreId() const { return m_coreId; }
 
     virtual int functionalWrite(Packet *func_pkt) override;
+    bool hasPendingAccess(const AddrRange &range) const override;
+    bool probeCache(PacketPtr pkt, bool touch) override;
+    bool canProbeCache() const override { return true; }
 
     void recordRequestType(SequencerRequestType requestType);
     Stats::Histogram& getOutstandReqHist() { return m_outstandReqHist; }
@@ -81,8 +81,10 @@ SimpleMemory::recvAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &_backdoor)
 {
     Tick latency = recvAtomic(pkt);
 
-    if (backdoor.ptr())
+    if (backdoor.ptr()) {
+        markBackdoorWritten();
         _backdoor = &backdoor;
+    }
     return latency;
 }
 
@@ -104,6 +106,17 @@ SimpleMemory::recvFunctional(PacketPtr pkt)
     pkt->popLabel();
 }
 
+bool
+SimpleMemory::recvFunctionalBackdoor(const AddrRange &range,
+                                     MemBackdoor::Flags access,
+                                     MemBackdoor &_backdoor)
+{
+    // A functional write would also update the queued responses.
+    if ((access & MemBackdoor::Writeable) && !packetQueue.empty())
+        return false;
+    return functionalBackdoor(range, access, _backdoor);
+}
+
 bool
 SimpleMemory::recvTimingReq(PacketPtr pkt)
 {
@@ -290,6 +303,14 @@ SimpleMemory::MemoryPort::recvFunctional(PacketPtr pkt)
     memory.recvFunctional(pkt);
 }
 
+bool
+SimpleMemory::MemoryPort::recvFunctionalBackdoor(const AddrRange &range,
+                                                 MemBackdoor::Flags access,
+                                                 MemBackdoor &_backdoor)
+{
+    return memory.recvFunctionalBackdoor(range, access, _backdoor);
+}
+
 bool
 SimpleMemory::MemoryPort::recvTimingReq(PacketPtr pkt)
 {
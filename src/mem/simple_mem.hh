@@ -92,6 +92,9 @@ class SimpleMemory : public AbstractMemory
         Tick recvAtomicBackdoor(
                 PacketPtr pkt, MemBackdoorPtr &_backdoor) override;
         void recvFunctional(PacketPtr pkt) override;
+        bool recvFunctionalBackdoor(const AddrRange &range,
+                                    MemBackdoor::Flags access,
+                                    MemBackdoor &_backdoor) override;
         bool recvTimingReq(PacketPtr pkt) override;
         void recvRespRetry() override;
         AddrRangeList getAddrRanges() const override;
@@ -185,6 +188,9 @@ class SimpleMemory : public AbstractMemory
     Tick recvAtomic(PacketPtr pkt);
     Tick recvAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &_backdoor);
     void recvFunctional(PacketPtr pkt);
+    bool recvFunctionalBackdoor(const AddrRange &range,
+                                MemBackdoor::Flags access,
+                                MemBackdoor &_backdoor);
     bool recvTimingReq(PacketPtr pkt);
     void recvRespRetry();
 };
@@ -61,8 +61,8 @@ class DeferEnqueueingStatementAST(StatementAST):
         self.symtab.newSymbol(v)
 
         # Declare message
-        code("std::shared_ptr<${{msg_type.c_ident}}> out_msg = "\
-             "std::make_shared<${{msg_type.c_ident}}>(clockEdge());")
+        code("RefCountingPtr<${{msg_type.c_ident}}> out_msg = "\
+             "new ${{msg_type.c_ident}}(clockEdge());")
 
         # The other statements
         t = self.statements.generate(code, None)
@@ -55,6 +55,8 @@ class StateDeclAST(DeclAST):
         t = Type(self.symtab, ident, self.location, self.pairs,
                  self.state_machine)
         self.symtab.newSymbol(t)
+        if self.state_machine:
+            self.state_machine.StateType = t
 
         # Add all of the states of the type to it
         for state in self.states:
@@ -105,6 +105,7 @@ class StateMachine(Symbol):
         self.objects = []
         self.TBEType   = None
         self.EntryType = None
+        self.StateType = None
         self.debug_flags = set()
         self.debug_flags.add('RubyGenerated')
         self.debug_flags.add('RubySlicc')
@@ -315,6 +316,7 @@ class $c_ident : public AbstractController
     MessageBuffer *getMemReqQueue() const;
     MessageBuffer *getMemRespQueue() const;
     void initNetQueues();
+    AccessPermission initialAccessPermission() const;
 
     void print(std::ostream& out) const;
     void wakeup();
@@ -709,6 +711,15 @@ $c_ident::init()
 }
 ''')
 
+        # Lines no transition has touched are in the default state of the
+        # machine, if it declares one.
+        init_perm = "AccessPermission_NotPresent"
+        if self.StateType != None:
+            default = self.StateType["default"]
+            if default != "%s_NUM" % self.StateType.c_ident:
+                init_perm = "%s_to_permission(%s)" % \
+                    (self.StateType.c_ident, default)
+
         mq_ident = "NULL"
         for port in self.in_ports:
             if port.code.find("mandatoryQueue_ptr") >= 0:
@@ -946,6 +957,12 @@ $c_ident::print(ostream& out) const
     out << "[$c_ident " << m_version << "]";
 }
 
+AccessPermission
+$c_ident::initialAccessPermission() const
+{
+    return $init_perm;
+}
+
 void $c_ident::resetStats()
 {
     for (int state = 0; state < ${ident}_State_NUM; state++) {
@@ -1384,6 +1401,9 @@ if (result == TransitionResult_Valid) {
              printAddress(addr), "Protocol Stall");
 }
 
+// Also after stalls, getState() may have allocated a directory entry.
+recordAccessPermission(addr);
+
 return result;
 ''')
         code.dedent()
@@ -236,7 +236,68 @@ def checkpoint(dir):
     drain()
     memWriteback(root)
     print("Writing checkpoint")
-    _m5.core.serializeAll(dir)
+    sys.stdout.flush()
+    _m5.core.writeCheckpoint(dir)
+
+def setBackgroundCheckpoints(max_in_flight):
+    """Make checkpoint() return as soon as a forked copy of the simulator
+    has been created to write the checkpoint, so that simulation
+    continues meanwhile. At most max_in_flight checkpoints are written
+    at the same time; 0 writes them synchronously again. Checkpoints are
+    still written synchronously while more than one host thread runs,
+    e.g., in a simulation with several event queues."""
+
+    _m5.core.setBackgroundCheckpoints(max_in_flight)
+
+def waitCheckpoints():
+    """Wait until all checkpoints written in the background are done."""
+
+    _m5.core.waitCheckpoints()
+
+# Checkpoints still being written must not be left incomplete on exit.
+atexit.register(waitCheckpoints)
+
+def snapshot(dir=None):
+    """Take an in-process snapshot of the simulator that rewind() can
+    return to any number of times. Physical memory is tracked page by
+    page and the other state is kept in memory; dir receives the files
+    objects write next to their checkpoint sections and defaults to
+    <outdir>/snapshot. Ruby cannot invalidate its caches and is not
+    supported."""
+
+    from m5 import options
+    root = objects.Root.getInstance()
+    if not isinstance(root, objects.Root):
+        raise TypeError("Snapshot must be called on a root object.")
+    for obj in root.descendants():
+        if type(obj).__name__ == 'RubySystem':
+            fatal("Snapshots are not supported with Ruby")
+
+    drain()
+    memWriteback(root)
+    if dir is None:
+        dir = os.path.join(options.outdir, 'snapshot')
+    _m5.core.takeSnapshot(dir)
+
+def rewind():
+    """Return to the state of the last snapshot(). Cached data written
+    since is discarded, and so are all scheduled events: the SimObjects
+    are restored and started up again like from a checkpoint, but exits
+    and stat dumps scheduled from the script must be scheduled again."""
+
+    if not _m5.core.haveSnapshot():
+        fatal("There is no snapshot to rewind to")
+
+    root = objects.Root.getInstance()
+    drain()
+    memInvalidate(root)
+    ckpt = _m5.core.rewindSnapshot()
+    _drain_manager.preCheckpointRestore()
+    _m5.core.unserializeGlobals(ckpt)
+    for obj in root.descendants(): obj.loadState(ckpt)
+    if not need_startup:
+        for obj in root.descendants(): obj.startup()
+    updateStatEvents()
 
 def _changeMemoryMode(system, mode):
     if not isinstance(system, (objects.Root, objects.System)):
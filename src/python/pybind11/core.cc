@@ -53,10 +53,12 @@
 #include "base/random.hh"
 #include "base/socket.hh"
 #include "base/types.hh"
+#include "sim/async_checkpoint.hh"
 #include "sim/core.hh"
 #include "sim/drain.hh"
 #include "sim/serialize.hh"
 #include "sim/sim_object.hh"
+#include "sim/snapshot.hh"
 
 namespace py = pybind11;
 
@@ -275,10 +277,20 @@ pybind_init_core(py::module &m_native)
      */
     m_core
         .def("serializeAll", &Serializable::serializeAll)
+        .def("writeCheckpoint", &AsyncCheckpoint::write)
+        .def("setBackgroundCheckpoints", &AsyncCheckpoint::setMaxInFlight)
+        .def("backgroundCheckpoints", &AsyncCheckpoint::inFlight)
+        .def("waitCheckpoints", &AsyncCheckpoint::waitAll)
         .def("unserializeGlobals", &Serializable::unserializeGlobals)
         .def("getCheckpoint", [](const std::string &cpt_dir) {
             return new CheckpointIn(cpt_dir, pybindSimObjectResolver);
         })
+        .def("takeSnapshot", &Snapshot::take)
+        .def("rewindSnapshot", []() {
+            return Snapshot::rewind(pybindSimObjectResolver);
+        })
+        .def("releaseSnapshot", &Snapshot::release)
+        .def("haveSnapshot", &Snapshot::valid)
 
         ;
 
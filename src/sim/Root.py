@@ -66,6 +66,11 @@ class Root(SimObject):
     # Needs to be set explicitly for a multi-eventq simulation.
     sim_quantum = Param.Tick(0, "simulation quantum")
 
+    # Calendar index on the main event queues. It only speeds up insertion
+    # and removal of events; the order in which they are serviced is the
+    # same either way.
+    eventq_calendar = Param.Bool(False, "index main event queues by tick")
+
     full_system = Param.Bool("if this is a full system simulation")
 
     # Time syncing prevents the simulation from running faster than real time.
@@ -87,6 +87,12 @@ class System(SimObject):
         "use to directly address the backstore from another host-OS process. "
         "Leave this empty to unset the MAP_SHARED flag.")
 
+    # Large configured memories are mostly untouched. A sparse backing
+    # store is mapped without reserving swap, and checkpoints only hold
+    # the pages in use.
+    sparse_backstore = Param.Bool(False, "Only checkpoint the pages of the "
+        "backing store that are in use")
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     byte_order = Param.ByteOrder(default_byte_order,
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/async_checkpoint.hh"
+
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/Checkpoint.hh"
+#include "sim/drain.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+
+namespace AsyncCheckpoint
+{
+
+namespace
+{
+
+struct Writer
+{
+    pid_t pid;
+    std::string dir;
+};
+
+unsigned limit = 0;
+/** Children in the order they were created. */
+std::deque<Writer> writers;
+
+/** Wait for writer w to exit, blocking if requested. */
+bool
+reap(const Writer &w, bool block)
+{
+    int status;
+    pid_t ret;
+    do {
+        ret = waitpid(w.pid, &status, block ? 0 : WNOHANG);
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret == 0)
+        return false;
+    if (ret == -1) {
+        // A process created by m5.fork() inherits the list of writers,
+        // but they are its siblings.
+        if (errno != ECHILD)
+            warn("Lost the process writing checkpoint %s\n", w.dir);
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        warn("Writing checkpoint %s failed\n", w.dir);
+    } else {
+        DPRINTF(Checkpoint, "Checkpoint %s written by process %d\n",
+                w.dir, w.pid);
+    }
+    return true;
+}
+
+/** Forget about the children that have exited. */
+void
+reapFinished()
+{
+    for (auto it = writers.begin(); it != writers.end(); ) {
+        if (reap(*it, false))
+            it = writers.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * The number of threads of this process. Without /proc, assume that
+ * the only other threads are those simulating the other event queues.
+ */
+unsigned
+hostThreads()
+{
+    if (DIR *dir = opendir("/proc/self/task")) {
+        unsigned n = 0;
+        while (struct dirent *entry = readdir(dir)) {
+            if (entry->d_name[0] != '.')
+                n++;
+        }
+        closedir(dir);
+        return n;
+    }
+    return numMainEventQueues;
+}
+
+} // anonymous namespace
+
+void
+setMaxInFlight(unsigned n)
+{
+    limit = n;
+}
+
+unsigned
+maxInFlight()
+{
+    return limit;
+}
+
+void
+write(const std::string &dir)
+{
+    fatal_if(!DrainManager::instance().isDrained(),
+             "The simulator must be drained to write a checkpoint\n");
+
+    if (limit == 0) {
+        Serializable::serializeAll(dir);
+        return;
+    }
+
+    unsigned threads = hostThreads();
+    if (threads > 1) {
+        warn_once("Can't fork with %d host threads running, writing "
+                  "checkpoints in the foreground\n", threads);
+        Serializable::serializeAll(dir);
+        return;
+    }
+
+    reapFinished();
+    while (writers.size() >= limit) {
+        reap(writers.front(), true);
+        writers.pop_front();
+    }
+
+    // Buffered output would otherwise be written by both processes.
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        warn("Can't fork to write checkpoint %s in the background, "
+             "writing it now\n", dir);
+        Serializable::serializeAll(dir);
+        return;
+    }
+
+    if (pid == 0) {
+        // Only this thread exists in the child, and none of the exit
+        // handlers of the simulator must run, so leave with _exit().
+        Serializable::serializeAll(dir);
+        std::cout.flush();
+        std::cerr.flush();
+        fflush(nullptr);
+        _exit(0);
+    }
+
+    DPRINTF(Checkpoint, "Writing checkpoint %s in process %d\n", dir, pid);
+    writers.push_back({pid, dir});
+}
+
+unsigned
+inFlight()
+{
+    reapFinished();
+    return writers.size();
+}
+
+void
+waitAll()
+{
+    while (!writers.empty()) {
+        reap(writers.front(), true);
+        writers.pop_front();
+    }
+}
+
+} // namespace AsyncCheckpoint
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checkpoints written by forked processes while simulation continues.
+ */
+
+#ifndef __SIM_ASYNC_CHECKPOINT_HH__
+#define __SIM_ASYNC_CHECKPOINT_HH__
+
+#include <string>
+
+/**
+ * Background checkpoint writing, e.g., for taking the checkpoints of
+ * many SimPoints from one fast-forward run.
+ *
+ * write() forks the drained simulator. The child shares the memory of
+ * the parent copy-on-write, so it sees the state at the time of the
+ * fork no matter what the parent does next; it serializes everything
+ * with Serializable::serializeAll(), including the compression of the
+ * physical memories, and exits. The parent returns as soon as the child
+ * has been created and continues simulating.
+ *
+ * Every checkpoint in flight costs a process and the host memory of the
+ * pages the parent writes in the meantime, so at most maxInFlight()
+ * children are kept: write() first waits for the oldest one when the
+ * limit has been reached.
+ *
+ * Only the forking thread exists in the child, which would wait forever
+ * for locks other threads held at the time of the fork. While the
+ * simulator runs more than one host thread, e.g., one per event queue
+ * in a parallel simulation, checkpoints are therefore written
+ * synchronously.
+ */
+namespace AsyncCheckpoint
+{
+
+/** Limit the number of checkpoints in flight; 0 writes synchronously. */
+void setMaxInFlight(unsigned n);
+
+unsigned maxInFlight();
+
+/** Write a checkpoint of the drained simulator to dir. */
+void write(const std::string &dir);
+
+/** The number of checkpoints still being written. */
+unsigned inFlight();
+
+/** Wait until all checkpoints have been written. */
+void waitAll();
+
+} // namespace AsyncCheckpoint
+
+#endif // __SIM_ASYNC_CHECKPOINT_HH__
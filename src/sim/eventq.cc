@@ -36,6 +36,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/bitfield.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
@@ -56,6 +57,7 @@ uint32_t numMainEventQueues = 0;
 vector<EventQueue *> mainEventQueue;
 __thread EventQueue *_curEventQueue = NULL;
 bool inParallelMode = false;
+bool eventQueueCalendar = false;
 
 EventQueue *
 getEventQueue(uint32_t index)
@@ -64,11 +66,20 @@ getEventQueue(uint32_t index)
         numMainEventQueues++;
         mainEventQueue.push_back(
             new EventQueue(csprintf("MainEventQueue-%d", index)));
+        mainEventQueue.back()->useCalendar(eventQueueCalendar);
     }
 
     return mainEventQueue[index];
 }
 
+void
+useEventQueueCalendar(bool enable)
+{
+    eventQueueCalendar = enable;
+    for (auto *eq : mainEventQueue)
+        eq->useCalendar(enable);
+}
+
 #ifndef NDEBUG
 Counter Event::instanceCounter = 0;
 #endif
@@ -112,14 +123,21 @@ EventQueue::insert(Event *event)
 {
     // Deal with the head case
     if (!head || *event <= *head) {
+        Event *old_head = head;
         head = Event::insertBefore(event, head);
+        if (usingCalendar())
+            calendarInsert(event, old_head);
         return;
     }
 
     // Figure out either which 'in bin' list we are on, or where a new list
     // needs to be inserted
     Event *prev = head;
-    Event *curr = head->nextBin;
+    if (usingCalendar()) {
+        if (Event *start = calendarStart(event))
+            prev = start;
+    }
+    Event *curr = prev->nextBin;
     while (curr && *curr < *event) {
         prev = curr;
         curr = curr->nextBin;
@@ -128,6 +146,8 @@ EventQueue::insert(Event *event)
     // Note: this operation may render all nextBin pointers on the
     // prev 'in bin' list stale (except for the top one)
     prev->nextBin = Event::insertBefore(event, curr);
+    if (usingCalendar())
+        calendarInsert(event, curr);
 }
 
 Event *
@@ -172,13 +192,20 @@ EventQueue::remove(Event *event)
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
+        Event *top = head;
         head = Event::removeItem(event, head);
+        if (usingCalendar() && event == top)
+            calendarReplace(event, event->nextInBin);
         return;
     }
 
     // Find the 'in bin' list that this event belongs on
     Event *prev = head;
-    Event *curr = head->nextBin;
+    if (usingCalendar()) {
+        if (Event *start = calendarStart(event))
+            prev = start;
+    }
+    Event *curr = prev->nextBin;
     while (curr && *curr < *event) {
         prev = curr;
         curr = curr->nextBin;
@@ -191,6 +218,112 @@ EventQueue::remove(Event *event)
     // we remove an item, it returns the new top item (which may be
     // unchanged)
     prev->nextBin = Event::removeItem(event, curr);
+
+    if (usingCalendar() && event == curr) {
+        // If the bin is gone, the previous bin is the best replacement
+        // as long as it falls in the same bucket.
+        Event *new_top = event->nextInBin;
+        if (!new_top &&
+            calendarBucket(prev->when()) == calendarBucket(event->when())) {
+            new_top = prev;
+        }
+        calendarReplace(event, new_top);
+    }
+}
+
+Event *
+EventQueue::calendarStart(const Event *event) const
+{
+    const uint64_t cur = calendarBucket(_curTick);
+    const uint64_t target = calendarBucket(event->when());
+    if (target <= cur)
+        return nullptr;
+
+    // Scan the buckets preceding the target one, latest first, down to
+    // the bucket of the current tick, a bitmap word at a time.
+    uint64_t bucket = std::min<uint64_t>(target - 1,
+                                         cur + NumCalendarBuckets - 1);
+    uint64_t left = bucket - cur + 1;
+    while (left > 0) {
+        const size_t slot = bucket % NumCalendarBuckets;
+        const unsigned bit = slot % 64;
+        uint64_t bits = calendarOccupied[slot / 64] & mask(bit + 1);
+        if (left <= bit)
+            bits &= ~mask(bit + 1 - left);
+        while (bits) {
+            const unsigned b = findMsbSet(bits);
+            Event *bin = calendar[slot - bit + b];
+            if (calendarBucket(bin->when()) == bucket - (bit - b))
+                return bin;
+            bits &= ~(ULL(1) << b);
+        }
+        const uint64_t step = std::min<uint64_t>(left, bit + 1);
+        left -= step;
+        bucket -= step;
+    }
+    return nullptr;
+}
+
+void
+EventQueue::calendarInsert(Event *event, Event *curr)
+{
+    if (curr && *curr == *event)
+        calendarReplace(curr, event);
+    else
+        calendarAdd(event);
+}
+
+void
+EventQueue::calendarAdd(Event *bin)
+{
+    const uint64_t bucket = calendarBucket(bin->when());
+    if (bucket - calendarBucket(_curTick) >= NumCalendarBuckets)
+        return;
+
+    const size_t slot = bucket % NumCalendarBuckets;
+    Event *&entry = calendar[slot];
+    if (!entry || calendarBucket(entry->when()) != bucket || *entry < *bin) {
+        entry = bin;
+        calendarOccupied[slot / 64] |= ULL(1) << (slot % 64);
+    }
+}
+
+void
+EventQueue::calendarReplace(Event *old_top, Event *new_top)
+{
+    const size_t slot = calendarBucket(old_top->when()) % NumCalendarBuckets;
+    if (calendar[slot] != old_top)
+        return;
+
+    calendar[slot] = new_top;
+    if (!new_top)
+        calendarOccupied[slot / 64] &= ~(ULL(1) << (slot % 64));
+}
+
+void
+EventQueue::calendarRebuild()
+{
+    std::fill(calendar.begin(), calendar.end(), nullptr);
+    std::fill(calendarOccupied.begin(), calendarOccupied.end(), 0);
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        calendarAdd(bin);
+}
+
+void
+EventQueue::useCalendar(bool enable)
+{
+    if (enable == usingCalendar())
+        return;
+
+    if (enable) {
+        calendar.assign(NumCalendarBuckets, nullptr);
+        calendarOccupied.assign(NumCalendarBuckets / 64, 0);
+        calendarRebuild();
+    } else {
+        calendar.clear();
+        calendar.shrink_to_fit();
+        calendarOccupied.clear();
+    }
 }
 
 Event *
@@ -212,6 +345,8 @@ EventQueue::serviceOne()
         // the 'in bin' list and point to the next bin list
         head = head->nextBin;
     }
+    if (usingCalendar())
+        calendarReplace(event, next);
 
     // handle action
     if (!event->squashed()) {
@@ -356,6 +491,8 @@ EventQueue::replaceHead(Event* s)
 {
     Event* t = head;
     head = s;
+    if (usingCalendar())
+        calendarRebuild();
     return t;
 }
 
@@ -438,9 +575,48 @@ EventQueue::handleAsyncInsertions()
     async_queue_mutex.lock();
 
     while (!async_queue.empty()) {
-        insert(async_queue.front());
+        Event *event = async_queue.front();
+        if (event->when() < getCurTick())
+            event->setWhen(getCurTick(), this);
+        insert(event);
         async_queue.pop_front();
     }
 
     async_queue_mutex.unlock();
 }
+
+void
+EventQueue::descheduleAll()
+{
+    handleAsyncInsertions();
+    while (!empty())
+        deschedule(getHead());
+}
+
+//! Number of live ScopedStopAll instances on this thread.
+static thread_local int scopedStopAllDepth = 0;
+
+EventQueue::ScopedStopAll::ScopedStopAll()
+    : counted(inParallelMode), active(false)
+{
+    if (!counted || scopedStopAllDepth++ > 0)
+        return;
+
+    active = true;
+    curEventQueue()->unlock();
+    for (EventQueue *eq : mainEventQueue)
+        eq->lock();
+}
+
+EventQueue::ScopedStopAll::~ScopedStopAll()
+{
+    if (active) {
+        for (auto it = mainEventQueue.rbegin(); it != mainEventQueue.rend();
+             ++it) {
+            (*it)->unlock();
+        }
+        curEventQueue()->lock();
+    }
+    if (counted)
+        scopedStopAllDepth--;
+}
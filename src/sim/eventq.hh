@@ -43,9 +43,13 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "base/debug.hh"
 #include "base/flags.hh"
+#include "base/pool_alloc.hh"
 #include "base/types.hh"
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
@@ -74,6 +78,13 @@ extern __thread EventQueue *_curEventQueue;
 //! Current mode of execution: parallel / serial
 extern bool inParallelMode;
 
+//! Whether main event queues keep a calendar index of their bins.
+extern bool eventQueueCalendar;
+
+//! Enable or disable the calendar index on all current and future main
+//! event queues.
+void useEventQueueCalendar(bool enable);
+
 //! Function for returning eventq queue for the provided
 //! index. The function allocates a new queue in case one
 //! does not exist for the index, provided that the index
@@ -659,6 +670,39 @@ class EventQueue
     //! owning thread, should call this function instead of insert().
     void asyncInsert(Event *event);
 
+    /**
+     * Optional calendar index over the bin list.
+     *
+     * insert() and remove() normally walk the bin list from the head,
+     * which is linear in the number of distinct (when, priority) pairs
+     * in the queue. The calendar is a circular array of buckets, each
+     * covering 2^CalendarShift ticks of the NumCalendarBuckets-bucket
+     * window starting at the current tick. A bucket remembers the top
+     * event of the latest bin known to fall in it, so a walk can start
+     * from the closest non-empty bucket preceding the target tick
+     * instead. The bin list itself is untouched, so the service order
+     * and everything else that looks at the queue stays the same.
+     *
+     * Invariant: every non-null bucket entry is the top event of a bin
+     * currently in the list. Entries are validated against the bucket
+     * they are looked up for, so aliasing across windows is harmless.
+     */
+    static const int CalendarShift = 9;
+    static const size_t NumCalendarBuckets = 1024;
+    std::vector<Event *> calendar;
+    //! One bit per calendar bucket, set if the entry is non-null.
+    std::vector<uint64_t> calendarOccupied;
+
+    uint64_t calendarBucket(Tick when) const { return when >> CalendarShift; }
+    //! Top of a bin before event, as late as the calendar knows, or NULL.
+    Event *calendarStart(const Event *event) const;
+    //! Record that event was inserted in front of (or onto) curr's bin.
+    void calendarInsert(Event *event, Event *curr);
+    void calendarAdd(Event *bin);
+    //! The bin topped by old_top is now topped by new_top (or gone).
+    void calendarReplace(Event *old_top, Event *new_top);
+    void calendarRebuild();
+
     EventQueue(const EventQueue &);
 
   public:
@@ -735,6 +779,31 @@ class EventQueue
         EventQueue &eq;
     };
 
+    class ScopedStopAll
+    {
+      public:
+        /**
+         * Temporarily stop all main event queues between events.
+         *
+         * Releases the current queue and then locks every main event
+         * queue in index order, so that state owned by several queues
+         * can be inspected and modified consistently, e.g., functional
+         * accesses to a memory system that is spread over multiple
+         * queues. Taking the locks in a fixed order after releasing the
+         * own queue keeps this deadlock-free against ScopedMigration and
+         * other instances of this class.
+         *
+         * ScopedStopAll does nothing outside of parallel mode or when
+         * nested in another instance on the same thread.
+         */
+        ScopedStopAll();
+        ~ScopedStopAll();
+
+      private:
+        bool counted;
+        bool active;
+    };
+
     /**
      * @ingroup api_eventq
      */
@@ -756,7 +825,10 @@ class EventQueue
     void
     schedule(Event *event, Tick when, bool global=false)
     {
-        assert(when >= getCurTick());
+        // The tick of another thread's queue cannot be read safely;
+        // handleAsyncInsertions() catches up late asynchronous events.
+        assert((inParallelMode && this != curEventQueue()) ||
+               when >= getCurTick());
         assert(!event->scheduled());
         assert(event->initialized());
 
@@ -850,6 +922,13 @@ class EventQueue
     Tick getCurTick() const { return _curTick; }
     Event *getHead() const { return head; }
 
+    /**
+     * Enable or disable the calendar index. Does not change the order in
+     * which events are serviced.
+     */
+    void useCalendar(bool enable);
+    bool usingCalendar() const { return !calendar.empty(); }
+
     Event *serviceOne();
 
     /**
@@ -902,9 +981,19 @@ class EventQueue
 
     /**
      * Function for moving events from the async_queue to the main queue.
+     * Events that were scheduled by another thread for a tick this queue
+     * has already passed are serviced at the current tick instead.
      */
     void handleAsyncInsertions();
 
+    /**
+     * Deschedule every event, including those other threads inserted
+     * asynchronously, e.g., before returning to an earlier state whose
+     * objects schedule their events again. Events that are deleted
+     * after dispatch are released.
+     */
+    void descheduleAll();
+
     /**
      *  Function to signal that the event loop should be woken up because
      *  an event has been scheduled by an agent outside the gem5 event
@@ -1105,6 +1194,15 @@ class EventFunctionWrapper : public Event
       std::string _name;
 
   public:
+    /**
+     * Wrappers created with new, typically with del set, come from the
+     * pool of the calling thread rather than from malloc.
+     */
+    static void *operator new(size_t size)
+    { return PoolAlloc::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { PoolAlloc::deallocate(p, size); }
+
     /**
      * This function wraps a function into an event, to be
      * executed later.
@@ -1141,4 +1239,76 @@ class EventFunctionWrapper : public Event
     const char *description() const { return "EventFunctionWrapped"; }
 };
 
+/**
+ * Base of events that are created with new for a single use. They are
+ * AutoDelete, so the queue deletes them once they have been processed
+ * or descheduled. Their memory is taken from and returned to the
+ * PoolAlloc free lists of the calling thread.
+ */
+class PooledEvent : public Event
+{
+  public:
+    PooledEvent(Priority p = Default_Pri) : Event(p, AutoDelete) {}
+
+    static void *operator new(size_t size)
+    { return PoolAlloc::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { PoolAlloc::deallocate(p, size); }
+};
+
+/**
+ * A pooled one-shot event that calls a callable, for the transient
+ * events otherwise made with new EventFunctionWrapper(..., true).
+ * Unlike EventFunctionWrapper it does not allocate: the callable is
+ * stored in the event itself and must fit in MaxCallableSize bytes,
+ * e.g., a lambda capturing a few pointers, and the name is not copied,
+ * so it must outlive the event, e.g., a literal or the name in the
+ * params of a SimObject.
+ *
+ *     schedule(new OneShotEvent([this, pkt]{ send(pkt); }, "send"), when);
+ */
+class OneShotEvent : public PooledEvent
+{
+  public:
+    static constexpr size_t MaxCallableSize = 6 * sizeof(void *);
+
+    template <typename F>
+    OneShotEvent(F &&f, const char *name, Priority p = Default_Pri)
+        : PooledEvent(p), _name(name)
+    {
+        typedef typename std::decay<F>::type Callable;
+        static_assert(sizeof(Callable) <= MaxCallableSize,
+                      "Callable too large for a OneShotEvent");
+        static_assert(alignof(Callable) <= alignof(Storage),
+                      "Callable too strictly aligned for a OneShotEvent");
+
+        new (&storage) Callable(std::forward<F>(f));
+        invoke = [](void *c) { (*static_cast<Callable *>(c))(); };
+        destroy = [](void *c) { static_cast<Callable *>(c)->~Callable(); };
+    }
+
+    ~OneShotEvent() { destroy(&storage); }
+
+    OneShotEvent(const OneShotEvent &) = delete;
+    OneShotEvent &operator=(const OneShotEvent &) = delete;
+
+    void process() override { invoke(&storage); }
+
+    const std::string
+    name() const override
+    {
+        return std::string(_name) + ".one_shot_event";
+    }
+
+    const char *description() const override { return "OneShot"; }
+
+  private:
+    typedef typename std::aligned_storage<MaxCallableSize>::type Storage;
+
+    Storage storage;
+    void (*invoke)(void *);
+    void (*destroy)(void *);
+    const char *_name;
+};
+
 #endif // __SIM_EVENTQ_HH__
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "base/pool_alloc.hh"
+#include "sim/eventq.hh"
+
+namespace {
+
+/** A pooled event of a larger size class than a OneShotEvent. */
+class WideEvent : public PooledEvent
+{
+  public:
+    explicit WideEvent(int *processed) : processed(processed) {}
+    void process() override { ++*processed; }
+    const char *description() const override { return "Wide"; }
+
+  private:
+    int *processed;
+    char pad[512];
+};
+
+} // anonymous namespace
+
+/** Pooled events come from and go back to the free lists of PoolAlloc. */
+TEST(PooledEventTest, Allocation)
+{
+    PoolAlloc::Counters before = PoolAlloc::totals();
+    auto *e = new OneShotEvent([]{}, "alloc");
+    PoolAlloc::Counters after = PoolAlloc::totals();
+    EXPECT_EQ(after.allocs, before.allocs + 1);
+    EXPECT_EQ(after.oversized, before.oversized);
+
+    void *freed = e;
+    delete e;
+    EXPECT_EQ(PoolAlloc::totals().releases, after.releases + 1);
+    // The free list hands the block back out first.
+    auto *again = new OneShotEvent([]{}, "again");
+    EXPECT_EQ(static_cast<void *>(again), freed);
+    delete again;
+}
+
+/**
+ * Deleting through a PooledEvent pointer returns the block to the free
+ * list of the size class of the event's own type.
+ */
+TEST(PooledEventTest, SizedDelete)
+{
+    int processed = 0;
+    PooledEvent *wide = new WideEvent(&processed);
+    void *wide_block = wide;
+    delete wide;
+
+    // A OneShotEvent is in another size class, so it does not get the
+    // block of the WideEvent, and the next WideEvent does.
+    auto *small = new OneShotEvent([]{}, "small");
+    EXPECT_NE(static_cast<void *>(small), wide_block);
+    PooledEvent *wide2 = new WideEvent(&processed);
+    EXPECT_EQ(static_cast<void *>(wide2), wide_block);
+    delete small;
+    delete wide2;
+    ASSERT_NE(PoolAlloc::sizeClass(sizeof(WideEvent)),
+              PoolAlloc::sizeClass(sizeof(OneShotEvent)));
+}
+
+/**
+ * A OneShotEvent runs its callable once and the queue deletes it, which
+ * destroys the callable and whatever it captured.
+ */
+TEST(OneShotEventTest, ProcessAutoDelete)
+{
+    EventQueue eq("one_shot_eq");
+    int runs = 0;
+    auto sentinel = std::make_shared<int>(0);
+    std::weak_ptr<int> alive = sentinel;
+
+    auto *e = new OneShotEvent([&runs, sentinel]{ ++runs; }, "bump");
+    sentinel.reset();
+    EXPECT_TRUE(e->isAutoDelete());
+    EXPECT_EQ(e->name(), "bump.one_shot_event");
+    EXPECT_STREQ(e->description(), "OneShot");
+
+    eq.schedule(e, 100);
+    EXPECT_FALSE(alive.expired());
+    eq.serviceOne();
+    EXPECT_EQ(eq.getCurTick(), 100);
+    EXPECT_EQ(runs, 1);
+    EXPECT_TRUE(eq.empty());
+    EXPECT_TRUE(alive.expired());
+}
+
+/** Descheduling a OneShotEvent deletes it without running it. */
+TEST(OneShotEventTest, DescheduleDeletes)
+{
+    EventQueue eq("one_shot_eq");
+    int runs = 0;
+    auto sentinel = std::make_shared<int>(0);
+    std::weak_ptr<int> alive = sentinel;
+
+    auto *e = new OneShotEvent([&runs, sentinel]{ ++runs; }, "never");
+    sentinel.reset();
+    eq.schedule(e, 50);
+    eq.deschedule(e);
+    EXPECT_TRUE(eq.empty());
+    EXPECT_EQ(runs, 0);
+    EXPECT_TRUE(alive.expired());
+}
+
+/** Pooled events of other types are AutoDelete too. */
+TEST(PooledEventTest, AutoDelete)
+{
+    EventQueue eq("pooled_eq");
+    int processed = 0;
+    PoolAlloc::Counters before = PoolAlloc::totals();
+    eq.schedule(new WideEvent(&processed), 10);
+    eq.schedule(new WideEvent(&processed), 20);
+    eq.serviceOne();
+    eq.serviceOne();
+    EXPECT_EQ(processed, 2);
+    PoolAlloc::Counters after = PoolAlloc::totals();
+    EXPECT_EQ(after.allocs - before.allocs, 2u);
+    EXPECT_EQ(after.releases - before.releases, 2u);
+}
@@ -112,6 +112,7 @@ Root::Root(RootParams *p)
     lastTime.setTimer();
 
     simQuantum = p->sim_quantum;
+    useEventQueueCalendar(p->eventq_calendar);
 }
 
 void
@@ -195,11 +195,17 @@ Serializable::serializeAll(const string &cpt_dir)
         fatal("Unable to open file %s for writing\n", cpt_file.c_str());
     outstream << "## checkpoint generated: " << ctime(&t);
 
-    globals.serializeSection(outstream, "Globals");
+    serializeGlobals(outstream);
 
     SimObject::serializeAll(outstream);
 }
 
+void
+Serializable::serializeGlobals(CheckpointOut &cp)
+{
+    globals.serializeSection(cp, "Globals");
+}
+
 void
 Serializable::unserializeGlobals(CheckpointIn &cp)
 {
@@ -274,6 +280,14 @@ CheckpointIn::CheckpointIn(const string &cpt_dir, SimObjectResolver &resolver)
     }
 }
 
+CheckpointIn::CheckpointIn(istream &is, const string &cpt_dir,
+                           SimObjectResolver &resolver)
+    : db(new IniFile), objNameResolver(resolver), _cptDir(setDir(cpt_dir))
+{
+    if (!db->load(is))
+        fatal("Can't load checkpoint from stream\n");
+}
+
 CheckpointIn::~CheckpointIn()
 {
     delete db;
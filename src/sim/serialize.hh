@@ -76,6 +76,14 @@ class CheckpointIn
 
   public:
     CheckpointIn(const std::string &cpt_dir, SimObjectResolver &resolver);
+
+    /**
+     * Read a checkpoint from a stream rather than from the m5.cpt file
+     * in cpt_dir, e.g., an in-memory snapshot. Files the objects wrote
+     * next to it are still looked up in cpt_dir.
+     */
+    CheckpointIn(std::istream &is, const std::string &cpt_dir,
+                 SimObjectResolver &resolver);
     ~CheckpointIn();
 
     /**
@@ -310,6 +318,12 @@ class Serializable
      */
     static void serializeAll(const std::string &cpt_dir);
 
+    /**
+     * Serializes the global state, i.e., the current tick, into the
+     * Globals section.
+     */
+    static void serializeGlobals(CheckpointOut &cp);
+
     /**
      * @ingroup api_serialize
      */
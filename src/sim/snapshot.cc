@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/snapshot.hh"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <sstream>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/Checkpoint.hh"
+#include "sim/drain.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+#include "sim/sim_object.hh"
+#include "sim/system.hh"
+
+namespace Snapshot
+{
+
+namespace
+{
+
+bool haveSnapshot = false;
+bool inCapture = false;
+std::string snapshotDir;
+std::string snapshotState;
+
+} // anonymous namespace
+
+void
+take(const std::string &dir)
+{
+    fatal_if(!DrainManager::instance().isDrained(),
+             "The simulator must be drained to take a snapshot\n");
+
+    release();
+
+    snapshotDir = CheckpointIn::setDir(dir);
+    if (mkdir(snapshotDir.c_str(), 0775) == -1 && errno != EEXIST)
+        fatal("couldn't mkdir %s\n", snapshotDir);
+
+    for (auto *sys : System::systemList)
+        sys->getPhysMem().takeSnapshot();
+
+    std::ostringstream os;
+    inCapture = true;
+    Serializable::serializeGlobals(os);
+    SimObject::serializeAll(os);
+    inCapture = false;
+
+    snapshotState = os.str();
+    haveSnapshot = true;
+    DPRINTF(Checkpoint, "Snapshot taken, %d bytes of SimObject state\n",
+            snapshotState.size());
+}
+
+CheckpointIn *
+rewind(SimObjectResolver &resolver)
+{
+    fatal_if(!haveSnapshot, "There is no snapshot to rewind to\n");
+    fatal_if(!DrainManager::instance().isDrained(),
+             "The simulator must be drained to rewind to a snapshot\n");
+
+    for (auto *sys : System::systemList)
+        sys->getPhysMem().rewindSnapshot();
+
+    // Events scheduled since the snapshot belong to a future that is
+    // discarded, and the events of the snapshot are scheduled again by
+    // the objects that own them when they are unserialized.
+    EventQueue *cur = curEventQueue();
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        curEventQueue(mainEventQueue[i]);
+        mainEventQueue[i]->descheduleAll();
+    }
+    curEventQueue(cur);
+
+    std::istringstream is(snapshotState);
+    return new CheckpointIn(is, snapshotDir, resolver);
+}
+
+void
+release()
+{
+    if (!haveSnapshot)
+        return;
+
+    for (auto *sys : System::systemList)
+        sys->getPhysMem().releaseSnapshot();
+    snapshotState.clear();
+    haveSnapshot = false;
+}
+
+bool
+valid()
+{
+    return haveSnapshot;
+}
+
+bool
+capturing()
+{
+    return inCapture;
+}
+
+} // namespace Snapshot
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * In-process snapshots of a drained simulator.
+ */
+
+#ifndef __SIM_SNAPSHOT_HH__
+#define __SIM_SNAPSHOT_HH__
+
+#include <string>
+
+class CheckpointIn;
+class SimObjectResolver;
+
+/**
+ * In-process snapshots for returning to the same point of a simulation
+ * many times, e.g., to replay one victim window under different
+ * defense settings or attacker schedules.
+ *
+ * take() serializes all SimObjects with the regular checkpoint code into
+ * a memory buffer, except for the physical memories, which are instead
+ * tracked page by page (see PhysicalMemory::takeSnapshot()). rewind()
+ * copies back the pages written since, deschedules all events and
+ * returns a checkpoint reading from the buffer, from which the caller
+ * unserializes the SimObjects and starts them up again like after a
+ * regular restore (see m5.rewind()). Files that objects write next to
+ * their checkpoint sections go to the directory given to take().
+ *
+ * As with a restore, only serialized state returns to the snapshot.
+ * Events scheduled by anything but SimObjects, e.g., exits and periodic
+ * statistics dumps scheduled from the configuration script, are lost and
+ * have to be scheduled again after a rewind.
+ */
+namespace Snapshot
+{
+
+/** Take a snapshot of the drained simulator, replacing any previous one. */
+void take(const std::string &dir);
+
+/**
+ * Restore the physical memories of the snapshot, empty the event queues
+ * and return a checkpoint holding the state of the SimObjects. The
+ * snapshot stays valid.
+ */
+CheckpointIn *rewind(SimObjectResolver &resolver);
+
+/** Drop the snapshot and stop tracking memory changes. */
+void release();
+
+/** Whether there is a snapshot to rewind to. */
+bool valid();
+
+/** Whether take() is serializing the SimObjects. */
+bool capturing();
+
+} // namespace Snapshot
+
+#endif // __SIM_SNAPSHOT_HH__
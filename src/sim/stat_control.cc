@@ -51,10 +51,12 @@
 
 #include "base/callback.hh"
 #include "base/hostinfo.hh"
+#include "base/pool_alloc.hh"
 #include "base/statistics.hh"
 #include "base/time.hh"
 #include "cpu/base.hh"
 #include "sim/global_event.hh"
+#include "sim/system.hh"
 
 using namespace std;
 
@@ -92,6 +94,40 @@ statFinalTick()
     return curTick();
 }
 
+Counter
+poolAllocs()
+{
+    return PoolAlloc::totals().allocs;
+}
+
+Counter
+poolLiveBlocks()
+{
+    PoolAlloc::Counters c = PoolAlloc::totals();
+    return c.allocs - c.releases;
+}
+
+Counter
+poolBytes()
+{
+    return PoolAlloc::totals().slabs * PoolAlloc::SlabBytes;
+}
+
+Counter
+poolOversized()
+{
+    return PoolAlloc::totals().oversized;
+}
+
+Counter
+pmemResidentBytes()
+{
+    Counter bytes = 0;
+    for (auto *sys : System::systemList)
+        bytes += sys->getPhysMem().residentSize();
+    return bytes;
+}
+
 struct Global
 {
     Stats::Formula hostInstRate;
@@ -99,6 +135,11 @@ struct Global
     Stats::Formula hostTickRate;
     Stats::Value hostMemory;
     Stats::Value hostSeconds;
+    Stats::Value hostPoolAllocs;
+    Stats::Value hostPoolLiveBlocks;
+    Stats::Value hostPoolBytes;
+    Stats::Value hostPoolOversized;
+    Stats::Value hostPmemResident;
 
     Stats::Value simInsts;
     Stats::Value simOps;
@@ -176,6 +217,46 @@ Global::Global()
         .precision(2)
         ;
 
+    hostPoolAllocs
+        .functor(poolAllocs)
+        .name("host_pool_allocs")
+        .desc("Number of objects allocated from the host memory pools")
+        .precision(0)
+        .prereq(hostPoolAllocs)
+        ;
+
+    hostPoolLiveBlocks
+        .functor(poolLiveBlocks)
+        .name("host_pool_live_blocks")
+        .desc("Number of host memory pool blocks currently in use")
+        .precision(0)
+        .prereq(hostPoolAllocs)
+        ;
+
+    hostPoolBytes
+        .functor(poolBytes)
+        .name("host_pool_bytes")
+        .desc("Number of bytes of host memory reserved by the pools")
+        .precision(0)
+        .prereq(hostPoolBytes)
+        ;
+
+    hostPoolOversized
+        .functor(poolOversized)
+        .name("host_pool_oversized")
+        .desc("Number of pool requests too large to be pooled")
+        .precision(0)
+        .prereq(hostPoolOversized)
+        ;
+
+    hostPmemResident
+        .functor(pmemResidentBytes)
+        .name("host_pmem_resident")
+        .desc("Number of bytes of simulated memory backed by host memory")
+        .precision(0)
+        .prereq(hostPmemResident)
+        ;
+
     hostTickRate
         .name("host_tick_rate")
         .desc("Simulator tick rate (ticks/s)")
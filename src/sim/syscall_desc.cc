@@ -30,6 +30,7 @@
 #include "sim/syscall_desc.hh"
 
 #include "base/types.hh"
+#include "sim/eventq.hh"
 #include "sim/syscall_debug_macros.hh"
 
 class ThreadContext;
@@ -39,6 +40,11 @@ SyscallDesc::doSyscall(ThreadContext *tc)
 {
     DPRINTF_SYSCALL(Base, "Calling %s...\n", dumper(name(), tc));
 
+    // Emulated system calls touch state shared by all cores (processes,
+    // page tables, futexes) and access memory functionally, so they are
+    // serialised against cores running on other event queues.
+    EventQueue::ScopedStopAll stop_all;
+
     SyscallReturn retval = executor(this, tc);
 
     if (retval.needsRetry())
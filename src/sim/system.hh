@@ -42,6 +42,7 @@
 #ifndef __SYSTEM_HH__
 #define __SYSTEM_HH__
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -600,7 +601,8 @@ class System : public SimObject, public PCEventScope
     void drainResume() override;
 
   public:
-    Counter totalNumInsts;
+    /** Updated by all CPUs, possibly from different host threads. */
+    std::atomic<Counter> totalNumInsts;
     std::map<std::pair<uint32_t,uint32_t>, Tick>  lastWorkItemStarted;
     std::map<uint32_t, Stats::Histogram*> workItemStats;
 
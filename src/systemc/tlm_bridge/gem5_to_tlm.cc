@@ -341,7 +341,7 @@ Gem5ToTlmBridge<BITWIDTH>::recvTimingReq(PacketPtr packet)
         // The Timing annotation must be honored:
         sc_assert(phase == tlm::END_REQ || phase == tlm::BEGIN_RESP);
         auto cb = [this, trans, phase]() { pec(*trans, phase); };
-        system->schedule(new EventFunctionWrapper(cb, "pec", true),
+        system->schedule(new OneShotEvent(cb, "pec"),
                          curTick() + delay.value());
     } else if (status == tlm::TLM_COMPLETED) {
         // Transaction is over nothing has do be done.
@@ -416,7 +416,7 @@ Gem5ToTlmBridge<BITWIDTH>::nb_transport_bw(tlm::tlm_generic_payload &trans,
     tlm::tlm_phase &phase, sc_core::sc_time &delay)
 {
     auto cb = [this, &trans, phase]() { pec(trans, phase); };
-    system->schedule(new EventFunctionWrapper(cb, "pec", true),
+    system->schedule(new OneShotEvent(cb, "pec"),
                      curTick() + delay.value());
     return tlm::TLM_ACCEPTED;
 }
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Compares the plain bin list of EventQueue with its calendar index.
+ *
+ * Without arguments a synthetic workload of self-rescheduling clocked
+ * events is run. With a file argument, the event stream recorded in a
+ * gem5 trace produced with --debug-flags=Event is replayed instead. In
+ * both cases the order in which events are serviced must be the same
+ * with and without the calendar.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "sim/eventq.hh"
+
+using namespace std;
+
+namespace {
+
+vector<int> serviced;
+
+class BenchEvent : public Event
+{
+  public:
+    BenchEvent(int _id, EventQueue *_eq, Tick _period)
+        : id(_id), eq(_eq), period(_period)
+    {}
+
+    void
+    process() override
+    {
+        serviced.push_back(id);
+        if (period)
+            eq->schedule(this, eq->getCurTick() + period);
+    }
+
+    const char *description() const override { return "bench"; }
+
+    int id;
+    EventQueue *eq;
+    Tick period;
+};
+
+struct Op
+{
+    enum Kind { Schedule, Deschedule, Execute } kind;
+    int id;
+    Tick when;
+};
+
+double
+runSynthetic(bool calendar, uint64_t num_events, int num_objects)
+{
+    EventQueue eq("bench");
+    eq.useCalendar(calendar);
+    serviced.clear();
+    serviced.reserve(num_events);
+
+    // Clocked objects with periods of 1-200 cycles at 500 ticks each,
+    // plus the occasional far-future one-shot event.
+    mt19937 rng(1);
+    vector<unique_ptr<BenchEvent>> events;
+    for (int i = 0; i < num_objects; i++) {
+        Tick period = (i % 16 == 0) ? 0 : 500 * (1 + rng() % 200);
+        events.emplace_back(new BenchEvent(i, &eq, period));
+        eq.schedule(events.back().get(), 500 * (rng() % 200));
+    }
+
+    auto start = chrono::steady_clock::now();
+    while (serviced.size() < num_events && !eq.empty())
+        eq.serviceOne();
+    auto end = chrono::steady_clock::now();
+
+    while (!eq.empty())
+        eq.deschedule(eq.getHead());
+    return chrono::duration<double>(end - start).count();
+}
+
+/**
+ * Parse the "<instance> <action> @ <when>" suffix of Event trace lines.
+ */
+vector<Op>
+parseTrace(const string &path, int &num_ids)
+{
+    ifstream in(path);
+    if (!in) {
+        cerr << "cannot open " << path << endl;
+        exit(1);
+    }
+
+    map<string, int> ids;
+    vector<Op> ops;
+    string line;
+    while (getline(in, line)) {
+        istringstream ss(line);
+        vector<string> tok;
+        string t;
+        while (ss >> t)
+            tok.push_back(t);
+        if (tok.size() < 4 || tok[tok.size() - 2] != "@")
+            continue;
+
+        const string &action = tok[tok.size() - 3];
+        Op op;
+        if (action == "scheduled" || action == "rescheduled")
+            op.kind = Op::Schedule;
+        else if (action == "descheduled")
+            op.kind = Op::Deschedule;
+        else if (action == "executed")
+            op.kind = Op::Execute;
+        else
+            continue;
+
+        auto it = ids.emplace(tok[tok.size() - 4], ids.size()).first;
+        op.id = it->second;
+        op.when = stoull(tok.back());
+        ops.push_back(op);
+    }
+    num_ids = ids.size();
+    return ops;
+}
+
+double
+runTrace(bool calendar, const vector<Op> &ops, int num_ids)
+{
+    EventQueue eq("bench");
+    eq.useCalendar(calendar);
+    serviced.clear();
+    serviced.reserve(ops.size());
+
+    vector<unique_ptr<BenchEvent>> events;
+    for (int i = 0; i < num_ids; i++)
+        events.emplace_back(new BenchEvent(i, &eq, 0));
+
+    auto start = chrono::steady_clock::now();
+    for (const Op &op : ops) {
+        BenchEvent *event = events[op.id].get();
+        switch (op.kind) {
+          case Op::Schedule:
+            eq.reschedule(event, max(op.when, eq.getCurTick()), true);
+            break;
+          case Op::Deschedule:
+            if (event->scheduled())
+                eq.deschedule(event);
+            break;
+          case Op::Execute:
+            // Priorities are not recorded, so other events of the same
+            // tick may have to be serviced first.
+            while (event->scheduled())
+                eq.serviceOne();
+            break;
+        }
+    }
+    while (!eq.empty())
+        eq.serviceOne();
+    auto end = chrono::steady_clock::now();
+
+    return chrono::duration<double>(end - start).count();
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    vector<int> order[2];
+    double seconds[2];
+
+    if (argc > 1) {
+        int num_ids = 0;
+        vector<Op> ops = parseTrace(argv[1], num_ids);
+        cprintf("replaying %d operations on %d events from %s\n",
+                ops.size(), num_ids, argv[1]);
+        for (int cal = 0; cal < 2; cal++) {
+            seconds[cal] = runTrace(cal, ops, num_ids);
+            order[cal].swap(serviced);
+        }
+    } else {
+        for (int objects : {64, 512, 4096}) {
+            for (int cal = 0; cal < 2; cal++) {
+                seconds[cal] = runSynthetic(cal, 4000000, objects);
+                order[cal].swap(serviced);
+            }
+            cprintf("%5d objects: list %.3fs, calendar %.3fs, order %s\n",
+                    objects, seconds[0], seconds[1],
+                    order[0] == order[1] ? "identical" : "DIFFERENT");
+            if (order[0] != order[1])
+                return 1;
+        }
+        return 0;
+    }
+
+    cprintf("list %.3fs, calendar %.3fs, %d events serviced, order %s\n",
+            seconds[0], seconds[1], order[0].size(),
+            order[0] == order[1] ? "identical" : "DIFFERENT");
+    return order[0] == order[1] ? 0 : 1;
+}
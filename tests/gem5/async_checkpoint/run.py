@@ -0,0 +1,121 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Runs a program on a TimingSimpleCPU and writes checkpoints along the
+way in forked background processes, at most --jobs at a time. Once the
+program ended and the checkpoints are written, each of them is restored
+in a gem5 of its own and the program runs to its end again.
+'''
+
+import argparse
+import os
+import subprocess
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import fatal
+
+parser = argparse.ArgumentParser()
+parser.add_argument('binary', type = str)
+parser.add_argument('--checkpoint-ticks', type = int, nargs = '+',
+                    default = [1000000, 2000000, 3000000])
+parser.add_argument('--jobs', type = int, default = 2)
+parser.add_argument('--restore', type = str, default = None)
+
+args = parser.parse_args()
+
+system = System()
+
+system.clk_domain = SrcClockDomain()
+system.clk_domain.clock = '1GHz'
+system.clk_domain.voltage_domain = VoltageDomain()
+
+system.mem_mode = 'timing'
+system.mem_ranges = [AddrRange('512MB')]
+
+system.cpu = TimingSimpleCPU()
+system.membus = SystemXBar()
+system.cpu.icache_port = system.membus.slave
+system.cpu.dcache_port = system.membus.slave
+
+system.cpu.createInterruptController()
+if m5.defines.buildEnv['TARGET_ISA'] == "x86":
+    system.cpu.interrupts[0].pio = system.membus.master
+    system.cpu.interrupts[0].int_master = system.membus.slave
+    system.cpu.interrupts[0].int_slave = system.membus.master
+
+system.mem_ctrl = SimpleMemory(latency = '1ns')
+system.mem_ctrl.range = system.mem_ranges[0]
+system.mem_ctrl.port = system.membus.master
+system.system_port = system.membus.slave
+
+process = Process()
+process.cmd = [args.binary]
+system.cpu.workload = process
+system.cpu.createThreads()
+
+root = Root(full_system = False, system = system)
+
+def run_to_end(what):
+    exit_event = m5.simulate()
+    if exit_event.getCause() != 'exiting with last active thread context':
+        fatal("%s ended with '%s' @ %d" %
+              (what, exit_event.getCause(), m5.curTick()))
+    print("%s ended @ tick %d" % (what, m5.curTick()))
+
+if args.restore:
+    m5.instantiate(args.restore)
+    run_to_end("Run from the checkpoint @ tick %d" % m5.curTick())
+    sys.exit(0)
+
+m5.instantiate()
+m5.setBackgroundCheckpoints(args.jobs)
+
+checkpoints = []
+for tick in args.checkpoint_ticks:
+    exit_event = m5.simulate(tick - m5.curTick())
+    if exit_event.getCause() != 'simulate() limit reached':
+        fatal("Program ended before the checkpoint at tick %d: %s" %
+              (tick, exit_event.getCause()))
+    cpt = os.path.join(m5.options.outdir, 'cpt.%d' % m5.curTick())
+    m5.checkpoint(cpt)
+    checkpoints.append(cpt)
+
+run_to_end("Run taking %d checkpoints" % len(checkpoints))
+m5.waitCheckpoints()
+
+# Each restore needs a simulator of its own.
+gem5 = os.readlink('/proc/self/exe')
+for cpt in checkpoints:
+    sys.stdout.flush()
+    status = subprocess.call([
+        gem5, '-d', cpt + '.restore', os.path.abspath(sys.argv[0]),
+        args.binary, '--restore', cpt])
+    if status != 0:
+        fatal("Restoring %s failed with status %d" % (cpt, status))
+    print("Restored %s" % os.path.basename(cpt))
@@ -0,0 +1,66 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Runs a sorting kernel on the O3 CPU with the TAGE predictors and has
+TAGEBase compute the indices and tags of every lookup both with the
+batched TAGEIndexer and one table at a time with gindex() and gtag().
+Any difference panics, so the predictions are those of the scalar
+hashes.
+'''
+from testlib import *
+
+workload = 'Bubblesort'
+path = joinpath(config.bin_path, 'cpu_tests', 'x86')
+url = config.resource_url + '/gem5/cpu_tests/benchmarks/bin/x86/' + workload
+workload_binary = DownloadedProgram(url, path, workload)
+
+bp = 'system.cpu.branchPred.'
+minimums = {
+    bp + 'condPredicted': 1,
+    bp + 'tage.longestMatchProviderCorrect': 1,
+}
+
+for bp_type in ('TAGE', 'LTAGE'):
+    gem5_verify_config(
+        name='tage-index-check-%s-%s' % (bp_type, workload),
+        verifiers=(
+            verifier.MatchRegex('^-50000$', match_stderr=False),
+            verifier.MatchStatBounds(minimums, (bp + 'condIncorrect',)),
+        ),
+        fixtures=(workload_binary,),
+        config=joinpath(config.base_dir, 'configs', 'example', 'se.py'),
+        config_args=[
+            '--cmd', joinpath(workload_binary.path, workload),
+            '--cpu-type', 'DerivO3CPU',
+            '--caches',
+            '--bp-type', bp_type,
+            '--param', 'system.cpu[0].branchPred.tage.indexCheck = True',
+        ],
+        valid_isas=('X86',),
+        valid_hosts=constants.supported_hosts,
+        length=constants.quick_tag,
+    )
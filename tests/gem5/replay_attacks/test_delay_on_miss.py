@@ -0,0 +1,74 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Runs the branch-replay microbenchmark under DelayOnMiss on Ruby. Its
+transmitter load misses in the L1 the first time it is fenced and hits
+afterwards, so both paths of the L1 probe and the replacement updates
+deferred to VP have to show up in the stats. Loads the L1 refused after
+a probe hit depend on the timing of evictions and are only logged.
+'''
+from testlib import *
+
+progs_dir = joinpath(config.base_dir, 'tests', 'test-progs', 'replay-attacks')
+bin_dir = joinpath(progs_dir, 'bin', 'x86', 'linux')
+make = MakeFixture(progs_dir)
+
+prog = 'branch-replay'
+binary = MakeTarget(joinpath('bin', 'x86', 'linux', prog), make)
+epochs = MakeTarget(joinpath('bin', 'x86', 'linux', prog + '.epochs'), make)
+
+lsq = 'system.cpu.lsq0.'
+minimums = {
+    lsq + 'delayOnMissHits': 1,
+    lsq + 'delayOnMissDelays': 1,
+    lsq + 'delayOnMissTouches': 1,
+}
+
+gem5_verify_config(
+    name='delay-on-miss-%s' % prog,
+    verifiers=(
+        verifier.MatchStdoutNoPerf(joinpath(getcwd(), 'ref', prog, 'simout')),
+        verifier.MatchStatBounds(minimums,
+                                 (lsq + 'delayOnMissNacks', 'system.cpu.cpi')),
+    ),
+    fixtures=(binary, epochs),
+    config=joinpath(config.base_dir, 'configs', 'example', 'se.py'),
+    config_args=[
+        '--cmd', joinpath(bin_dir, prog),
+        '--cpu-type', 'DerivO3CPU',
+        '--ruby',
+        '--needsTSO',
+        '--threatModel', 'Spectre',
+        '--HWName', 'DelayOnMiss',
+        '--replayDetScheme', 'Epoch',
+        '--epoch-path', joinpath(bin_dir, prog + '.epochs'),
+    ],
+    valid_isas=('X86',),
+    valid_hosts=constants.supported_hosts,
+    protocol='MESI_Two_Level',
+    length=constants.long_tag,
+)
@@ -0,0 +1,82 @@
+'''
+Runs the replay-attack microbenchmarks of tests/test-progs/replay-attacks
+under every defense scheme. Schemes that detect replays must see the
+replays the attacks cause, and schemes that defend must fence, while the
+CPI of each run is logged so the cost of the defenses can be compared.
+'''
+from testlib import *
+
+progs_dir = joinpath(config.base_dir, 'tests', 'test-progs', 'replay-attacks')
+bin_dir = joinpath(progs_dir, 'bin', 'x86', 'linux')
+make = MakeFixture(progs_dir)
+
+# Smallest number of replays each detection scheme must count: a
+# fraction of the mispredictions of the random branch, and none required
+# of the loop kernels, which have no attacker. There is no page fault
+# handle, SE mode resolves first touches without a fault, see the README
+# of the programs.
+min_replays = {
+    'branch-replay': 256,
+    'loop-kernels': 0,
+}
+
+# (threat model, hardware, replay detection). DelayOnMiss probes the L1
+# through a Ruby sequencer and runs on MESI_Two_Level.
+schemes = (
+    ('Unsafe', 'Unsafe', 'NoDetect'),
+    ('Spectre', 'Fence', 'NoDetect'),
+    ('Spectre', 'Fence', 'Counter'),
+    ('Spectre', 'Fence', 'Buffer'),
+    ('Spectre', 'Fence', 'Epoch'),
+    ('Spectre', 'DelayOnMiss', 'Epoch'),
+    ('Futuristic', 'Fence-All', 'Epoch'),
+)
+
+reported_stats = (
+    'system.cpu.cpi',
+    'system.cpu.squashSet',
+    'system.cpu.fetch.fetchMemFences',
+    'system.cpu.fetch.fetchAllFences',
+)
+
+for prog, replays in min_replays.items():
+    binary = MakeTarget(joinpath('bin', 'x86', 'linux', prog), make)
+    epochs = MakeTarget(joinpath('bin', 'x86', 'linux', prog + '.epochs'),
+                        make)
+
+    for threat, hw, det in schemes:
+        minimums = {}
+        if det != 'NoDetect':
+            minimums['system.cpu.squashSet'] = replays
+            if replays:
+                minimums['system.cpu.fetch.fetchAllFences'] = 1
+
+        ruby = hw == 'DelayOnMiss'
+        config_args = [
+            '--cmd', joinpath(bin_dir, prog),
+            '--cpu-type', 'DerivO3CPU',
+            '--ruby' if ruby else '--caches',
+            '--needsTSO',
+            '--threatModel', threat,
+            '--HWName', hw,
+            '--replayDetScheme', det,
+        ]
+        if det == 'Epoch':
+            config_args += ['--epoch-path',
+                            joinpath(bin_dir, prog + '.epochs')]
+
+        gem5_verify_config(
+            name='replay-attacks-%s-%s-%s-%s' % (prog, threat, hw, det),
+            verifiers=(
+                verifier.MatchStdoutNoPerf(
+                    joinpath(getcwd(), 'ref', prog, 'simout')),
+                verifier.MatchStatBounds(minimums, reported_stats),
+            ),
+            fixtures=(binary, epochs),
+            config=joinpath(config.base_dir, 'configs', 'example', 'se.py'),
+            config_args=config_args,
+            valid_isas=('X86',),
+            valid_hosts=constants.supported_hosts,
+            protocol='MESI_Two_Level' if ruby else None,
+            length=constants.long_tag,
+        )
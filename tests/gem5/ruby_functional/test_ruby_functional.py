@@ -0,0 +1,69 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Functional accesses through Ruby to lines no controller has run a
+transition for: the SE binary is loaded with functional writes, and the
+test program has the write() system call read part of it back. Those
+lines are clean and in no cache, so the read of all of them is served
+through a back door to memory.
+'''
+from testlib import *
+
+progs_dir = joinpath(config.base_dir, 'tests', 'test-progs', 'untouched-read')
+binary = MakeTarget(joinpath('bin', 'x86', 'linux', 'untouched-read'),
+                    MakeFixture(progs_dir))
+
+# The last of the untouched lines written out by the program
+last_line = '^untouched line 7: read by the kernel, never by the program'
+# The back door for the page-aligned 512 bytes the program writes out
+backdoor = (r'.*Functional back door for '
+            r'\[0x[0-9a-f]*000:0x[0-9a-f]*(200|1ff)\]')
+
+for directory in ('off', 'check'):
+    gem5_verify_config(
+        name='ruby-functional-untouched-read-directory-' + directory,
+        verifiers=(
+            verifier.MatchRegex(last_line, match_stderr=False),
+            verifier.MatchRegex(backdoor, match_stdout=False),
+        ),
+        fixtures=(binary,),
+        # Keep the debug output apart from the program output
+        gem5_args=('--debug-flags=RubySystem', '--debug-file=cerr'),
+        config=joinpath(config.base_dir, 'configs', 'example', 'se.py'),
+        config_args=[
+            '--cmd', joinpath(progs_dir, 'bin', 'x86', 'linux',
+                              'untouched-read'),
+            '--cpu-type', 'TimingSimpleCPU',
+            '--ruby',
+            '--ruby-functional-directory', directory,
+        ],
+        valid_isas=('X86',),
+        # Debug output is compiled out of fast builds
+        valid_variants=('opt', 'debug'),
+        valid_hosts=constants.supported_hosts,
+        length=constants.quick_tag,
+    )
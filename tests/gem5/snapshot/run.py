@@ -0,0 +1,108 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Runs a program on an O3 CPU with caches, takes an in-process snapshot
+part way through and runs to the end. It then rewinds to the snapshot
+twice, running to the end after each rewind, so that the events the
+first run leaves scheduled and those the objects schedule again when
+they are restored have to be told apart.
+'''
+
+import argparse
+
+import m5
+from m5.objects import *
+from m5.util import fatal
+
+parser = argparse.ArgumentParser()
+parser.add_argument('binary', type = str)
+parser.add_argument('--snapshot-tick', type = int, default = 100000)
+parser.add_argument('--rewinds', type = int, default = 2)
+
+args = parser.parse_args()
+
+system = System()
+
+system.clk_domain = SrcClockDomain()
+system.clk_domain.clock = '1GHz'
+system.clk_domain.voltage_domain = VoltageDomain()
+
+system.mem_mode = 'timing'
+system.mem_ranges = [AddrRange('512MB')]
+
+system.cpu = DerivO3CPU()
+
+system.cpu.icache = Cache(size = '32kB', assoc = 8, tag_latency = 1,
+                          data_latency = 1, response_latency = 1,
+                          mshrs = 16, tgts_per_mshr = 20)
+system.cpu.dcache = Cache(size = '32kB', assoc = 8, tag_latency = 1,
+                          data_latency = 1, response_latency = 1,
+                          mshrs = 16, tgts_per_mshr = 20)
+system.membus = SystemXBar()
+system.cpu.icache.cpu_side = system.cpu.icache_port
+system.cpu.dcache.cpu_side = system.cpu.dcache_port
+system.cpu.icache.mem_side = system.membus.slave
+system.cpu.dcache.mem_side = system.membus.slave
+
+system.cpu.createInterruptController()
+if m5.defines.buildEnv['TARGET_ISA'] == "x86":
+    system.cpu.interrupts[0].pio = system.membus.master
+    system.cpu.interrupts[0].int_master = system.membus.slave
+    system.cpu.interrupts[0].int_slave = system.membus.master
+
+system.mem_ctrl = SimpleMemory(latency = '1ns')
+system.mem_ctrl.range = system.mem_ranges[0]
+system.mem_ctrl.port = system.membus.master
+system.system_port = system.membus.slave
+
+process = Process()
+process.cmd = [args.binary]
+system.cpu.workload = process
+system.cpu.createThreads()
+
+root = Root(full_system = False, system = system)
+m5.instantiate()
+
+exit_event = m5.simulate(args.snapshot_tick)
+if exit_event.getCause() != 'simulate() limit reached':
+    fatal("Program ended before the snapshot: %s" % exit_event.getCause())
+
+m5.snapshot()
+snapshot_tick = m5.curTick()
+
+for run in range(args.rewinds + 1):
+    if run:
+        m5.rewind()
+        if m5.curTick() != snapshot_tick:
+            fatal("Rewind %d returned to tick %d instead of %d" %
+                     (run, m5.curTick(), snapshot_tick))
+
+    exit_event = m5.simulate()
+    if exit_event.getCause() != 'exiting with last active thread context':
+        fatal("Run %d ended with '%s' @ %d" %
+                 (run, exit_event.getCause(), m5.curTick()))
+    print("Run %d from the snapshot ended @ tick %d" % (run, m5.curTick()))
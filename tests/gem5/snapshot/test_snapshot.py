@@ -0,0 +1,51 @@
+# Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Rewinds an O3 system to an in-process snapshot twice. run.py fails
+unless both rewinds return to the tick of the snapshot and run the
+program to its end again, so the last run reporting its end passes.
+'''
+from testlib import *
+
+base_path = joinpath(config.bin_path, 'hello')
+path = joinpath(base_path, 'x86', 'linux')
+url = config.resource_url + '/test-progs/hello/bin/x86/linux/hello64-static'
+hello_program = DownloadedProgram(url, path, 'hello64-static')
+
+gem5_verify_config(
+    name='snapshot-rewind-twice-o3',
+    verifiers=(
+        verifier.MatchRegex(r'Run 2 from the snapshot ended @ tick \d+',
+                            match_stderr=False),
+    ),
+    fixtures=(hello_program,),
+    config=joinpath(getcwd(), 'run.py'),
+    config_args=[joinpath(path, 'hello64-static')],
+    valid_isas=('X86',),
+    valid_hosts=constants.supported_hosts,
+    length=constants.quick_tag,
+)
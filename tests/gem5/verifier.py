@@ -29,6 +29,7 @@ Built in test cases that verify particular details about a gem5 run.
 '''
 import re
 
+from testlib import log
 from testlib import test_util
 from testlib.configuration import constants
 from testlib.helper import joinpath, diff_out_file
@@ -189,6 +190,50 @@ class MatchRegex(Verifier):
                 return # Success
         test_util.fail('Could not match regex.')
 
+class MatchStatBounds(Verifier):
+    '''
+    Checks scalar stats of the last stats dump against lower bounds, and
+    logs the values of a set of stats so they show up in the test log.
+    '''
+    def __init__(self, minimums, report=tuple()):
+        '''
+        :param minimums: Maps stat names to their smallest passing value.
+        :param report: Names of the stats to log.
+        '''
+        super(MatchStatBounds, self).__init__()
+        self.minimums = minimums
+        self.report = report
+
+    def test(self, params):
+        fixtures = params.fixtures
+        # Get the file from the tempdir of the test.
+        tempdir = fixtures[constants.tempdir_fixture_name].path
+
+        stats = {}
+        with open(joinpath(tempdir, constants.gem5_simulation_stats)) as f:
+            for line in f:
+                if line.startswith('---------- Begin Simulation Statistics'):
+                    stats = {}
+                    continue
+                fields = line.split()
+                if len(fields) >= 2:
+                    stats[fields[0]] = fields[1]
+
+        for name in self.report:
+            log.test_log.message('%s: %s' % (name, stats.get(name, 'missing')))
+
+        for name, minimum in self.minimums.items():
+            if name not in stats:
+                test_util.fail('Stat %s not found.' % name)
+            try:
+                value = float(stats[name])
+            except ValueError:
+                test_util.fail('Stat %s is not a number: %s' %
+                               (name, stats[name]))
+            if value < minimum:
+                test_util.fail('Stat %s is %s, expected at least %s.' %
+                               (name, stats[name], minimum))
+
 _re_type = type(re.compile(''))
 def _iterable_regex(regex):
     if isinstance(regex, _re_type) or isinstance(regex, str):
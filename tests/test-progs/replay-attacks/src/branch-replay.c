@@ -0,0 +1,42 @@
+/*
+ * Branch-misprediction replays. A branch on a pseudo-random sequence
+ * mispredicts about half the time; its wrong path holds a
+ * secret-dependent transmitter load that is squashed and fetched again
+ * whenever the predictor guesses wrong, as in a Spectre gadget.
+ */
+
+#include <stdio.h>
+
+#include "epoch_mark.h"
+
+#define ROUNDS 4096
+#define LINE 64
+
+static unsigned char probe[256 * LINE];
+static volatile unsigned char secret = 0x2a;
+
+static unsigned
+gadget(unsigned bit)
+{
+    EPOCH_RTN();
+    if (bit)
+        return probe[secret * LINE] + 1;
+    return 0;
+}
+
+int
+main(void)
+{
+    unsigned lfsr = 0xace1;
+    unsigned sink = 0;
+
+    EPOCH_LOOP();
+    for (int i = 0; i < ROUNDS; i++) {
+        EPOCH_ITER();
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xb400);
+        sink += gadget(lfsr & 1);
+    }
+
+    printf("branch-replay: %d rounds, sink %u\n", ROUNDS, sink);
+    return 0;
+}
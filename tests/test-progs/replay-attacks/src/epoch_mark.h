@@ -0,0 +1,23 @@
+/*
+ * Epoch separators for the replay-attack microbenchmarks. Each marker
+ * emits a local label named after its epoch scale; the Makefile turns
+ * their addresses into the program's .epochs file, one "pc marker" line
+ * per separator, as read by --epoch-path.
+ */
+
+#ifndef __EPOCH_MARK_H__
+#define __EPOCH_MARK_H__
+
+/** Separator at the top of a loop body, one epoch per iteration. */
+#define EPOCH_ITER() \
+    asm volatile("__epoch_I_%=:" ::: "memory")
+
+/** Separator ahead of a loop, one epoch per loop. */
+#define EPOCH_LOOP() \
+    asm volatile("__epoch_L_%=:" ::: "memory")
+
+/** Separator at the entry of a routine, one epoch per call. */
+#define EPOCH_RTN() \
+    asm volatile("__epoch_R_%=:" ::: "memory")
+
+#endif // __EPOCH_MARK_H__
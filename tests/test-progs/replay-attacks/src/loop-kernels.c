@@ -0,0 +1,71 @@
+/*
+ * Loop kernels with known epoch structure: a matrix multiply (a nest of
+ * three loops) and a 1D stencil, each in its own routine. They have no
+ * attacker, and measure the cost of a defense on regular code.
+ */
+
+#include <stdio.h>
+
+#include "epoch_mark.h"
+
+#define N 24
+#define STENCIL_LEN 1024
+#define STENCIL_STEPS 8
+
+static int a[N][N], b[N][N], c[N][N];
+static int grid[2][STENCIL_LEN];
+
+static void
+matmul(void)
+{
+    EPOCH_RTN();
+    EPOCH_LOOP();
+    for (int i = 0; i < N; i++) {
+        EPOCH_ITER();
+        for (int j = 0; j < N; j++) {
+            int sum = 0;
+            for (int k = 0; k < N; k++)
+                sum += a[i][k] * b[k][j];
+            c[i][j] = sum;
+        }
+    }
+}
+
+static void
+stencil(void)
+{
+    EPOCH_RTN();
+    EPOCH_LOOP();
+    for (int t = 0; t < STENCIL_STEPS; t++) {
+        EPOCH_ITER();
+        int *in = grid[t & 1], *out = grid[~t & 1];
+        for (int i = 1; i < STENCIL_LEN - 1; i++)
+            out[i] = (in[i - 1] + 2 * in[i] + in[i + 1]) / 4;
+    }
+}
+
+int
+main(void)
+{
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            a[i][j] = i + j;
+            b[i][j] = (i * j) % 7 - 3;
+        }
+    }
+    for (int i = 0; i < STENCIL_LEN; i++)
+        grid[0][i] = (i * 37) % 101;
+
+    matmul();
+    stencil();
+
+    long trace = 0;
+    for (int i = 0; i < N; i++)
+        trace += c[i][i];
+    long sum = 0;
+    for (int i = 0; i < STENCIL_LEN; i++)
+        sum += grid[STENCIL_STEPS & 1][i];
+
+    printf("loop-kernels: trace %ld, stencil %ld\n", trace, sum);
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020 Dimitrios Skarlatos and Zirui Neil Zhao
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Hands the kernel a buffer the program never reads itself. Its lines
+ * are written when the binary is loaded and then read functionally by
+ * the write() system call, without any cache or directory having run a
+ * transition for them.
+ */
+
+#include <unistd.h>
+
+/* Eight full cache lines of their own */
+static const char message[] __attribute__((aligned(4096))) =
+    "untouched line 0: read by the kernel, never by the program.....\n"
+    "untouched line 1: read by the kernel, never by the program.....\n"
+    "untouched line 2: read by the kernel, never by the program.....\n"
+    "untouched line 3: read by the kernel, never by the program.....\n"
+    "untouched line 4: read by the kernel, never by the program.....\n"
+    "untouched line 5: read by the kernel, never by the program.....\n"
+    "untouched line 6: read by the kernel, never by the program.....\n"
+    "untouched line 7: read by the kernel, never by the program.....\n";
+
+int
+main(void)
+{
+    if (write(STDOUT_FILENO, message, sizeof(message) - 1) !=
+        sizeof(message) - 1) {
+        return 1;
+    }
+    return 0;
+}